@@ -0,0 +1,28 @@
+PROOF_PRI_PATH = $$PWD/../proofboot
+!exists($$PROOF_PRI_PATH/proof_tests.pri):PROOF_PRI_PATH = $$(PROOF_PATH)
+include($$PROOF_PRI_PATH/proof_tests.pri)
+
+QT += network gui
+CONFIG += proofutils proofnetworkmis proofnetworkums
+
+HEADERS += \
+    tests/common/fakesocketserver.h \
+    tests/benchmarks/benchmark_global.h
+
+SOURCES += \
+    tests/benchmarks/main.cpp \
+    tests/benchmarks/apihelper_benchmark.cpp \
+    tests/benchmarks/epllabelgenerator_benchmark.cpp \
+    tests/benchmarks/jobsbinaryarchive_benchmark.cpp \
+    tests/benchmarks/jwtverifier_benchmark.cpp \
+    tests/benchmarks/labelbatchrenderer_benchmark.cpp \
+    tests/benchmarks/lprprinterapi_benchmark.cpp \
+    tests/benchmarks/printspool_benchmark.cpp \
+    tests/benchmarks/qrcodegenerator_benchmark.cpp \
+    tests/benchmarks/rawsocketprinter_benchmark.cpp \
+    tests/benchmarks/workflowelement_benchmark.cpp
+
+!android:!win32: SOURCES += tests/benchmarks/lprprinter_benchmark.cpp
+
+RESOURCES += \
+    tests/benchmarks/benchmarks_resources.qrc
@@ -4,17 +4,25 @@ proof_add_target_sources(NetworkMis
     src/proofnetwork/mis/data/workflowelement.cpp
     src/proofnetwork/mis/data/qmlwrappers/jobqmlwrapper.cpp
     src/proofnetwork/mis/apihelper.cpp
+    src/proofnetwork/mis/jobsjsonreader.cpp
+    src/proofnetwork/mis/jobsbinaryarchive.cpp
 )
 
 proof_add_target_headers(NetworkMis
     include/proofnetwork/mis/proofnetworkmis_global.h
     include/proofnetwork/mis/proofnetworkmis_types.h
     include/proofnetwork/mis/apihelper.h
+    include/proofnetwork/mis/jobsjsonreader.h
+    include/proofnetwork/mis/jobsbinaryarchive.h
     include/proofnetwork/mis/data/job.h
     include/proofnetwork/mis/data/workflowelement.h
     include/proofnetwork/mis/data/qmlwrappers/jobqmlwrapper.h
 )
 
+proof_add_target_private_headers(NetworkMis
+    include/private/proofnetwork/mis/data/job_p.h
+)
+
 proof_force_moc(NetworkMis include/proofnetwork/mis/apihelper.h)
 
 proof_add_module(NetworkMis
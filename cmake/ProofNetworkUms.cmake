@@ -4,6 +4,8 @@ proof_add_target_sources(NetworkUms
     src/proofnetwork/ums/data/qmlwrappers/umsuserqmlwrapper.cpp
     src/proofnetwork/ums/data/qmlwrappers/umstokeninfoqmlwrapper.cpp
     src/proofnetwork/ums/tokensapi.cpp
+    src/proofnetwork/ums/jwtverifier.cpp
+    src/proofnetwork/ums/tokenmanager.cpp
     src/proofnetwork/ums/data/umstokeninfo.cpp
 )
 
@@ -14,11 +16,14 @@ proof_add_target_headers(NetworkUms
     include/proofnetwork/ums/data/qmlwrappers/umsuserqmlwrapper.h
     include/proofnetwork/ums/data/qmlwrappers/umstokeninfoqmlwrapper.h
     include/proofnetwork/ums/tokensapi.h
+    include/proofnetwork/ums/jwtverifier.h
+    include/proofnetwork/ums/tokenmanager.h
     include/proofnetwork/ums/data/umstokeninfo.h
 )
 
 proof_add_target_private_headers(NetworkUms
     include/private/proofnetwork/ums/data/umsuser_p.h
+    include/private/proofnetwork/singleflight_p.h
 )
 
 proof_add_module(NetworkUms
@@ -3,6 +3,10 @@ proof_add_target_sources(Utils
     src/proofutils/epllabelgenerator.cpp
     src/proofutils/qrcodegenerator.cpp
     src/proofutils/labelprinter.cpp
+    src/proofutils/labelprinterpool.cpp
+    src/proofutils/labelbatchrenderer.cpp
+    src/proofutils/rawsocketprinter.cpp
+    src/proofutils/printspool.cpp
 )
 
 proof_add_target_headers(Utils
@@ -10,12 +14,22 @@ proof_add_target_headers(Utils
     include/proofutils/epllabelgenerator.h
     include/proofutils/qrcodegenerator.h
     include/proofutils/labelprinter.h
+    include/proofutils/labelprinterpool.h
+    include/proofutils/labelbatchrenderer.h
+    include/proofutils/rawsocketprinter.h
+    include/proofutils/printspool.h
     include/proofutils/basic_package.h
 )
 
 if (NOT ANDROID)
-    proof_add_target_sources(Utils src/proofutils/lprprinter.cpp)
-    proof_add_target_headers(Utils include/proofutils/lprprinter.h)
+    proof_add_target_sources(Utils
+        src/proofutils/lprprinter.cpp
+        src/proofutils/lpdclient.cpp
+    )
+    proof_add_target_headers(Utils
+        include/proofutils/lprprinter.h
+        include/proofutils/lpdclient.h
+    )
 endif()
 
 proof_add_module(Utils
@@ -0,0 +1,54 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_MIS_JOB_P_H
+#define PROOF_MIS_JOB_P_H
+
+#include "proofnetwork/mis/data/job.h"
+#include "proofnetwork/networkdataentity_p.h"
+
+namespace Proof {
+namespace Mis {
+class JobPrivate : NetworkDataEntityPrivate
+{
+    Q_DECLARE_PUBLIC(Job)
+
+    friend class JobsBinaryArchive;
+    void setId(const QString &id);
+
+    QString id;
+    EntityStatus status = EntityStatus::ValidEntity;
+    QString name;
+    qlonglong quantity = 0;
+    double width = 0.0;
+    double height = 0.0;
+    QString source;
+    int pageCount = 0;
+    bool hasPreview = false;
+    QVector<WorkflowElement> workflow;
+};
+} // namespace Mis
+} // namespace Proof
+
+#endif // PROOF_MIS_JOB_P_H
@@ -0,0 +1,206 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_SINGLEFLIGHT_P_H
+#define PROOF_SINGLEFLIGHT_P_H
+
+#include "proofseed/future.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+namespace Proof {
+
+//Concurrent requests with the same key share one reply, which also can be reused for cacheTtl msecs.
+//Each caller gets its own future, so its cancel affects only it. Shared request is canceled when all callers did it.
+//Replies can come after owner is destroyed, so everything they touch is kept in shared state.
+//Replies of requests started before invalidate() are not cached and are not shared with later calls
+template <typename T>
+class SingleFlight
+{
+public:
+    using Request = std::function<CancelableFuture<T>()>;
+
+    SingleFlight() : state(QSharedPointer<State>::create()) { state->clock.start(); }
+
+    CancelableFuture<T> fetch(const QString &key, int cacheTtl, const Request &request)
+    {
+        PromiseSP<T> promise = PromiseSP<T>::create();
+        QMutexLocker lock(&state->mutex);
+        if (cacheTtl > 0) {
+            auto cached = state->cache.constFind(key);
+            if (cached != state->cache.cend() && state->clock.elapsed() - cached->storedAt < cacheTtl) {
+                ++cacheHits;
+                T value = cached->value;
+                lock.unlock();
+                promise->success(value);
+                return CancelableFuture<T>(promise);
+            }
+        }
+
+        QSharedPointer<Flight> flight = state->inFlight.value(key);
+        bool isNew = !flight;
+        if (isNew) {
+            flight = QSharedPointer<Flight>::create();
+            flight->generation = state->generation;
+            state->inFlight.insert(key, flight);
+        } else {
+            ++deduplicated;
+        }
+        flight->subscribers << promise;
+        lock.unlock();
+
+        QSharedPointer<State> sharedState = state;
+        if (isNew) {
+            auto sent = request();
+            lock.relock();
+            flight->request = sent;
+            lock.unlock();
+            sent
+                ->onSuccess([sharedState, key, cacheTtl, flight](const T &value) {
+                    QMutexLocker lock(&sharedState->mutex);
+                    if (cacheTtl > 0 && flight->generation == sharedState->generation)
+                        sharedState->cache.insert(key, Cached{value, sharedState->clock.elapsed()});
+                    auto subscribers = sharedState->finish(key, flight);
+                    lock.unlock();
+                    for (const auto &subscriber : subscribers) {
+                        if (!subscriber->future()->completed())
+                            subscriber->success(value);
+                    }
+                })
+                ->onFailure([sharedState, key, flight](const Failure &failure) {
+                    QMutexLocker lock(&sharedState->mutex);
+                    auto subscribers = sharedState->finish(key, flight);
+                    lock.unlock();
+                    for (const auto &subscriber : subscribers) {
+                        if (!subscriber->future()->completed())
+                            subscriber->failure(failure);
+                    }
+                });
+        }
+        //Promise is not captured by its own continuation, only its address is used to find it among subscribers
+        const Promise<T> *subscriber = promise.data();
+        promise->future()->onFailure([sharedState, key, flight, subscriber](const Failure &) {
+            sharedState->unsubscribe(key, flight, subscriber);
+        });
+        return CancelableFuture<T>(promise);
+    }
+
+    bool isInFlight(const QString &key) const
+    {
+        QMutexLocker lock(&state->mutex);
+        return state->inFlight.contains(key);
+    }
+
+    //Cancels shared request itself, all its callers get failure
+    void cancel(const QString &key)
+    {
+        QMutexLocker lock(&state->mutex);
+        QSharedPointer<Flight> flight = state->inFlight.value(key);
+        if (!flight)
+            return;
+        auto request = flight->request;
+        lock.unlock();
+        request.cancel();
+    }
+
+    void invalidate()
+    {
+        QMutexLocker lock(&state->mutex);
+        ++state->generation;
+        state->cache.clear();
+        state->inFlight.clear();
+    }
+
+    //Calls that joined already running request and calls answered from cache
+    qint64 deduplicatedCount() const { return deduplicated; }
+    qint64 cacheHitsCount() const { return cacheHits; }
+
+private:
+    struct Cached
+    {
+        T value;
+        qint64 storedAt;
+    };
+
+    struct Flight
+    {
+        QVector<PromiseSP<T>> subscribers;
+        CancelableFuture<T> request{PromiseSP<T>::create()};
+        quint64 generation = 0;
+    };
+
+    struct State
+    {
+        //Requires mutex to be locked
+        QVector<PromiseSP<T>> finish(const QString &key, const QSharedPointer<Flight> &flight)
+        {
+            if (inFlight.value(key) == flight)
+                inFlight.remove(key);
+            flight->request = CancelableFuture<T>(PromiseSP<T>::create());
+            QVector<PromiseSP<T>> subscribers;
+            subscribers.swap(flight->subscribers);
+            return subscribers;
+        }
+
+        //Called for callers failed with shared request too, they are not among subscribers already
+        void unsubscribe(const QString &key, const QSharedPointer<Flight> &flight, const Promise<T> *subscriber)
+        {
+            QMutexLocker lock(&mutex);
+            auto found = std::find_if(flight->subscribers.begin(), flight->subscribers.end(),
+                                      [subscriber](const PromiseSP<T> &x) { return x.data() == subscriber; });
+            if (found == flight->subscribers.end())
+                return;
+            flight->subscribers.erase(found);
+            if (!flight->subscribers.isEmpty())
+                return;
+            auto request = flight->request;
+            finish(key, flight);
+            lock.unlock();
+            request.cancel();
+        }
+
+        QMutex mutex;
+        QHash<QString, QSharedPointer<Flight>> inFlight;
+        QHash<QString, Cached> cache;
+        quint64 generation = 0;
+        QElapsedTimer clock;
+    };
+
+    QSharedPointer<State> state;
+    std::atomic<qint64> deduplicated{0};
+    std::atomic<qint64> cacheHits{0};
+};
+
+} // namespace Proof
+
+#endif // PROOF_SINGLEFLIGHT_P_H
@@ -48,6 +48,12 @@ struct PROOF_NETWORK_LPRPRINTER_EXPORT LprPrinterInfo
     bool acceptsFiles;
 };
 
+struct PROOF_NETWORK_LPRPRINTER_EXPORT LprPrinterLabelResult
+{
+    bool printed;
+    QString reason;
+};
+
 class LprPrinterApiPrivate;
 class PROOF_NETWORK_LPRPRINTER_EXPORT LprPrinterApi : public ProofServiceRestApi
 {
@@ -56,11 +62,33 @@ class PROOF_NETWORK_LPRPRINTER_EXPORT LprPrinterApi : public ProofServiceRestApi
 public:
     explicit LprPrinterApi(const RestClientSP &restClient, QObject *parent = nullptr);
 
+    //Concurrent fetchStatus() calls for the same printer and concurrent fetchPrintersList() calls share one request
     CancelableFuture<LprPrinterStatus> fetchStatus(const QString &printer = QString());
+    //Sends label as binary body, falls back to base64 in JSON if service doesn't support it
     CancelableFuture<bool> printLabel(const QByteArray &label, const QString &printer = QString());
+    //Sends labels in batches of labelsBatchSize() with up to maxBatchesInFlight() requests at once.
+    //Result has entry for each label, in the same order. Falls back to printLabel() if service has no batch endpoint.
+    //By default next batch is sent only after previous one is replied, with more batches in flight service can
+    //print labels of different batches out of order. Cancel drops batches not sent yet and cancels ones in flight
+    CancelableFuture<QVector<LprPrinterLabelResult>> printLabels(const QVector<QByteArray> &labels,
+                                                                 const QString &printer = QString());
     CancelableFuture<bool> printFile(const QString &fileName, const QString &printer = QString(),
                                      unsigned int copies = 1);
     CancelableFuture<QVector<LprPrinterInfo>> fetchPrintersList();
+
+    //Replies of fetchStatus() and fetchPrintersList() are reused for this time, 0 disables caching
+    int statusCacheTtl() const;
+    void setStatusCacheTtl(int msecs);
+    //Requests already in flight are still answered, but their replies are not cached and later calls send new ones
+    void invalidateStatusCache();
+    //Calls that joined already running request and calls answered from cache
+    qint64 deduplicatedRequestsCount() const;
+    qint64 cachedRepliesCount() const;
+
+    int labelsBatchSize() const;
+    void setLabelsBatchSize(int labelsCount);
+    int maxBatchesInFlight() const;
+    void setMaxBatchesInFlight(int batchesCount);
 };
 
 } // namespace NetworkServices
@@ -68,5 +96,6 @@ public:
 
 Q_DECLARE_METATYPE(Proof::NetworkServices::LprPrinterStatus)
 Q_DECLARE_METATYPE(Proof::NetworkServices::LprPrinterInfo)
+Q_DECLARE_METATYPE(Proof::NetworkServices::LprPrinterLabelResult)
 
 #endif // PROOF_NETWORKSERVICES_LPRPRINTERAPI_H
@@ -0,0 +1,70 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_NETWORKSERVICES_LPRPRINTERSTATUSWATCHER_H
+#define PROOF_NETWORKSERVICES_LPRPRINTERSTATUSWATCHER_H
+
+#include "proofcore/proofobject.h"
+
+#include "proofnetwork/lprprinter/lprprinterapi.h"
+#include "proofnetwork/lprprinter/proofnetworklprprinter_global.h"
+
+namespace Proof {
+namespace NetworkServices {
+
+//Keeps printer status up to date and emits statusChanged() only when status differs from previous one.
+//Status changes are pushed by service as server-sent events from /lpr/status/events,
+//if service doesn't support it status is polled with LprPrinterApi::fetchStatus() instead.
+//Watcher needs event loop in its thread. Polled status changes are emitted from thread where reply was handled.
+class LprPrinterStatusWatcherPrivate;
+class PROOF_NETWORK_LPRPRINTER_EXPORT LprPrinterStatusWatcher : public ProofObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(LprPrinterStatusWatcher)
+public:
+    explicit LprPrinterStatusWatcher(const RestClientSP &restClient, const QString &printer = QString(),
+                                     QObject *parent = nullptr);
+    ~LprPrinterStatusWatcher();
+
+    QString printer() const;
+    //Used for polling and for reconnecting to dropped events stream
+    int pollingInterval() const;
+    void setPollingInterval(int msecs);
+
+    bool isRunning() const;
+    bool isPushActive() const;
+    bool hasStatus() const;
+    LprPrinterStatus status() const;
+
+    void start();
+    void stop();
+
+signals:
+    void statusChanged(const Proof::NetworkServices::LprPrinterStatus &status);
+};
+
+} // namespace NetworkServices
+} // namespace Proof
+
+#endif // PROOF_NETWORKSERVICES_LPRPRINTERSTATUSWATCHER_H
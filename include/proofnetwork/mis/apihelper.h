@@ -140,6 +140,18 @@ PROOF_NETWORK_MIS_EXPORT WorkflowAction workflowActionFromString(QString actionS
 PROOF_NETWORK_MIS_EXPORT TransitionEvent transitionEventFromString(QString eventString, bool *ok = nullptr);
 PROOF_NETWORK_MIS_EXPORT PaperSide paperSideFromString(QString sideString, bool *ok = nullptr);
 
+//Allocation-free overloads, strings are matched case-insensitively
+PROOF_NETWORK_MIS_EXPORT EntityStatus entityStatusFromString(const QStringRef &statusString, bool *ok = nullptr);
+PROOF_NETWORK_MIS_EXPORT EntityStatus entityStatusFromString(QLatin1String statusString, bool *ok = nullptr);
+PROOF_NETWORK_MIS_EXPORT WorkflowStatus workflowStatusFromString(const QStringRef &statusString, bool *ok = nullptr);
+PROOF_NETWORK_MIS_EXPORT WorkflowStatus workflowStatusFromString(QLatin1String statusString, bool *ok = nullptr);
+PROOF_NETWORK_MIS_EXPORT WorkflowAction workflowActionFromString(const QStringRef &actionString, bool *ok = nullptr);
+PROOF_NETWORK_MIS_EXPORT WorkflowAction workflowActionFromString(QLatin1String actionString, bool *ok = nullptr);
+PROOF_NETWORK_MIS_EXPORT TransitionEvent transitionEventFromString(const QStringRef &eventString, bool *ok = nullptr);
+PROOF_NETWORK_MIS_EXPORT TransitionEvent transitionEventFromString(QLatin1String eventString, bool *ok = nullptr);
+PROOF_NETWORK_MIS_EXPORT PaperSide paperSideFromString(const QStringRef &sideString, bool *ok = nullptr);
+PROOF_NETWORK_MIS_EXPORT PaperSide paperSideFromString(QLatin1String sideString, bool *ok = nullptr);
+
 PROOF_NETWORK_MIS_EXPORT WorkflowStatus workflowStatusAfterTransitionEvent(Proof::Mis::TransitionEvent event);
 
 PROOF_NETWORK_MIS_EXPORT uint qHash(EntityStatus arg, uint seed = 0);
@@ -94,6 +94,9 @@ signals:
 protected:
     explicit Job(const QString &id, const QString &source);
     void updateSelf(const Proof::NetworkDataEntitySP &other) override;
+
+private:
+    friend class JobsBinaryArchive;
 };
 
 PROOF_NETWORK_MIS_EXPORT ObjectsCache<JobCacheKey, Job> &jobsCache();
@@ -28,37 +28,52 @@
 #include "proofnetwork/mis/apihelper.h"
 #include "proofnetwork/mis/proofnetworkmis_global.h"
 
+#include <QJsonArray>
+#include <QString>
+#include <QVector>
+
+#include <utility>
+
 namespace Proof {
 namespace Mis {
 
-class WorkflowElementPrivate;
+//Plain three bytes value without heap allocations, trivially copyable
 class PROOF_NETWORK_MIS_EXPORT WorkflowElement
 {
-    Q_DECLARE_PRIVATE(WorkflowElement)
 public:
     explicit WorkflowElement(const QString &string = QString());
-    WorkflowElement(WorkflowAction action, WorkflowStatus status, PaperSide paperSide = PaperSide::NotSetSide);
-    WorkflowElement(const WorkflowElement &other);
-    WorkflowElement(WorkflowElement &&other);
-    ~WorkflowElement();
+    constexpr WorkflowElement(WorkflowAction action, WorkflowStatus status, PaperSide paperSide = PaperSide::NotSetSide)
+        : actionCode(static_cast<quint8>(action)), statusCode(static_cast<quint8>(status)),
+          paperSideCode(static_cast<quint8>(paperSide))
+    {}
 
-    WorkflowAction action() const;
-    void setAction(WorkflowAction arg);
-    WorkflowStatus status() const;
-    void setStatus(WorkflowStatus arg);
-    PaperSide paperSide() const;
-    void setPaperSide(PaperSide arg);
+    constexpr WorkflowAction action() const { return static_cast<WorkflowAction>(actionCode); }
+    void setAction(WorkflowAction arg) { actionCode = static_cast<quint8>(arg); }
+    constexpr WorkflowStatus status() const { return static_cast<WorkflowStatus>(statusCode); }
+    void setStatus(WorkflowStatus arg) { statusCode = static_cast<quint8>(arg); }
+    constexpr PaperSide paperSide() const { return static_cast<PaperSide>(paperSideCode); }
+    void setPaperSide(PaperSide arg) { paperSideCode = static_cast<quint8>(arg); }
 
     QString toString() const;
 
-    WorkflowElement &operator=(const WorkflowElement &other);
-    WorkflowElement &operator=(WorkflowElement &&other);
-    bool operator==(const WorkflowElement &other) const;
-    bool operator!=(const WorkflowElement &other) const;
-    void swap(WorkflowElement &other);
+    //Parses "status:action[:paper side]" without intermediate strings
+    static WorkflowElement fromString(const QStringRef &string);
+    static WorkflowElement fromUtf8(const char *data, int size);
+    static QVector<WorkflowElement> workflowFromJson(const QJsonArray &workflow);
+    //Scans raw JSON array of workflow strings directly, without building QJsonDocument
+    static QVector<WorkflowElement> workflowFromJson(const QByteArray &workflowJson, bool *ok = nullptr);
+
+    constexpr bool operator==(const WorkflowElement &other) const
+    {
+        return actionCode == other.actionCode && statusCode == other.statusCode && paperSideCode == other.paperSideCode;
+    }
+    constexpr bool operator!=(const WorkflowElement &other) const { return !(*this == other); }
+    void swap(WorkflowElement &other) { std::swap(*this, other); }
 
 private:
-    QScopedPointer<WorkflowElementPrivate> d_ptr;
+    quint8 actionCode = static_cast<quint8>(WorkflowAction::UnknownAction);
+    quint8 statusCode = static_cast<quint8>(WorkflowStatus::UnknownStatus);
+    quint8 paperSideCode = static_cast<quint8>(PaperSide::NotSetSide);
 };
 
 inline void swap(Proof::Mis::WorkflowElement &lhs, Proof::Mis::WorkflowElement &rhs)
@@ -69,4 +84,6 @@ inline void swap(Proof::Mis::WorkflowElement &lhs, Proof::Mis::WorkflowElement &
 } // namespace Mis
 } // namespace Proof
 
+Q_DECLARE_TYPEINFO(Proof::Mis::WorkflowElement, Q_MOVABLE_TYPE);
+
 #endif // PROOF_MIS_WORKFLOWELEMENT_H
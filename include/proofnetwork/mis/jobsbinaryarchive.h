@@ -0,0 +1,73 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_MIS_JOBSBINARYARCHIVE_H
+#define PROOF_MIS_JOBSBINARYARCHIVE_H
+
+#include "proofnetwork/mis/proofnetworkmis_global.h"
+#include "proofnetwork/mis/proofnetworkmis_types.h"
+
+#include <QScopedPointer>
+#include <QVector>
+
+namespace Proof {
+namespace Mis {
+//Compact versioned binary format for jobs collections, e.g. for restoring jobs cache after restart.
+//Strings are stored once in shared table, numbers as varints and workflow elements as three enum bytes.
+//Archive is loaded by reading only records boundaries, strings and jobs are decoded on first access.
+//Files are memory-mapped instead of reading them. Archive is not thread-safe.
+class JobsBinaryArchivePrivate;
+class PROOF_NETWORK_MIS_EXPORT JobsBinaryArchive
+{
+    Q_DECLARE_PRIVATE(JobsBinaryArchive)
+    Q_DISABLE_COPY(JobsBinaryArchive)
+public:
+    static constexpr quint8 FORMAT_VERSION = 1;
+
+    JobsBinaryArchive();
+    ~JobsBinaryArchive();
+
+    static QByteArray serialize(const QVector<JobSP> &jobs);
+    //Writes whole archive to temporary file first, so file is never left half-written
+    static bool save(const QVector<JobSP> &jobs, const QString &fileName);
+
+    bool load(const QByteArray &data);
+    bool load(const QString &fileName);
+    void close();
+
+    bool isLoaded() const;
+    QString errorString() const;
+    quint8 version() const;
+    int count() const;
+    //Jobs are built without change signals, each call creates new job
+    JobSP job(int index) const;
+    QVector<JobSP> jobs() const;
+
+private:
+    QScopedPointer<JobsBinaryArchivePrivate> d_ptr;
+};
+} // namespace Mis
+} // namespace Proof
+
+#endif // PROOF_MIS_JOBSBINARYARCHIVE_H
@@ -0,0 +1,89 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_MIS_JOBSJSONREADER_H
+#define PROOF_MIS_JOBSJSONREADER_H
+
+#include "proofnetwork/mis/proofnetworkmis_global.h"
+#include "proofnetwork/mis/proofnetworkmis_types.h"
+
+#include <QScopedPointer>
+#include <QVector>
+
+#include <functional>
+
+class QIODevice;
+
+namespace Proof {
+namespace Mis {
+//Incremental reader for JSON arrays of jobs, e.g. MIS jobs dumps.
+//Data can be fed in chunks of any size, whole document is never built: only the job being parsed,
+//unparsed tail of last chunk and current batch are kept in memory.
+//Jobs are built without change signals. When batch is complete its jobs are added to jobsCache() one by one,
+//cache has no bulk insert and takes its lock for each of them. Jobs that are already cached are updated
+//from parsed ones and passed to batch handler instead of them.
+class JobsJsonReaderPrivate;
+class PROOF_NETWORK_MIS_EXPORT JobsJsonReader
+{
+    Q_DECLARE_PRIVATE(JobsJsonReader)
+    Q_DISABLE_COPY(JobsJsonReader)
+public:
+    static constexpr int DEFAULT_BATCH_SIZE = 1000;
+    static constexpr qint64 DEFAULT_CHUNK_SIZE = 1 << 20;
+
+    using BatchHandler = std::function<void(const QVector<JobSP> &)>;
+    using ProgressHandler = std::function<void(qint64 bytesRead, qint64 jobsRead)>;
+
+    JobsJsonReader();
+    ~JobsJsonReader();
+
+    int batchSize() const;
+    void setBatchSize(int batchSize);
+    bool isCacheUsed() const;
+    void setCacheUsed(bool cacheUsed);
+    void setBatchHandler(const BatchHandler &handler);
+    //Called after each processed chunk of data
+    void setProgressHandler(const ProgressHandler &handler);
+
+    //Returns false if data is malformed, all data after error is ignored until reset()
+    bool addData(const QByteArray &data);
+    //Passes last incomplete batch to handler, returns false if array is not finished
+    bool finish();
+    //Reads device till its end and finishes
+    bool read(QIODevice *device, qint64 chunkSize = DEFAULT_CHUNK_SIZE);
+    void reset();
+
+    bool atEnd() const;
+    bool hasError() const;
+    QString errorString() const;
+    qint64 bytesRead() const;
+    qint64 jobsRead() const;
+
+private:
+    QScopedPointer<JobsJsonReaderPrivate> d_ptr;
+};
+} // namespace Mis
+} // namespace Proof
+
+#endif // PROOF_MIS_JOBSJSONREADER_H
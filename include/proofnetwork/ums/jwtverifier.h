@@ -0,0 +1,95 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_UMS_JWTVERIFIER_H
+#define PROOF_UMS_JWTVERIFIER_H
+
+#include "proofseed/future.h"
+
+#include "proofnetwork/ums/proofnetworkums_global.h"
+
+#include <QJsonObject>
+#include <QScopedPointer>
+
+#include <qca_publickey.h>
+
+namespace Proof {
+namespace Ums {
+
+//Verifies JSON Web Tokens locally, without asking UMS. All methods are thread-safe.
+//Signature is checked with RSA key (RS256), nbf and exp claims are checked against current time if present.
+class JwtVerifierPrivate;
+class PROOF_NETWORK_UMS_EXPORT JwtVerifier
+{
+    Q_DECLARE_PRIVATE(JwtVerifier)
+    Q_DISABLE_COPY(JwtVerifier)
+public:
+    enum class Result
+    {
+        Valid,
+        Malformed,
+        UnsupportedAlgorithm,
+        InvalidSignature,
+        NotYetValid,
+        Expired
+    };
+
+    struct Verification
+    {
+        Result result = Result::Malformed;
+        //Filled only if signature is verified
+        QJsonObject payload;
+
+        bool isValid() const { return result == Result::Valid; }
+        bool isSignatureVerified() const
+        {
+            return result == Result::Valid || result == Result::NotYetValid || result == Result::Expired;
+        }
+    };
+
+    explicit JwtVerifier(const QCA::RSAPublicKey &key = QCA::RSAPublicKey());
+    ~JwtVerifier();
+
+    QCA::RSAPublicKey rsaKey() const;
+    void setRsaKey(const QCA::RSAPublicKey &key);
+    //Allowed clock skew for nbf and exp checks
+    int leeway() const;
+    void setLeeway(int secs);
+    //Unsigned tokens are rejected with UnsupportedAlgorithm unless explicitly allowed
+    bool isUnsignedAllowed() const;
+    void setUnsignedAllowed(bool allowed);
+
+    Verification verify(const QByteArray &token) const;
+    //Tokens are verified in parallel, results are in same order as tokens.
+    //Settings at the moment of call are used for the whole batch.
+    FutureSP<QVector<Verification>> verify(const QVector<QByteArray> &tokens) const;
+
+private:
+    QScopedPointer<JwtVerifierPrivate> d_ptr;
+};
+
+} // namespace Ums
+} // namespace Proof
+
+#endif // PROOF_UMS_JWTVERIFIER_H
@@ -0,0 +1,78 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_UMS_TOKENMANAGER_H
+#define PROOF_UMS_TOKENMANAGER_H
+
+#include "proofseed/future.h"
+
+#include "proofcore/proofobject.h"
+
+#include "proofnetwork/ums/proofnetworkums_global.h"
+#include "proofnetwork/ums/proofnetworkums_types.h"
+
+namespace Proof {
+namespace Ums {
+
+//Holds current UMS token and refreshes it in background before it expires.
+//Refresh moment is shifted by random jitter, so several managers with same token don't refresh it at once.
+//Concurrent token requests share single fetch, it is canceled only when all of them are canceled.
+//Token can be requested from any thread, background refresh needs event loop in manager thread.
+class TokensApi;
+class TokenManagerPrivate;
+class PROOF_NETWORK_UMS_EXPORT TokenManager : public ProofObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(TokenManager)
+public:
+    explicit TokenManager(TokensApi *tokensApi, QObject *parent = nullptr);
+    ~TokenManager();
+
+    UmsTokenInfoSP tokenInfo() const;
+    //Token obtained elsewhere, for example with TokensApi::fetchTokenByLogin(). It will be refreshed from now on.
+    void setTokenInfo(const UmsTokenInfoSP &tokenInfo);
+
+    //How long before expiration refresh should happen
+    int refreshAhead() const;
+    void setRefreshAhead(int msecs);
+    //Refresh happens earlier by random amount up to this value
+    int refreshJitter() const;
+    void setRefreshJitter(int msecs);
+
+    qint64 deduplicatedRequestsCount() const;
+
+    //Returns current token without waiting while it is valid for few more seconds, otherwise refreshes it.
+    //If there is no token yet it is fetched with client credentials.
+    CancelableFuture<UmsTokenInfoSP> token();
+    //Refreshes token even if current one is still valid, joins refresh already in progress
+    CancelableFuture<UmsTokenInfoSP> refresh();
+
+signals:
+    void tokenChanged(const Proof::Ums::UmsTokenInfoSP &tokenInfo);
+};
+
+} // namespace Ums
+} // namespace Proof
+
+#endif // PROOF_UMS_TOKENMANAGER_H
@@ -34,6 +34,7 @@
 namespace Proof {
 namespace Ums {
 
+class JwtVerifier;
 class TokensApiPrivate;
 class PROOF_NETWORK_UMS_EXPORT TokensApi : public BaseRestApi
 {
@@ -46,6 +47,17 @@ public:
     QCA::RSAPublicKey rsaKey() const;
     void setRsaKey(const QCA::RSAPublicKey &key);
 
+    //Verified tokens are remembered until they expire, so same token is not verified again.
+    //Cache is cleared when RSA key is changed.
+    int verifiedTokensCacheCapacity() const;
+    void setVerifiedTokensCacheCapacity(int tokensCount);
+    qint64 verifiedTokensCacheHits() const;
+    void clearVerifiedTokensCache();
+
+    //Verifies tokens presented by clients with same RSA key, without requests to UMS.
+    //Unlike tokens fetched by TokensApi, unsigned tokens are rejected by it.
+    const JwtVerifier *jwtVerifier() const;
+
     CancelableFuture<UmsTokenInfoSP> fetchToken();
     CancelableFuture<UmsTokenInfoSP> fetchTokenByBarcode(const QString &barcode);
     CancelableFuture<UmsTokenInfoSP> fetchTokenByLogin(const QString &login, const QString &password);
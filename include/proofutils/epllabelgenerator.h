@@ -27,10 +27,43 @@
 
 #include "proofutils_global.h"
 
+#include <QHash>
 #include <QRect>
+#include <QStringList>
 
 namespace Proof {
 
+class LabelTemplatePrivate;
+class PROOF_UTILS_EXPORT LabelTemplate
+{
+    Q_DECLARE_PRIVATE(LabelTemplate)
+public:
+    LabelTemplate();
+    LabelTemplate(const LabelTemplate &other);
+    LabelTemplate(LabelTemplate &&other);
+    ~LabelTemplate();
+
+    LabelTemplate &operator=(const LabelTemplate &other);
+    LabelTemplate &operator=(LabelTemplate &&other);
+
+    bool isEmpty() const;
+    QStringList placeholders() const;
+
+    //Placeholders without value are rendered as empty strings
+    QByteArray render(const QHash<QString, QString> &values) const;
+
+    //Printer-stored forms (FS/FR). Each placeholder becomes form variable, QR code placeholders are not supported.
+    //Upload data contains only label body; setup commands and print command are sent with every recall.
+    //Form name should be 1 to 8 printable ASCII characters without quotes, otherwise empty data is returned.
+    bool canBeStoredAsForm() const;
+    QByteArray formUploadData(const QString &formName) const;
+    QByteArray formRecallData(const QString &formName, const QHash<QString, QString> &values) const;
+
+private:
+    friend class EplLabelGenerator;
+    QScopedPointer<LabelTemplatePrivate> d_ptr;
+};
+
 class EplLabelGeneratorPrivate;
 class PROOF_UTILS_EXPORT EplLabelGenerator
 {
@@ -99,11 +132,22 @@ public:
     QRect addLine(int x, int y, int width, int height, LineType type = LineType::Black);
     QRect addDiagonalLine(int x, int y, int endX, int endY, int width);
 
+    //Placeholders are filled later by LabelTemplate::render() on the template returned by labelTemplate().
+    //Numeric-only fonts (6 and 7) are allowed only if numericText is set, caller must provide digits there then.
+    void addTextPlaceholder(const QString &name, int x, int y, int fontSize = 4, int horizontalScale = 1,
+                            int verticalScale = 1, int rotation = 0, bool inverseColors = false,
+                            bool numericText = false);
+    QRect addBarcodePlaceholder(const QString &name, BarcodeType type, int x, int y, int height = 200,
+                                bool printReadableCode = true, int narrowBarWidth = 2, int wideBarWidth = 4,
+                                int rotation = 0);
+    QRect addQrCodePlaceholder(const QString &name, int x, int y, int width = 200);
+
     void addPrintCommand(int copies = 1);
     void addClearBufferCommand();
     void startPage();
 
     QByteArray labelData() const;
+    LabelTemplate labelTemplate() const;
 
 private:
     QScopedPointer<EplLabelGeneratorPrivate> d_ptr;
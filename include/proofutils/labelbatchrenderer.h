@@ -0,0 +1,54 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_UTILS_LABELBATCHRENDERER_H
+#define PROOF_UTILS_LABELBATCHRENDERER_H
+
+#include "proofseed/future.h"
+
+#include "proofutils/epllabelgenerator.h"
+#include "proofutils/proofutils_global.h"
+
+#include <QHash>
+#include <QVector>
+
+#include <functional>
+
+namespace Proof {
+namespace LabelBatchRenderer {
+using LabelDescription = std::function<void(EplLabelGenerator &)>;
+using LabelValues = QHash<QString, QString>;
+
+//Labels are rendered on tasks thread pool, results are always in input order
+PROOF_UTILS_EXPORT FutureSP<QVector<QByteArray>> render(const LabelTemplate &labelTemplate,
+                                                        const QVector<LabelValues> &rows);
+//Each description is called with freshly created generator, startLabel() is already called on it
+PROOF_UTILS_EXPORT FutureSP<QVector<QByteArray>> render(const QVector<LabelDescription> &labels,
+                                                        int printerDpi = 203);
+
+PROOF_UTILS_EXPORT QByteArray joined(const QVector<QByteArray> &labels);
+} // namespace LabelBatchRenderer
+} // namespace Proof
+
+#endif // PROOF_UTILS_LABELBATCHRENDERER_H
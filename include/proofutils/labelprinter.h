@@ -29,6 +29,8 @@
 
 #include "proofcore/proofobject.h"
 
+#include "proofutils/epllabelgenerator.h"
+#include "proofutils/printspool.h"
 #include "proofutils/proofutils_global.h"
 
 namespace Proof {
@@ -49,6 +51,22 @@ struct LabelPrinterParams
     int printerPort = 0;
     bool forceServiceUsage = false;
     bool strictHardwareCheck = true;
+    //Talk RFC 1179 to printerHost directly instead of spawning lpr/lpq
+    bool nativeLpd = false;
+    int lpdPort = 515;
+    //Used only with lpr, see LprPrinter::setReadinessCacheTtl() and LprPrinter::setReadinessPollingInterval()
+    int readinessCacheTtl = 0;
+    int readinessPollingInterval = 0;
+    //If set, printLabel only stores label in durable spool and it is printed in background, see PrintSpool.
+    //Spooled labels are sent from thread of LabelPrinter, so this thread should run event loop
+    QString spoolDirectory;
+    PrintSpool::SyncPolicy spoolSyncPolicy = PrintSpool::SyncPolicy::Grouped;
+    //Send labels directly to printer raw port (JetDirect) instead of lpr or print service
+    bool rawSocket = false;
+    int rawSocketPort = 9100;
+    //Forms uploaded by printStoredForm() are considered resident at printer for this time, 0 means always upload.
+    //Residency is also dropped on any failed print or readiness check of printer
+    int residentFormTtl = 10 * 60 * 1000;
 };
 
 class PROOF_UTILS_EXPORT LabelPrinter : public ProofObject
@@ -60,8 +78,17 @@ public:
     ~LabelPrinter();
 
     FutureSP<bool> printLabel(const QByteArray &label, bool ignorePrinterState = false) const;
+    //Uploads template as printer-stored form if it is not resident on this printer yet and recalls it with values.
+    //Label with form upload is always sent directly, even if spool is used.
+    FutureSP<bool> printStoredForm(const QString &formName, const LabelTemplate &labelTemplate,
+                                   const QHash<QString, QString> &values, bool ignorePrinterState = false) const;
+    bool isFormResident(const QString &formName, const LabelTemplate &labelTemplate) const;
+    //Should be called if printer is known to lose its stored forms, e.g. after reset
+    void forgetResidentForm(const QString &formName) const;
+    void forgetResidentForms() const;
     FutureSP<bool> printerIsReady() const;
     QString title() const;
+    qint64 spooledLabelsCount() const;
 };
 
 } // namespace Proof
@@ -0,0 +1,67 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_UTILS_LABELPRINTERPOOL_H
+#define PROOF_UTILS_LABELPRINTERPOOL_H
+
+#include "proofseed/future.h"
+
+#include "proofcore/proofobject.h"
+
+#include "proofutils/labelprinter.h"
+#include "proofutils/proofutils_global.h"
+
+namespace Proof {
+//Set of interchangeable printers. Each label goes to available printer with least labels in flight,
+//on error it is resent to next printer and failed one is skipped until it prints successfully again,
+//passes health check or its failover cooldown is over.
+//Pool must outlive labels sent through it. Spool directories of printers are ignored, pool sends labels directly.
+class LabelPrinterPoolPrivate;
+class PROOF_UTILS_EXPORT LabelPrinterPool : public ProofObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(LabelPrinterPool)
+public:
+    explicit LabelPrinterPool(const QVector<LabelPrinterParams> &params, QObject *parent = nullptr);
+
+    int printersCount() const;
+    QString printerTitle(int index) const;
+    //Labels sent to printer and not finished yet
+    int queueDepth(int index) const;
+    //Moving average of print time in msecs, 0 if printer didn't print anything yet
+    qint64 averageLatency(int index) const;
+    bool isPrinterAvailable(int index) const;
+
+    int failoverCooldown() const;
+    void setFailoverCooldown(int msecs);
+    //Unavailable printers are checked with LabelPrinter::printerIsReady() with this interval, 0 disables checks
+    int healthCheckInterval() const;
+    void setHealthCheckInterval(int msecs);
+
+    FutureSP<bool> printLabel(const QByteArray &label, bool ignorePrinterState = false) const;
+};
+
+} // namespace Proof
+
+#endif // PROOF_UTILS_LABELPRINTERPOOL_H
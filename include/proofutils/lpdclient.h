@@ -0,0 +1,66 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_UTILS_LPDCLIENT_H
+#define PROOF_UTILS_LPDCLIENT_H
+
+#include "proofseed/future.h"
+
+#include "proofutils/proofutils_global.h"
+
+#include <QScopedPointer>
+#include <QString>
+
+namespace Proof {
+namespace Hardware {
+//Line Printer Daemon protocol client (RFC 1179), talks to printer or print server directly without lpr/lpq processes
+class LpdClientPrivate;
+class PROOF_UTILS_EXPORT LpdClient
+{
+    Q_DECLARE_PRIVATE(LpdClient)
+    Q_DISABLE_COPY(LpdClient)
+public:
+    static constexpr quint16 DEFAULT_PORT = 515;
+
+    explicit LpdClient(const QString &host, const QString &queue, quint16 port = DEFAULT_PORT);
+    ~LpdClient();
+
+    QString host() const;
+    QString queue() const;
+    quint16 port() const;
+    int timeout() const;
+    void setTimeout(int msecs);
+
+    FutureSP<bool> printRawData(const QByteArray &data, unsigned int copies = 1,
+                                const QString &jobName = QString()) const;
+    FutureSP<bool> printFile(const QString &fileName, unsigned int copies = 1) const;
+    FutureSP<QString> fetchQueueState(bool verbose = false) const;
+
+private:
+    QScopedPointer<LpdClientPrivate> d_ptr;
+};
+} // namespace Hardware
+} // namespace Proof
+
+#endif // PROOF_UTILS_LPDCLIENT_H
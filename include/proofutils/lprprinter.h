@@ -29,6 +29,7 @@
 
 #include "proofcore/proofobject.h"
 
+#include "proofutils/lpdclient.h"
 #include "proofutils/proofutils_global.h"
 
 namespace Proof {
@@ -41,6 +42,24 @@ class PROOF_UTILS_EXPORT LprPrinter : public ProofObject
 public:
     explicit LprPrinter(const QString &printerHost, const QString &printerName, bool strictPrinterCheck = false,
                         QObject *parent = nullptr);
+    //Tasks of this printer still waiting for free process slot are failed
+    ~LprPrinter();
+
+    //Printers work independently of each other, this caps lpr/lpq/lpoptions processes running at once. 0 means no cap
+    static int maxConcurrentProcesses();
+    static void setMaxConcurrentProcesses(int count);
+
+    bool usesNativeLpd() const;
+    void setUseNativeLpd(bool useNativeLpd, quint16 lpdPort = LpdClient::DEFAULT_PORT);
+
+    //Successful readiness check is reused for ttl msecs, any failed print or check drops it. 0 means no caching
+    int readinessCacheTtl() const;
+    void setReadinessCacheTtl(int msecs);
+    //Periodically refreshes cached readiness in background. 0 means no polling.
+    //Polling results are used only through readiness cache, so nothing is polled while its ttl is 0
+    int readinessPollingInterval() const;
+    void setReadinessPollingInterval(int msecs);
+    void invalidateReadinessCache();
 
     FutureSP<bool> printRawData(const QByteArray &data, bool ignorePrinterState = false) const;
     FutureSP<bool> printFile(const QString &fileName, unsigned int quantity = 1, bool ignorePrinterState = false) const;
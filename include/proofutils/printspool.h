@@ -0,0 +1,97 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_UTILS_PRINTSPOOL_H
+#define PROOF_UTILS_PRINTSPOOL_H
+
+#include "proofseed/future.h"
+
+#include "proofutils/proofutils_global.h"
+
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QString>
+
+#include <functional>
+
+class QObject;
+
+namespace Proof {
+//Durable per-printer queues of labels. Each queue is an append-only file with records delivered in order,
+//delivery cursor is stored next to it and moved only after sender reports success, so after crash or restart
+//labels not confirmed yet are sent again (at-least-once delivery). Labels are kept on disk only.
+class PrintSpoolPrivate;
+class PROOF_UTILS_EXPORT PrintSpool
+{
+    Q_DECLARE_PRIVATE(PrintSpool)
+    Q_DISABLE_COPY(PrintSpool)
+public:
+    enum class SyncPolicy
+    {
+        EveryJob,
+        Grouped,
+        None
+    };
+    using Sender = std::function<FutureSP<bool>(const QByteArray &data, bool ignorePrinterState)>;
+
+    explicit PrintSpool(const QString &directory, SyncPolicy syncPolicy = SyncPolicy::Grouped);
+    ~PrintSpool();
+
+    //Spools are shared between all users of the same directory, so queue files are never opened twice
+    static QSharedPointer<PrintSpool> forDirectory(const QString &directory,
+                                                   SyncPolicy syncPolicy = SyncPolicy::Grouped);
+
+    QString directory() const;
+    SyncPolicy syncPolicy() const;
+    int retryInterval() const;
+    void setRetryInterval(int msecs);
+    qint64 maxQueueSize() const;
+    void setMaxQueueSize(qint64 bytes);
+    int syncGroupSize() const;
+    void setSyncGroupSize(int jobsCount);
+    //Grouped sync is also done this time after first unsynced job, so it doesn't wait for slowly filled group
+    int syncInterval() const;
+    void setSyncInterval(int msecs);
+
+    //Starts delivering queue with sender, including labels left from previous runs.
+    //Several senders can be attached to one queue, labels go to the earliest attached one.
+    //If context is set, sender is called in its thread (which should run event loop), otherwise in spool thread.
+    //Returns id to detach this sender with, 0 if queue can't be opened
+    qint64 attach(const QString &queueName, const Sender &sender, QObject *context = nullptr);
+    //Sender is never called after detach returns and result of its last call is resolved by then,
+    //so both can refer to objects destroyed right after that. This result shouldn't depend on detaching thread.
+    //Context should outlive sender attachment.
+    void detach(const QString &queueName, qint64 senderId);
+
+    //Resolved as soon as label is written to spool according to sync policy.
+    //ignorePrinterState is stored with label and passed to sender
+    FutureSP<bool> enqueue(const QString &queueName, const QByteArray &data, bool ignorePrinterState = false);
+    qint64 pendingCount(const QString &queueName) const;
+
+private:
+    QScopedPointer<PrintSpoolPrivate> d_ptr;
+};
+} // namespace Proof
+
+#endif // PROOF_UTILS_PRINTSPOOL_H
@@ -38,6 +38,7 @@ Q_DECLARE_LOGGING_CATEGORY(proofUtilsEplGeneratorLog);
 Q_DECLARE_LOGGING_CATEGORY(proofUtilsQrCodeGeneratorLog);
 Q_DECLARE_LOGGING_CATEGORY(proofUtilsLprPrinterInfoLog);
 Q_DECLARE_LOGGING_CATEGORY(proofUtilsLprPrinterDataLog);
+Q_DECLARE_LOGGING_CATEGORY(proofUtilsPrintSpoolLog);
 
 namespace Proof {
 namespace UtilsErrorCode {
@@ -54,7 +55,15 @@ enum Code
     PrinterOptionsCannotBeQueried = 106,
     PrinterNotReady = 107,
     TemporaryFileError = 108,
-    PrinterOffline = 109
+    PrinterOffline = 109,
+    FormCannotBeStored = 110,
+    LpdConnectionError = 111,
+    LpdProtocolError = 112,
+    FileCannotBeRead = 113,
+    RawSocketConnectionError = 114,
+    RawSocketBackpressure = 115,
+    SpoolError = 116,
+    SpoolIsFull = 117
 };
 }
 constexpr long UTILS_MODULE_CODE = 200;
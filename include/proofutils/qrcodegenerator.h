@@ -47,11 +47,27 @@ enum class ErrorCorrection
     HighLevel
 };
 
+struct CacheStatistics
+{
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 evictions = 0;
+    qlonglong usedMemory = 0;
+    qlonglong memoryLimit = 0;
+    int entriesCount = 0;
+};
+
 PROOF_UTILS_EXPORT QImage generateBitmap(const QString &string, int width = 200, Mode mode = Mode::Character,
                                          ErrorCorrection errorCorrection = ErrorCorrection::QuartileLevel);
 PROOF_UTILS_EXPORT QByteArray generateEplBinaryData(const QString &string, int width = 200, Mode mode = Mode::Character,
                                                     ErrorCorrection errorCorrection = ErrorCorrection::QuartileLevel);
 
+//EPL binary data is cached in thread-safe LRU cache with 16MB limit by default, 0 limit disables caching
+PROOF_UTILS_EXPORT void setCacheMemoryLimit(qlonglong bytes);
+PROOF_UTILS_EXPORT qlonglong cacheMemoryLimit();
+PROOF_UTILS_EXPORT CacheStatistics cacheStatistics();
+PROOF_UTILS_EXPORT void clearCache();
+
 PROOF_UTILS_EXPORT uint qHash(Proof::QrCodeGenerator::Mode arg, uint seed = 0);
 PROOF_UTILS_EXPORT uint qHash(Proof::QrCodeGenerator::ErrorCorrection arg, uint seed = 0);
 } // namespace QrCodeGenerator
@@ -0,0 +1,71 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PROOF_UTILS_RAWSOCKETPRINTER_H
+#define PROOF_UTILS_RAWSOCKETPRINTER_H
+
+#include "proofseed/future.h"
+
+#include "proofcore/proofobject.h"
+
+#include "proofutils/proofutils_global.h"
+
+namespace Proof {
+namespace Hardware {
+//Sends raw printer language (EPL, ZPL, etc.) to JetDirect-like port of printer.
+//Connection is kept open and shared by all instances pointing to the same host and port,
+//labels queued while previous write is in progress are sent together.
+class RawSocketPrinterPrivate;
+class PROOF_UTILS_EXPORT RawSocketPrinter : public ProofObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(RawSocketPrinter)
+public:
+    static constexpr quint16 DEFAULT_PORT = 9100;
+
+    explicit RawSocketPrinter(const QString &printerHost, quint16 printerPort = DEFAULT_PORT,
+                              QObject *parent = nullptr);
+
+    QString printerHost() const;
+    quint16 printerPort() const;
+
+    //Settings below are applied to shared connection
+    int timeout() const;
+    void setTimeout(int msecs);
+    qint64 maxBatchSize() const;
+    void setMaxBatchSize(qint64 bytes);
+    qint64 maxPendingSize() const;
+    void setMaxPendingSize(qint64 bytes);
+
+    qint64 pendingSize() const;
+    //Printer stopped accepting data during last write
+    bool isCongested() const;
+
+    FutureSP<bool> printRawData(const QByteArray &data) const;
+    FutureSP<bool> printerIsReady() const;
+};
+} // namespace Hardware
+} // namespace Proof
+
+#endif // PROOF_UTILS_RAWSOCKETPRINTER_H
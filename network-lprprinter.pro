@@ -10,13 +10,16 @@ CONFIG += proofcore proofnetwork
 
 HEADERS += \
     include/private/proofnetwork/lprprinter/errormessages_p.h \
+    include/private/proofnetwork/singleflight_p.h \
     include/proofnetwork/lprprinter/lprprinterapi.h \
+    include/proofnetwork/lprprinter/lprprinterstatuswatcher.h \
     include/proofnetwork/lprprinter/proofnetworklprprinter_global.h \
     include/proofnetwork/lprprinter/proofnetworklprprinter_types.h
 
 SOURCES += \
     src/proofnetwork/lprprinter/errormessages.cpp \
     src/proofnetwork/lprprinter/lprprinterapi.cpp \
+    src/proofnetwork/lprprinter/lprprinterstatuswatcher.cpp \
     src/proofnetwork/lprprinter/proofnetworklprprinter_init.cpp
 
 include($$PROOF_PRI_PATH/proof_translation.pri)
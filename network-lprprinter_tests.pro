@@ -5,9 +5,13 @@ include($$PROOF_PRI_PATH/proof_tests.pri)
 QT += network gui
 CONFIG += proofnetwork proofnetworklprprinter
 
+HEADERS += \
+    tests/common/fakesocketserver.h
+
 SOURCES += \
     tests/proofnetwork/lprprinter/main.cpp \
-    tests/proofnetwork/lprprinter/lprprinterapi_test.cpp
+    tests/proofnetwork/lprprinter/lprprinterapi_test.cpp \
+    tests/proofnetwork/lprprinter/lprprinterstatuswatcher_test.cpp
 
 RESOURCES += \
     tests/proofnetwork/lprprinter/test_resources.qrc
@@ -16,4 +20,5 @@ DISTFILES += \
     tests/proofnetwork/lprprinter/data/status.json \
     tests/proofnetwork/lprprinter/data/failed_status.json \
     tests/proofnetwork/lprprinter/data/file.txt \
-    tests/proofnetwork/lprprinter/data/printers.json
+    tests/proofnetwork/lprprinter/data/printers.json \
+    tests/proofnetwork/lprprinter/data/batch_results.json
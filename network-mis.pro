@@ -12,16 +12,21 @@ HEADERS += \
     include/proofnetwork/mis/proofnetworkmis_global.h \
     include/proofnetwork/mis/proofnetworkmis_types.h \
     include/proofnetwork/mis/apihelper.h \
+    include/proofnetwork/mis/jobsjsonreader.h \
+    include/proofnetwork/mis/jobsbinaryarchive.h \
     include/proofnetwork/mis/data/job.h \
     include/proofnetwork/mis/data/workflowelement.h \
-    include/proofnetwork/mis/data/qmlwrappers/jobqmlwrapper.h
+    include/proofnetwork/mis/data/qmlwrappers/jobqmlwrapper.h \
+    include/private/proofnetwork/mis/data/job_p.h
 
 SOURCES += \
     src/proofnetwork/mis/proofnetworkmis_init.cpp \
     src/proofnetwork/mis/data/job.cpp \
     src/proofnetwork/mis/data/workflowelement.cpp \
     src/proofnetwork/mis/data/qmlwrappers/jobqmlwrapper.cpp \
-    src/proofnetwork/mis/apihelper.cpp
+    src/proofnetwork/mis/apihelper.cpp \
+    src/proofnetwork/mis/jobsjsonreader.cpp \
+    src/proofnetwork/mis/jobsbinaryarchive.cpp
 
 
 include($$PROOF_PRI_PATH/proof_translation.pri)
@@ -7,7 +7,11 @@ CONFIG += proofnetworkmis
 
 SOURCES += \
     tests/proofnetwork/mis/main.cpp \
-    tests/proofnetwork/mis/job_test.cpp
+    tests/proofnetwork/mis/apihelper_test.cpp \
+    tests/proofnetwork/mis/job_test.cpp \
+    tests/proofnetwork/mis/jobsbinaryarchive_test.cpp \
+    tests/proofnetwork/mis/jobsjsonreader_test.cpp \
+    tests/proofnetwork/mis/workflowelement_test.cpp
 
 RESOURCES += \
     tests/proofnetwork/mis/tests_resources.qrc
@@ -15,8 +15,11 @@ HEADERS += \
     include/proofnetwork/ums/data/qmlwrappers/umsuserqmlwrapper.h \
     include/proofnetwork/ums/data/qmlwrappers/umstokeninfoqmlwrapper.h \
     include/proofnetwork/ums/tokensapi.h \
+    include/proofnetwork/ums/jwtverifier.h \
+    include/proofnetwork/ums/tokenmanager.h \
     include/proofnetwork/ums/data/umstokeninfo.h \
-    include/private/proofnetwork/ums/data/umsuser_p.h
+    include/private/proofnetwork/ums/data/umsuser_p.h \
+    include/private/proofnetwork/singleflight_p.h
 
 SOURCES += \
     src/proofnetwork/ums/proofnetworkums_init.cpp \
@@ -24,6 +27,8 @@ SOURCES += \
     src/proofnetwork/ums/data/qmlwrappers/umsuserqmlwrapper.cpp \
     src/proofnetwork/ums/data/qmlwrappers/umstokeninfoqmlwrapper.cpp \
     src/proofnetwork/ums/tokensapi.cpp \
+    src/proofnetwork/ums/jwtverifier.cpp \
+    src/proofnetwork/ums/tokenmanager.cpp \
     src/proofnetwork/ums/data/umstokeninfo.cpp
 
 include($$PROOF_PRI_PATH/proof_translation.pri)
@@ -8,7 +8,9 @@ CONFIG += proofnetwork proofnetworkums
 SOURCES += \
     tests/proofnetwork/ums/main.cpp \
     tests/proofnetwork/ums/umsuser_test.cpp \
-    tests/proofnetwork/ums/tokensapi_test.cpp
+    tests/proofnetwork/ums/tokensapi_test.cpp \
+    tests/proofnetwork/ums/jwtverifier_test.cpp \
+    tests/proofnetwork/ums/tokenmanager_test.cpp
 
 RESOURCES += \
     tests/proofnetwork/ums/tests_resources.qrc
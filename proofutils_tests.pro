@@ -4,5 +4,9 @@ utils.file = utils_tests.pro
 network-lpr.file = network-lprprinter_tests.pro
 network-mis.file = network-mis_tests.pro
 network-ums.file = network-ums_tests.pro
+benchmarks.file = benchmarks_tests.pro
 
 SUBDIRS = utils network-lpr network-mis network-ums
+
+#Timing benchmarks take long and use fixed ports, enabled with CONFIG+=proofutils_benchmarks
+proofutils_benchmarks: SUBDIRS += benchmarks
@@ -27,15 +27,38 @@
 #include "proofnetwork/lprprinter/errormessages_p.h"
 #include "proofnetwork/lprprinter/proofnetworklprprinter_types.h"
 #include "proofnetwork/proofservicerestapi_p.h"
+#include "proofnetwork/singleflight_p.h"
 
 #include <QFile>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMutex>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QtEndian>
+
+#include <atomic>
+#include <functional>
+#include <limits>
+
+static const int DEFAULT_LABELS_BATCH_SIZE = 100;
+//Service prints batches in order it gets them, and with several requests in flight this order is not guaranteed.
+//Labels of one job are usually expected to come out in order, so pipelining has to be enabled explicitly
+static const int DEFAULT_MAX_BATCHES_IN_FLIGHT = 1;
 
 namespace Proof {
 namespace NetworkServices {
 
+//Caller gets future of its own promise, so its cancel is passed to request which does the actual work
+template <typename T, typename Request>
+static void forwardCancelation(const PromiseSP<T> &promise, Request request)
+{
+    promise->future()->onFailure([request](const Failure &) mutable { request.cancel(); });
+}
+
 class LprPrinterApiPrivate : public ProofServiceRestApiPrivate
 {
     Q_DECLARE_PUBLIC(LprPrinterApi)
@@ -83,7 +106,156 @@ class LprPrinterApiPrivate : public ProofServiceRestApiPrivate
             return true;
         };
     }
+
+    auto labelsResultsUnmarshaller(int labelsCount)
+    {
+        return [labelsCount](const RestApiReply &reply) -> QVector<LprPrinterLabelResult> {
+            QJsonParseError jsonError;
+            QJsonDocument doc = QJsonDocument::fromJson(reply.data, &jsonError);
+            if (jsonError.error != QJsonParseError::NoError) {
+                return WithFailure(QStringLiteral("JSON error: %1").arg(jsonError.errorString()),
+                                   NETWORK_LPR_PRINTER_MODULE_CODE, NetworkErrorCode::InvalidReply, Failure::NoHint,
+                                   jsonError.error);
+            }
+            if (!doc.isArray()) {
+                return WithFailure(QStringLiteral("Array is not found in document"), NETWORK_LPR_PRINTER_MODULE_CODE,
+                                   NetworkErrorCode::InvalidReply);
+            }
+            const QJsonArray array = doc.array();
+            QVector<LprPrinterLabelResult> results;
+            results.reserve(labelsCount);
+            for (const QJsonValue &value : array) {
+                QJsonObject object = value.toObject();
+                results << LprPrinterLabelResult{object.value(QStringLiteral("printed")).toBool(),
+                                                 object.value(QStringLiteral("reason")).toString()};
+            }
+            while (results.count() < labelsCount)
+                results << LprPrinterLabelResult{false, QStringLiteral("Label result is missing in reply")};
+            results.resize(labelsCount);
+            return results;
+        };
+    }
+
+    //Services without some endpoint reply with one of these HTTP statuses
+    static bool isEndpointUnsupported(const Failure &failure)
+    {
+        int httpStatus = failure.data.toInt();
+        return httpStatus == 404 || httpStatus == 405 || httpStatus == 415;
+    }
+
+    std::atomic<bool> binaryUploadUnsupported{false};
+    std::atomic<bool> batchUploadUnsupported{false};
+    std::atomic<int> labelsBatchSize{DEFAULT_LABELS_BATCH_SIZE};
+    std::atomic<int> maxBatchesInFlight{DEFAULT_MAX_BATCHES_IN_FLIGHT};
+
+    SingleFlight<LprPrinterStatus> statusFetches;
+    SingleFlight<QVector<LprPrinterInfo>> printersListFetches;
+    std::atomic<int> statusCacheTtl{0};
 };
+
+//State of one printLabels() call, shared by its batches
+struct LabelsBatching
+{
+    std::function<CancelableFuture<QVector<LprPrinterLabelResult>>(const QVector<QByteArray> &)> sendBatch;
+    QVector<QByteArray> labels;
+    PromiseSP<QVector<LprPrinterLabelResult>> promise;
+    int batchSize = 1;
+
+    QMutex mutex;
+    QVector<LprPrinterLabelResult> results;
+    QHash<int, CancelableFuture<QVector<LprPrinterLabelResult>>> batchesInFlight;
+    int nextLabel = 0;
+    bool canceled = false;
+};
+
+static void sendNextLabelsBatch(const QSharedPointer<LabelsBatching> &batching)
+{
+    QMutexLocker lock(&batching->mutex);
+    if (batching->canceled || batching->nextLabel >= batching->labels.count())
+        return;
+    int from = batching->nextLabel;
+    int count = qMin(batching->batchSize, batching->labels.count() - from);
+    batching->nextLabel += count;
+    QVector<QByteArray> batch = batching->labels.mid(from, count);
+    lock.unlock();
+
+    auto batchFinished = [batching, from, count](const QVector<LprPrinterLabelResult> &batchResults) {
+        QMutexLocker lock(&batching->mutex);
+        for (int i = 0; i < count; ++i)
+            batching->results[from + i] = batchResults[i];
+        batching->batchesInFlight.remove(from);
+        bool done = !batching->canceled && batching->batchesInFlight.isEmpty()
+                    && batching->nextLabel >= batching->labels.count();
+        lock.unlock();
+        if (done)
+            batching->promise->success(batching->results);
+        else
+            sendNextLabelsBatch(batching);
+    };
+    auto request = batching->sendBatch(batch);
+    lock.relock();
+    batching->batchesInFlight.insert(from, request);
+    bool canceled = batching->canceled;
+    lock.unlock();
+    if (canceled)
+        request.cancel();
+    request->onSuccess(batchFinished)->onFailure([batchFinished, count](const Failure &failure) {
+        batchFinished(QVector<LprPrinterLabelResult>(count, LprPrinterLabelResult{false, failure.message}));
+    });
+}
+
+static void cancelLabelsBatching(const QSharedPointer<LabelsBatching> &batching)
+{
+    QMutexLocker lock(&batching->mutex);
+    batching->canceled = true;
+    auto requests = batching->batchesInFlight.values();
+    lock.unlock();
+    for (auto &request : requests)
+        request.cancel();
+}
+
+//Labels are sent one after another, so they are printed in the same order as with batch endpoint
+static void printNextLabel(const QPointer<LprPrinterApi> &api, const QVector<QByteArray> &labels,
+                           const QString &printer, const PromiseSP<QVector<LprPrinterLabelResult>> &promise,
+                           const QSharedPointer<QVector<LprPrinterLabelResult>> &results)
+{
+    //Canceled
+    if (promise->future()->completed())
+        return;
+    if (results->count() == labels.count()) {
+        promise->success(*results);
+        return;
+    }
+    if (!api) {
+        promise->failure(Failure(QStringLiteral("Lpr-Printer api is destroyed"), NETWORK_LPR_PRINTER_MODULE_CODE,
+                                 NetworkErrorCode::InternalError));
+        return;
+    }
+    auto request = api->printLabel(labels[results->count()], printer);
+    forwardCancelation(promise, request);
+    request
+        ->onSuccess([api, labels, printer, promise, results](bool) {
+            results->append(LprPrinterLabelResult{true, QString()});
+            printNextLabel(api, labels, printer, promise, results);
+        })
+        ->onFailure([api, labels, printer, promise, results](const Failure &failure) {
+            results->append(LprPrinterLabelResult{false, failure.message});
+            printNextLabel(api, labels, printer, promise, results);
+        });
+}
+
+//Fallback for services without batch endpoint
+static CancelableFuture<QVector<LprPrinterLabelResult>> printLabelsOneByOne(const QPointer<LprPrinterApi> &api,
+                                                                            const QVector<QByteArray> &labels,
+                                                                            const QString &printer)
+{
+    auto promise = PromiseSP<QVector<LprPrinterLabelResult>>::create();
+    auto results = QSharedPointer<QVector<LprPrinterLabelResult>>::create();
+    results->reserve(labels.count());
+    printNextLabel(api, labels, printer, promise, results);
+    return CancelableFuture<QVector<LprPrinterLabelResult>>(promise);
+}
+
 } // namespace NetworkServices
 } // namespace Proof
 
@@ -95,45 +267,199 @@ LprPrinterApi::LprPrinterApi(const RestClientSP &restClient, QObject *parent)
 {}
 
 CancelableFuture<LprPrinterStatus> LprPrinterApi::fetchStatus(const QString &printer)
+{
+    Q_D(LprPrinterApi);
+    return d->statusFetches.fetch(printer, d->statusCacheTtl, [this, d, printer]() {
+        QUrlQuery query;
+        if (!printer.isEmpty())
+            query.addQueryItem(QStringLiteral("printer"), printer);
+        return unmarshalReply(get(QStringLiteral("/lpr/status"), query), d->printerStatusUnmarshaller());
+    });
+}
+
+CancelableFuture<bool> LprPrinterApi::printLabel(const QByteArray &label, const QString &printer)
 {
     Q_D(LprPrinterApi);
     QUrlQuery query;
     if (!printer.isEmpty())
         query.addQueryItem(QStringLiteral("printer"), printer);
-    return unmarshalReply(get(QStringLiteral("/lpr/status"), query), d->printerStatusUnmarshaller());
+
+    auto printAsJson = [this, d, label, query]() {
+        return unmarshalReply(post(QStringLiteral("/lpr/print-raw"), query,
+                                   QByteArrayLiteral("{\"data\": \"") + label.toBase64() + QByteArrayLiteral("\"}")),
+                              d->discardingPrinterStatusUnmarshaller());
+    };
+    if (d->binaryUploadUnsupported)
+        return printAsJson();
+
+    //Label goes as is, without base64 and JSON wrapping. Older services don't have this endpoint,
+    //so we fall back to JSON once and don't try binary upload again for this api instance.
+    //Cancel is passed to the request being sent at the moment, binary one or its fallback
+    PromiseSP<bool> promise = PromiseSP<bool>::create();
+    QPointer<LprPrinterApi> api(this);
+    auto binaryRequest = unmarshalReply(post(QStringLiteral("/lpr/print-raw/binary"), query, label),
+                                        d->discardingPrinterStatusUnmarshaller());
+    forwardCancelation(promise, binaryRequest);
+    binaryRequest->onSuccess([promise](bool result) { promise->success(result); })
+        ->onFailure([api, promise, printAsJson](const Failure &failure) {
+            if (promise->future()->completed())
+                return;
+            if (!api || !LprPrinterApiPrivate::isEndpointUnsupported(failure)) {
+                promise->failure(failure);
+                return;
+            }
+            qCDebug(proofNetworkLprPrinterLog) << "Lpr-Printer: binary label upload is not supported, using JSON";
+            api->d_func()->binaryUploadUnsupported = true;
+            auto jsonRequest = printAsJson();
+            forwardCancelation(promise, jsonRequest);
+            jsonRequest->onSuccess([promise](bool result) { promise->success(result); })
+                ->onFailure([promise](const Failure &failure) { promise->failure(failure); });
+        });
+    return CancelableFuture<bool>(promise);
 }
 
-CancelableFuture<bool> LprPrinterApi::printLabel(const QByteArray &label, const QString &printer)
+CancelableFuture<QVector<LprPrinterLabelResult>> LprPrinterApi::printLabels(const QVector<QByteArray> &labels,
+                                                                            const QString &printer)
 {
     Q_D(LprPrinterApi);
+    auto batching = QSharedPointer<LabelsBatching>::create();
+    batching->promise = PromiseSP<QVector<LprPrinterLabelResult>>::create();
+    if (labels.isEmpty()) {
+        batching->promise->success(QVector<LprPrinterLabelResult>());
+        return CancelableFuture<QVector<LprPrinterLabelResult>>(batching->promise);
+    }
+
     QUrlQuery query;
     if (!printer.isEmpty())
         query.addQueryItem(QStringLiteral("printer"), printer);
-    return unmarshalReply(post(QStringLiteral("/lpr/print-raw"), query,
-                               QStringLiteral("{\"data\": \"%1\"}").arg(label.toBase64().constData()).toLatin1()),
-                          d->discardingPrinterStatusUnmarshaller());
+
+    batching->labels = labels;
+    batching->results.resize(labels.count());
+    batching->batchSize = qMax(1, d->labelsBatchSize.load());
+    //Each label in body is prefixed with its size as 32-bit big-endian integer.
+    //Reply is JSON array with {"printed": bool, "reason": string} object for each label.
+    //Batches can be sent after api is destroyed, so they hold it weakly
+    QPointer<LprPrinterApi> api(this);
+    batching->sendBatch = [api, query, printer](const QVector<QByteArray> &batch) {
+        if (!api || api->d_func()->batchUploadUnsupported)
+            return printLabelsOneByOne(api, batch, printer);
+
+        QByteArray body;
+        int bodySize = 0;
+        for (const QByteArray &label : batch)
+            bodySize += label.size() + static_cast<int>(sizeof(quint32));
+        body.reserve(bodySize);
+        for (const QByteArray &label : batch) {
+            quint32 labelSize = qToBigEndian(static_cast<quint32>(label.size()));
+            body.append(reinterpret_cast<const char *>(&labelSize), sizeof(labelSize));
+            body.append(label);
+        }
+
+        auto promise = PromiseSP<QVector<LprPrinterLabelResult>>::create();
+        auto request = api->unmarshalReply(api->post(QStringLiteral("/lpr/print-raw/batch"), query, body),
+                                           api->d_func()->labelsResultsUnmarshaller(batch.count()));
+        forwardCancelation(promise, request);
+        request->onSuccess([promise](const QVector<LprPrinterLabelResult> &results) { promise->success(results); })
+            ->onFailure([api, promise, batch, printer](const Failure &failure) {
+                if (promise->future()->completed())
+                    return;
+                if (!api || !LprPrinterApiPrivate::isEndpointUnsupported(failure)) {
+                    promise->failure(failure);
+                    return;
+                }
+                qCDebug(proofNetworkLprPrinterLog) << "Lpr-Printer: batch printing is not supported";
+                api->d_func()->batchUploadUnsupported = true;
+                auto fallback = printLabelsOneByOne(api, batch, printer);
+                forwardCancelation(promise, fallback);
+                fallback->onSuccess(
+                    [promise](const QVector<LprPrinterLabelResult> &results) { promise->success(results); });
+            });
+        return CancelableFuture<QVector<LprPrinterLabelResult>>(promise);
+    };
+    //Batches that are not sent yet are dropped and the ones in flight are canceled
+    batching->promise->future()->onFailure([batching](const Failure &) { cancelLabelsBatching(batching); });
+
+    //Next batches are sent while previous ones are still being processed by service, if allowed
+    int batchesToStart = qMax(1, d->maxBatchesInFlight.load());
+    for (int i = 0; i < batchesToStart; ++i)
+        sendNextLabelsBatch(batching);
+    return CancelableFuture<QVector<LprPrinterLabelResult>>(batching->promise);
+}
+
+int LprPrinterApi::labelsBatchSize() const
+{
+    Q_D_CONST(LprPrinterApi);
+    return d->labelsBatchSize;
+}
+
+void LprPrinterApi::setLabelsBatchSize(int labelsCount)
+{
+    Q_D(LprPrinterApi);
+    d->labelsBatchSize = qMax(1, labelsCount);
+}
+
+int LprPrinterApi::maxBatchesInFlight() const
+{
+    Q_D_CONST(LprPrinterApi);
+    return d->maxBatchesInFlight;
+}
+
+void LprPrinterApi::setMaxBatchesInFlight(int batchesCount)
+{
+    Q_D(LprPrinterApi);
+    d->maxBatchesInFlight = qMax(1, batchesCount);
 }
 
 CancelableFuture<bool> LprPrinterApi::printFile(const QString &fileName, const QString &printer, unsigned int copies)
 {
     Q_D(LprPrinterApi);
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qCWarning(proofNetworkLprPrinterLog) << "Lpr-Printer: file error:" << file.error() << file.errorString();
+    auto file = QSharedPointer<QFile>::create(fileName);
+    if (!file->open(QIODevice::ReadOnly)) {
+        qCWarning(proofNetworkLprPrinterLog) << "Lpr-Printer: file error:" << file->error() << file->errorString();
         return invalidArgumentsFailure<bool>(
             Failure(QStringLiteral("Can't open file"), NETWORK_LPR_PRINTER_MODULE_CODE, NetworkErrorCode::FileError));
     }
-    QByteArray data = file.readAll();
-    if (file.error() != QFileDevice::NoError) {
-        qCWarning(proofNetworkLprPrinterLog) << "Lpr-Printer: file error:" << file.error() << file.errorString();
+    if (file->size() > std::numeric_limits<int>::max()) {
+        qCWarning(proofNetworkLprPrinterLog) << "Lpr-Printer: file is too big:" << fileName << file->size();
         return invalidArgumentsFailure<bool>(
-            Failure(QStringLiteral("Can't read file"), NETWORK_LPR_PRINTER_MODULE_CODE, NetworkErrorCode::FileError));
+            Failure(QStringLiteral("File is too big"), NETWORK_LPR_PRINTER_MODULE_CODE, NetworkErrorCode::FileError));
+    }
+
+    //File is mapped and network layer reads request body right from the mapping, so file is never copied to heap.
+    //Files that can't be mapped (compressed resources, etc.) are read.
+    QByteArray data;
+    uchar *mapped = file->size() ? file->map(0, file->size()) : nullptr;
+    if (mapped) {
+        data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), static_cast<int>(file->size()));
+    } else {
+        data = file->readAll();
+        if (file->error() != QFileDevice::NoError) {
+            qCWarning(proofNetworkLprPrinterLog) << "Lpr-Printer: file error:" << file->error() << file->errorString();
+            return invalidArgumentsFailure<bool>(Failure(QStringLiteral("Can't read file"),
+                                                         NETWORK_LPR_PRINTER_MODULE_CODE, NetworkErrorCode::FileError));
+        }
+        file->close();
     }
+
     QUrlQuery query;
     query.addQueryItem(QStringLiteral("copies"), QString::number(copies));
     if (!printer.isEmpty())
         query.addQueryItem(QStringLiteral("printer"), printer);
-    return unmarshalReply(post(QStringLiteral("/lpr/print"), query, data), d->discardingPrinterStatusUnmarshaller());
+    auto result = unmarshalReply(post(QStringLiteral("/lpr/print"), query, data),
+                                 d->discardingPrinterStatusUnmarshaller());
+    if (mapped) {
+        //Body still refers to the mapping while network reply exists and reply is deleted by event loop after it
+        //is finished, so mapping is released one event loop iteration later than result is filled
+        QPointer<LprPrinterApi> api(this);
+        auto releaseMapping = [api, file]() {
+            if (api)
+                QTimer::singleShot(0, api, [file] { file->close(); });
+        };
+        result->onSuccess([releaseMapping](bool) { releaseMapping(); })->onFailure([releaseMapping](const Failure &) {
+            releaseMapping();
+        });
+    }
+    return result;
 }
 
 CancelableFuture<QVector<LprPrinterInfo>> LprPrinterApi::fetchPrintersList()
@@ -161,5 +487,40 @@ CancelableFuture<QVector<LprPrinterInfo>> LprPrinterApi::fetchPrintersList()
         }
         return printers;
     };
-    return unmarshalReply(get(QStringLiteral("/lpr/list")), unmarshaller);
+    Q_D(LprPrinterApi);
+    return d->printersListFetches.fetch(QString(), d->statusCacheTtl, [this, unmarshaller]() {
+        return unmarshalReply(get(QStringLiteral("/lpr/list")), unmarshaller);
+    });
+}
+
+int LprPrinterApi::statusCacheTtl() const
+{
+    Q_D_CONST(LprPrinterApi);
+    return d->statusCacheTtl;
+}
+
+void LprPrinterApi::setStatusCacheTtl(int msecs)
+{
+    Q_D(LprPrinterApi);
+    d->statusCacheTtl = qMax(0, msecs);
+    invalidateStatusCache();
+}
+
+void LprPrinterApi::invalidateStatusCache()
+{
+    Q_D(LprPrinterApi);
+    d->statusFetches.invalidate();
+    d->printersListFetches.invalidate();
+}
+
+qint64 LprPrinterApi::deduplicatedRequestsCount() const
+{
+    Q_D_CONST(LprPrinterApi);
+    return d->statusFetches.deduplicatedCount() + d->printersListFetches.deduplicatedCount();
+}
+
+qint64 LprPrinterApi::cachedRepliesCount() const
+{
+    Q_D_CONST(LprPrinterApi);
+    return d->statusFetches.cacheHitsCount() + d->printersListFetches.cacheHitsCount();
 }
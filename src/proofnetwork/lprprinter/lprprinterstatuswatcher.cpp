@@ -0,0 +1,356 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "proofnetwork/lprprinter/lprprinterstatuswatcher.h"
+
+#include "proofcore/proofobject_p.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QTimer>
+#include <QUrlQuery>
+
+#include <atomic>
+
+static const int DEFAULT_POLLING_INTERVAL = 5000;
+
+namespace Proof {
+namespace NetworkServices {
+
+class LprPrinterStatusWatcherPrivate : public ProofObjectPrivate
+{
+    Q_DECLARE_PUBLIC(LprPrinterStatusWatcher)
+
+    void openStream();
+    void attachStream(QNetworkReply *reply);
+    void streamNotOpened();
+    void readStream();
+    void streamFinished();
+    void dispatchEvent();
+    void poll();
+    void updateStatus(const LprPrinterStatus &newStatus);
+
+    RestClientSP restClient;
+    QString printer;
+    LprPrinterApi *api = nullptr;
+    QNetworkReply *stream = nullptr;
+    bool streamOpening = false;
+    QTimer *pollTimer = nullptr;
+    QTimer *reconnectTimer = nullptr;
+    QByteArray streamBuffer;
+    QByteArray eventData;
+    bool running = false;
+    bool pushUnsupported = false;
+    std::atomic<bool> pushActive{false};
+
+    mutable QMutex statusMutex;
+    LprPrinterStatus status{false, QString()};
+    bool hasStatus = false;
+};
+
+} // namespace NetworkServices
+} // namespace Proof
+
+using namespace Proof;
+using namespace Proof::NetworkServices;
+
+LprPrinterStatusWatcher::LprPrinterStatusWatcher(const RestClientSP &restClient, const QString &printer,
+                                                 QObject *parent)
+    : ProofObject(*new LprPrinterStatusWatcherPrivate, parent)
+{
+    Q_D(LprPrinterStatusWatcher);
+    d->restClient = restClient;
+    d->printer = printer;
+    d->api = new LprPrinterApi(restClient, this);
+
+    d->pollTimer = new QTimer(this);
+    d->pollTimer->setInterval(DEFAULT_POLLING_INTERVAL);
+    connect(d->pollTimer, &QTimer::timeout, this, [d] { d->poll(); });
+
+    d->reconnectTimer = new QTimer(this);
+    d->reconnectTimer->setSingleShot(true);
+    d->reconnectTimer->setInterval(DEFAULT_POLLING_INTERVAL);
+    connect(d->reconnectTimer, &QTimer::timeout, this, [d] { d->openStream(); });
+}
+
+LprPrinterStatusWatcher::~LprPrinterStatusWatcher()
+{
+    stop();
+}
+
+QString LprPrinterStatusWatcher::printer() const
+{
+    Q_D_CONST(LprPrinterStatusWatcher);
+    return d->printer;
+}
+
+int LprPrinterStatusWatcher::pollingInterval() const
+{
+    Q_D_CONST(LprPrinterStatusWatcher);
+    return d->pollTimer->interval();
+}
+
+void LprPrinterStatusWatcher::setPollingInterval(int msecs)
+{
+    Q_D(LprPrinterStatusWatcher);
+    msecs = qMax(1, msecs);
+    d->pollTimer->setInterval(msecs);
+    d->reconnectTimer->setInterval(msecs);
+}
+
+bool LprPrinterStatusWatcher::isRunning() const
+{
+    Q_D_CONST(LprPrinterStatusWatcher);
+    return d->running;
+}
+
+bool LprPrinterStatusWatcher::isPushActive() const
+{
+    Q_D_CONST(LprPrinterStatusWatcher);
+    return d->pushActive;
+}
+
+bool LprPrinterStatusWatcher::hasStatus() const
+{
+    Q_D_CONST(LprPrinterStatusWatcher);
+    QMutexLocker lock(&d->statusMutex);
+    return d->hasStatus;
+}
+
+LprPrinterStatus LprPrinterStatusWatcher::status() const
+{
+    Q_D_CONST(LprPrinterStatusWatcher);
+    QMutexLocker lock(&d->statusMutex);
+    return d->status;
+}
+
+void LprPrinterStatusWatcher::start()
+{
+    Q_D(LprPrinterStatusWatcher);
+    if (d->running)
+        return;
+    d->running = true;
+    if (d->pushUnsupported) {
+        d->poll();
+        d->pollTimer->start();
+    } else {
+        d->openStream();
+    }
+}
+
+void LprPrinterStatusWatcher::stop()
+{
+    Q_D(LprPrinterStatusWatcher);
+    if (!d->running)
+        return;
+    d->running = false;
+    d->pollTimer->stop();
+    d->reconnectTimer->stop();
+    if (d->stream)
+        d->stream->abort();
+}
+
+void LprPrinterStatusWatcherPrivate::openStream()
+{
+    Q_Q(LprPrinterStatusWatcher);
+    if (!running || stream || streamOpening)
+        return;
+    QUrlQuery query;
+    if (!printer.isEmpty())
+        query.addQueryItem(QStringLiteral("printer"), printer);
+
+    //Stream is requested through RestClient, so it has the same auth, client name and headers as other requests.
+    //Reply is handled in watcher thread
+    streamOpening = true;
+    QPointer<LprPrinterStatusWatcher> watcher(q);
+    restClient->get(QStringLiteral("/lpr/status/events"), query)
+        ->onSuccess([watcher](QNetworkReply *reply) {
+            if (!watcher) {
+                reply->abort();
+                reply->deleteLater();
+                return;
+            }
+            QMetaObject::invokeMethod(
+                watcher.data(),
+                [watcher, reply] {
+                    if (watcher)
+                        watcher->d_func()->attachStream(reply);
+                },
+                Qt::QueuedConnection);
+        })
+        ->onFailure([watcher](const Failure &failure) {
+            qCWarning(proofNetworkLprPrinterLog) << "Lpr-Printer: can't request status events:" << failure.message;
+            if (!watcher)
+                return;
+            QMetaObject::invokeMethod(
+                watcher.data(),
+                [watcher] {
+                    if (watcher)
+                        watcher->d_func()->streamNotOpened();
+                },
+                Qt::QueuedConnection);
+        });
+}
+
+void LprPrinterStatusWatcherPrivate::attachStream(QNetworkReply *reply)
+{
+    Q_Q(LprPrinterStatusWatcher);
+    streamOpening = false;
+    if (!running) {
+        reply->abort();
+        reply->deleteLater();
+        return;
+    }
+    streamBuffer.clear();
+    eventData.clear();
+    stream = reply;
+    QObject::connect(stream, &QNetworkReply::readyRead, q, [this] { readStream(); });
+    QObject::connect(stream, &QNetworkReply::finished, q, [this] { streamFinished(); });
+    //Reply could get something before it was connected
+    if (stream->isFinished())
+        streamFinished();
+    else if (stream->bytesAvailable())
+        readStream();
+}
+
+void LprPrinterStatusWatcherPrivate::streamNotOpened()
+{
+    streamOpening = false;
+    if (!running)
+        return;
+    reconnectTimer->start();
+    poll();
+    pollTimer->start();
+}
+
+void LprPrinterStatusWatcherPrivate::readStream()
+{
+    if (!pushActive) {
+        int httpStatus = stream->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        QByteArray contentType = stream->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+        //Anything else is handled when reply is finished
+        if (httpStatus != 200 || !contentType.startsWith("text/event-stream"))
+            return;
+        qCDebug(proofNetworkLprPrinterLog) << "Lpr-Printer: status events stream opened for" << printer;
+        pushActive = true;
+        pollTimer->stop();
+    }
+
+    streamBuffer.append(stream->readAll());
+    int lineEnd = streamBuffer.indexOf('\n');
+    while (lineEnd >= 0) {
+        QByteArray line = streamBuffer.left(lineEnd);
+        streamBuffer.remove(0, lineEnd + 1);
+        if (line.endsWith('\r'))
+            line.chop(1);
+        if (line.isEmpty()) {
+            dispatchEvent();
+        } else if (line.startsWith("data:")) {
+            int valueStart = line.size() > 5 && line[5] == ' ' ? 6 : 5;
+            if (!eventData.isEmpty())
+                eventData.append('\n');
+            eventData.append(line.constData() + valueStart, line.size() - valueStart);
+        }
+        //Comments, event names, ids and retry hints are not used
+        lineEnd = streamBuffer.indexOf('\n');
+    }
+}
+
+void LprPrinterStatusWatcherPrivate::streamFinished()
+{
+    QNetworkReply *finishedStream = stream;
+    stream = nullptr;
+    bool wasActive = pushActive.exchange(false);
+    int httpStatus = finishedStream->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QByteArray contentType = finishedStream->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+    finishedStream->deleteLater();
+    if (!running)
+        return;
+
+    bool unsupportedStatus = httpStatus == 404 || httpStatus == 405 || httpStatus == 406 || httpStatus == 415;
+    bool notStream = httpStatus == 200 && !contentType.startsWith("text/event-stream");
+    //Reconnecting with the same credentials will not help, while polling can still work if only stream is forbidden
+    bool notAuthorized = httpStatus == 401 || httpStatus == 403;
+    if (!wasActive && notAuthorized) {
+        qCWarning(proofNetworkLprPrinterLog) << "Lpr-Printer: status events are not authorized (" << httpStatus
+                                             << "), polling status of" << printer;
+        pushUnsupported = true;
+    } else if (!wasActive && (unsupportedStatus || notStream)) {
+        qCDebug(proofNetworkLprPrinterLog) << "Lpr-Printer: status events are not supported, polling status of"
+                                           << printer;
+        pushUnsupported = true;
+    } else {
+        qCDebug(proofNetworkLprPrinterLog) << "Lpr-Printer: status events stream closed for" << printer;
+        reconnectTimer->start();
+    }
+    //Status could change while stream was not connected
+    poll();
+    pollTimer->start();
+}
+
+void LprPrinterStatusWatcherPrivate::dispatchEvent()
+{
+    if (eventData.isEmpty())
+        return;
+    QJsonParseError jsonError;
+    QJsonDocument doc = QJsonDocument::fromJson(eventData, &jsonError);
+    eventData.clear();
+    if (jsonError.error != QJsonParseError::NoError || !doc.isObject()) {
+        qCWarning(proofNetworkLprPrinterLog) << "Lpr-Printer: wrong status event:" << jsonError.errorString();
+        return;
+    }
+    QJsonObject object = doc.object();
+    updateStatus(LprPrinterStatus{object.value(QStringLiteral("is_ready")).toBool(),
+                                  object.value(QStringLiteral("reason")).toString()});
+}
+
+void LprPrinterStatusWatcherPrivate::poll()
+{
+    Q_Q(LprPrinterStatusWatcher);
+    QPointer<LprPrinterStatusWatcher> watcher(q);
+    api->fetchStatus(printer)->onSuccess([watcher](const LprPrinterStatus &polledStatus) {
+        if (!watcher)
+            return;
+        auto d = watcher->d_func();
+        //Pushed status is always more recent than polled one
+        if (!d->pushActive)
+            d->updateStatus(polledStatus);
+    });
+}
+
+void LprPrinterStatusWatcherPrivate::updateStatus(const LprPrinterStatus &newStatus)
+{
+    Q_Q(LprPrinterStatusWatcher);
+    {
+        QMutexLocker lock(&statusMutex);
+        if (hasStatus && status.isReady == newStatus.isReady && status.reason == newStatus.reason)
+            return;
+        status = newStatus;
+        hasStatus = true;
+    }
+    emit q->statusChanged(newStatus);
+}
@@ -35,5 +35,7 @@ PROOF_LIBRARY_INITIALIZER(libraryInit)
     qRegisterMetaType<Proof::NetworkServices::LprPrinterStatus>("Proof::NetworkServices::LprPrinterStatus");
     qRegisterMetaType<Proof::NetworkServices::LprPrinterInfo>("Proof::NetworkServices::LprPrinterInfo");
     qRegisterMetaType<QVector<Proof::NetworkServices::LprPrinterInfo>>("QVector<Proof::NetworkServices::LprPrinterInfo>");
+    qRegisterMetaType<Proof::NetworkServices::LprPrinterLabelResult>("Proof::NetworkServices::LprPrinterLabelResult");
+    qRegisterMetaType<QVector<Proof::NetworkServices::LprPrinterLabelResult>>("QVector<Proof::NetworkServices::LprPrinterLabelResult>");
     // clang-format on
 }
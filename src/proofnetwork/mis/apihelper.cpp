@@ -24,6 +24,8 @@
  */
 #include "proofnetwork/mis/apihelper.h"
 
+#include <QVector>
+
 namespace Proof {
 namespace Mis {
 
@@ -32,141 +34,300 @@ namespace Mis {
  * Helper class for Mis API
  */
 
-static const QHash<QString, EntityStatus> ENTITY_STATUSES = {{"invalid", EntityStatus::InvalidEntity},
-                                                             {"not ready", EntityStatus::NotReadyEntity},
-                                                             {"valid", EntityStatus::ValidEntity},
-                                                             {"deleted", EntityStatus::DeletedEntity}};
-
-static const QHash<QString, WorkflowStatus> WORKFLOW_STATUSES = {{"needs", WorkflowStatus::NeedsStatus},
-                                                                 {"is ready for", WorkflowStatus::IsReadyForStatus},
-                                                                 {"in progress", WorkflowStatus::InProgressStatus},
-                                                                 {"suspended", WorkflowStatus::SuspendedStatus},
-                                                                 {"done", WorkflowStatus::DoneStatus},
-                                                                 {"halted", WorkflowStatus::HaltedStatus}};
-
-static const QHash<QString, WorkflowAction> WORKFLOW_ACTIONS =
-    {{"binding", WorkflowAction::BindingAction},
-     {"binning", WorkflowAction::BinningAction},
-     {"blister packing", WorkflowAction::BlisterPackingAction},
-     {"boxing", WorkflowAction::BoxingAction},
-     {"chip boarding", WorkflowAction::ChipBoardingAction},
-     {"clamping", WorkflowAction::ClampingAction},
-     {"color optimizing", WorkflowAction::ColorOptimizingAction},
-     {"component boxing", WorkflowAction::ComponentBoxingAction},
-     {"container packing", WorkflowAction::ContainerPackingAction},
-     {"cutting", WorkflowAction::CuttingAction},
-     {"die cutting", WorkflowAction::DieCuttingAction},
-     {"distribute", WorkflowAction::DistributeAction},
-     {"envelope adding", WorkflowAction::EnvelopeAddingAction},
-     {"folder making", WorkflowAction::FolderMakingAction},
-     {"folding", WorkflowAction::FoldingAction},
-     {"gluing", WorkflowAction::GluingAction},
-     {"inspection", WorkflowAction::InspectionAction},
-     {"laminating", WorkflowAction::LaminatingAction},
-     {"magnetize", WorkflowAction::MagnetizeAction},
-     {"mailing", WorkflowAction::MailingAction},
-     {"mounting", WorkflowAction::MountingAction},
-     {"outsource binding", WorkflowAction::OutsourceBindingAction},
-     {"outsource cutting", WorkflowAction::OutsourceCuttingAction},
-     {"pdf building", WorkflowAction::PdfBuildingAction},
-     {"pdf vt building", WorkflowAction::PdfVtBuildingAction},
-     {"plate making", WorkflowAction::PlateMakingAction},
-     {"pocket adding", WorkflowAction::PocketAddingAction},
-     {"printing", WorkflowAction::PrintingAction},
-     {"qc", WorkflowAction::QcAction},
-     {"rounding", WorkflowAction::RoundingAction},
-     {"scoring", WorkflowAction::ScoringAction},
-     {"screen imaging", WorkflowAction::ScreenImagingAction},
-     {"screen mounting", WorkflowAction::ScreenMountingAction},
-     {"screen preparation", WorkflowAction::ScreenPreparationAction},
-     {"screen washing", WorkflowAction::ScreenWashingAction},
-     {"ship boxing", WorkflowAction::ShipBoxingAction},
-     {"ship label", WorkflowAction::ShipLabelAction},
-     {"shipping", WorkflowAction::ShippingAction},
-     {"splitting", WorkflowAction::SplittingAction},
-     {"staging", WorkflowAction::StagingAction},
-     {"stripping", WorkflowAction::StrippingAction},
-     {"stuffing", WorkflowAction::StuffingAction},
-     {"truck loading", WorkflowAction::TruckLoadingAction},
-     {"uv coating", WorkflowAction::UvCoatingAction},
-     {"uv pdf building", WorkflowAction::UvPdfBuildingAction}};
-
-static const QHash<QString, TransitionEvent> TRANSITION_EVENTS = {{"start", TransitionEvent::StartEvent},
-                                                                  {"stop", TransitionEvent::StopEvent},
-                                                                  {"abort", TransitionEvent::AbortEvent},
-                                                                  {"suspend", TransitionEvent::SuspendEvent},
-                                                                  {"resume", TransitionEvent::ResumeEvent},
-                                                                  {"perform", TransitionEvent::PerformEvent},
-                                                                  {"revert", TransitionEvent::RevertEvent},
-                                                                  {"request", TransitionEvent::RequestEvent}};
-
-static const QHash<QString, PaperSide> PAPER_SIDES = {{"", PaperSide::NotSetSide},
-                                                      {"front", PaperSide::FrontSide},
-                                                      {"back", PaperSide::BackSide}};
+namespace {
+constexpr ushort lowerAscii(ushort c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<ushort>(c + ('a' - 'A')) : c;
+}
+
+constexpr ushort code(char c)
+{
+    return static_cast<uchar>(c);
+}
+
+inline ushort code(QChar c)
+{
+    return c.unicode();
+}
+
+constexpr int nameLength(const char *name)
+{
+    int length = 0;
+    while (name[length])
+        ++length;
+    return length;
+}
+
+//Case-insensitive FNV-1a
+template <typename Char>
+constexpr quint32 nameHash(const Char *data, int size, quint32 seed)
+{
+    quint32 hash = 2166136261u ^ seed;
+    for (int i = 0; i < size; ++i)
+        hash = (hash ^ lowerAscii(code(data[i]))) * 16777619u;
+    return hash ^ (hash >> 15);
+}
+
+//Perfect hash table for names of one enum. Seed is chosen at compile time so that no two names share a slot.
+template <int Slots>
+struct NamesIndex
+{
+    constexpr NamesIndex() : seed(0), slots{} {}
+    quint32 seed;
+    qint8 slots[Slots];
+};
+
+template <int Slots, int Count>
+constexpr NamesIndex<Slots> buildIndex(const char *const (&names)[Count])
+{
+    static_assert((Slots & (Slots - 1)) == 0, "Slots count should be power of two");
+    static_assert(Count < Slots && Count <= 127, "Too many names for index");
+    NamesIndex<Slots> index;
+    for (quint32 seed = 1; seed < 10000; ++seed) {
+        for (int i = 0; i < Slots; ++i)
+            index.slots[i] = -1;
+        bool collision = false;
+        for (int i = 0; i < Count && !collision; ++i) {
+            if (!names[i])
+                continue;
+            int slot = static_cast<int>(nameHash(names[i], nameLength(names[i]), seed) & (Slots - 1));
+            collision = index.slots[slot] >= 0;
+            index.slots[slot] = static_cast<qint8>(i);
+        }
+        if (!collision) {
+            index.seed = seed;
+            return index;
+        }
+    }
+    return index;
+}
+
+template <typename Enum, typename Char, int Slots, int Count>
+Enum enumFromString(const NamesIndex<Slots> &index, const char *const (&names)[Count], const Char *data, int size,
+                    Enum fallback, bool *ok)
+{
+    int found = index.slots[nameHash(data, size, index.seed) & (Slots - 1)];
+    const char *name = found >= 0 ? names[found] : nullptr;
+    for (int i = 0; name && i < size; ++i) {
+        if (!name[i] || lowerAscii(code(data[i])) != code(name[i]))
+            name = nullptr;
+    }
+    if (name && name[size])
+        name = nullptr;
+    if (ok != nullptr)
+        *ok = name != nullptr;
+    return name ? static_cast<Enum>(found) : fallback;
+}
+
+//Converted once, so each call only copies implicitly shared string
+template <int Count>
+QVector<QString> namesToStrings(const char *const (&names)[Count])
+{
+    QVector<QString> result;
+    result.reserve(Count);
+    for (const char *name : names)
+        result << (name ? QString::fromLatin1(name) : QString());
+    return result;
+}
+
+//Names are ordered by enum values, nullptr is used for values without string representation
+constexpr const char *ENTITY_STATUSES[] = {"not ready", "valid", "deleted", "invalid"};
+
+constexpr const char *WORKFLOW_STATUSES[] = {"needs", "is ready for", "in progress", "suspended", "done", "halted",
+                                             nullptr};
+
+constexpr const char *WORKFLOW_ACTIONS[] = {"binding",
+                                            "binning",
+                                            "blister packing",
+                                            "boxing",
+                                            "chip boarding",
+                                            "clamping",
+                                            "color optimizing",
+                                            "component boxing",
+                                            "container packing",
+                                            "cutting",
+                                            "die cutting",
+                                            "distribute",
+                                            "envelope adding",
+                                            "folder making",
+                                            "folding",
+                                            "gluing",
+                                            "inspection",
+                                            "laminating",
+                                            "magnetize",
+                                            "mailing",
+                                            "mounting",
+                                            "outsource binding",
+                                            "outsource cutting",
+                                            "pdf building",
+                                            "pdf vt building",
+                                            "plate making",
+                                            "pocket adding",
+                                            "printing",
+                                            "qc",
+                                            "rounding",
+                                            "scoring",
+                                            "screen imaging",
+                                            "screen mounting",
+                                            "screen preparation",
+                                            "screen washing",
+                                            "ship boxing",
+                                            "ship label",
+                                            "shipping",
+                                            "splitting",
+                                            "staging",
+                                            "stripping",
+                                            "stuffing",
+                                            "truck loading",
+                                            "uv coating",
+                                            "uv pdf building",
+                                            nullptr};
+
+constexpr const char *TRANSITION_EVENTS[] = {"start",  "stop",   "abort",   "suspend", "resume",
+                                             "perform", "revert", "request", nullptr};
+
+constexpr const char *PAPER_SIDES[] = {"", "front", "back"};
+
+static_assert(sizeof(ENTITY_STATUSES) / sizeof(*ENTITY_STATUSES) == static_cast<int>(EntityStatus::InvalidEntity) + 1,
+              "ENTITY_STATUSES doesn't match EntityStatus");
+static_assert(sizeof(WORKFLOW_STATUSES) / sizeof(*WORKFLOW_STATUSES)
+                  == static_cast<int>(WorkflowStatus::UnknownStatus) + 1,
+              "WORKFLOW_STATUSES doesn't match WorkflowStatus");
+static_assert(sizeof(WORKFLOW_ACTIONS) / sizeof(*WORKFLOW_ACTIONS)
+                  == static_cast<int>(WorkflowAction::UnknownAction) + 1,
+              "WORKFLOW_ACTIONS doesn't match WorkflowAction");
+static_assert(sizeof(TRANSITION_EVENTS) / sizeof(*TRANSITION_EVENTS)
+                  == static_cast<int>(TransitionEvent::UnknownEvent) + 1,
+              "TRANSITION_EVENTS doesn't match TransitionEvent");
+static_assert(sizeof(PAPER_SIDES) / sizeof(*PAPER_SIDES) == static_cast<int>(PaperSide::BackSide) + 1,
+              "PAPER_SIDES doesn't match PaperSide");
+
+constexpr auto ENTITY_STATUSES_INDEX = buildIndex<8>(ENTITY_STATUSES);
+constexpr auto WORKFLOW_STATUSES_INDEX = buildIndex<16>(WORKFLOW_STATUSES);
+constexpr auto WORKFLOW_ACTIONS_INDEX = buildIndex<256>(WORKFLOW_ACTIONS);
+constexpr auto TRANSITION_EVENTS_INDEX = buildIndex<16>(TRANSITION_EVENTS);
+constexpr auto PAPER_SIDES_INDEX = buildIndex<8>(PAPER_SIDES);
+
+static_assert(ENTITY_STATUSES_INDEX.seed, "No perfect hash found for ENTITY_STATUSES");
+static_assert(WORKFLOW_STATUSES_INDEX.seed, "No perfect hash found for WORKFLOW_STATUSES");
+static_assert(WORKFLOW_ACTIONS_INDEX.seed, "No perfect hash found for WORKFLOW_ACTIONS");
+static_assert(TRANSITION_EVENTS_INDEX.seed, "No perfect hash found for TRANSITION_EVENTS");
+static_assert(PAPER_SIDES_INDEX.seed, "No perfect hash found for PAPER_SIDES");
+} // namespace
 
 QString entityStatusToString(EntityStatus status)
 {
-    return ENTITY_STATUSES.key(status, QString());
+    static const QVector<QString> names = namesToStrings(ENTITY_STATUSES);
+    return names.value(static_cast<int>(status));
 }
 
 QString workflowStatusToString(WorkflowStatus status)
 {
-    return WORKFLOW_STATUSES.key(status, QString());
+    static const QVector<QString> names = namesToStrings(WORKFLOW_STATUSES);
+    return names.value(static_cast<int>(status));
 }
 
 QString workflowActionToString(WorkflowAction action)
 {
-    return WORKFLOW_ACTIONS.key(action, QString());
+    static const QVector<QString> names = namesToStrings(WORKFLOW_ACTIONS);
+    return names.value(static_cast<int>(action));
 }
 
 QString transitionEventToString(TransitionEvent event)
 {
-    return TRANSITION_EVENTS.key(event, QString());
+    static const QVector<QString> names = namesToStrings(TRANSITION_EVENTS);
+    return names.value(static_cast<int>(event));
 }
 
 QString paperSideToString(PaperSide side)
 {
-    return PAPER_SIDES.key(side, QString());
+    static const QVector<QString> names = namesToStrings(PAPER_SIDES);
+    return names.value(static_cast<int>(side));
 }
 
 EntityStatus entityStatusFromString(QString statusString, bool *ok)
 {
-    statusString = statusString.toLower();
-    if (ok != nullptr)
-        *ok = ENTITY_STATUSES.contains(statusString);
-    return ENTITY_STATUSES.value(statusString, EntityStatus::InvalidEntity);
+    return entityStatusFromString(QStringRef(&statusString), ok);
+}
+
+EntityStatus entityStatusFromString(const QStringRef &statusString, bool *ok)
+{
+    return enumFromString(ENTITY_STATUSES_INDEX, ENTITY_STATUSES, statusString.unicode(), statusString.size(),
+                          EntityStatus::InvalidEntity, ok);
+}
+
+EntityStatus entityStatusFromString(QLatin1String statusString, bool *ok)
+{
+    return enumFromString(ENTITY_STATUSES_INDEX, ENTITY_STATUSES, statusString.data(), statusString.size(),
+                          EntityStatus::InvalidEntity, ok);
 }
 
 WorkflowStatus workflowStatusFromString(QString statusString, bool *ok)
 {
-    statusString = statusString.toLower();
-    if (ok != nullptr)
-        *ok = WORKFLOW_STATUSES.contains(statusString);
-    return WORKFLOW_STATUSES.value(statusString, WorkflowStatus::UnknownStatus);
+    return workflowStatusFromString(QStringRef(&statusString), ok);
+}
+
+WorkflowStatus workflowStatusFromString(const QStringRef &statusString, bool *ok)
+{
+    return enumFromString(WORKFLOW_STATUSES_INDEX, WORKFLOW_STATUSES, statusString.unicode(), statusString.size(),
+                          WorkflowStatus::UnknownStatus, ok);
+}
+
+WorkflowStatus workflowStatusFromString(QLatin1String statusString, bool *ok)
+{
+    return enumFromString(WORKFLOW_STATUSES_INDEX, WORKFLOW_STATUSES, statusString.data(), statusString.size(),
+                          WorkflowStatus::UnknownStatus, ok);
 }
 
 WorkflowAction workflowActionFromString(QString actionString, bool *ok)
 {
-    actionString = actionString.toLower();
-    if (ok != nullptr)
-        *ok = WORKFLOW_ACTIONS.contains(actionString);
-    return WORKFLOW_ACTIONS.value(actionString, WorkflowAction::UnknownAction);
+    return workflowActionFromString(QStringRef(&actionString), ok);
+}
+
+WorkflowAction workflowActionFromString(const QStringRef &actionString, bool *ok)
+{
+    return enumFromString(WORKFLOW_ACTIONS_INDEX, WORKFLOW_ACTIONS, actionString.unicode(), actionString.size(),
+                          WorkflowAction::UnknownAction, ok);
+}
+
+WorkflowAction workflowActionFromString(QLatin1String actionString, bool *ok)
+{
+    return enumFromString(WORKFLOW_ACTIONS_INDEX, WORKFLOW_ACTIONS, actionString.data(), actionString.size(),
+                          WorkflowAction::UnknownAction, ok);
 }
 
 TransitionEvent transitionEventFromString(QString eventString, bool *ok)
 {
-    eventString = eventString.toLower();
-    if (ok != nullptr)
-        *ok = TRANSITION_EVENTS.contains(eventString);
-    return TRANSITION_EVENTS.value(eventString, TransitionEvent::UnknownEvent);
+    return transitionEventFromString(QStringRef(&eventString), ok);
+}
+
+TransitionEvent transitionEventFromString(const QStringRef &eventString, bool *ok)
+{
+    return enumFromString(TRANSITION_EVENTS_INDEX, TRANSITION_EVENTS, eventString.unicode(), eventString.size(),
+                          TransitionEvent::UnknownEvent, ok);
+}
+
+TransitionEvent transitionEventFromString(QLatin1String eventString, bool *ok)
+{
+    return enumFromString(TRANSITION_EVENTS_INDEX, TRANSITION_EVENTS, eventString.data(), eventString.size(),
+                          TransitionEvent::UnknownEvent, ok);
 }
 
 PaperSide paperSideFromString(QString sideString, bool *ok)
 {
-    sideString = sideString.toLower();
-    if (ok != nullptr)
-        *ok = PAPER_SIDES.contains(sideString);
-    return PAPER_SIDES.value(sideString, PaperSide::NotSetSide);
+    return paperSideFromString(QStringRef(&sideString), ok);
+}
+
+PaperSide paperSideFromString(const QStringRef &sideString, bool *ok)
+{
+    return enumFromString(PAPER_SIDES_INDEX, PAPER_SIDES, sideString.unicode(), sideString.size(),
+                          PaperSide::NotSetSide, ok);
+}
+
+PaperSide paperSideFromString(QLatin1String sideString, bool *ok)
+{
+    return enumFromString(PAPER_SIDES_INDEX, PAPER_SIDES, sideString.data(), sideString.size(), PaperSide::NotSetSide,
+                          ok);
 }
 
 WorkflowStatus workflowStatusAfterTransitionEvent(Proof::Mis::TransitionEvent event)
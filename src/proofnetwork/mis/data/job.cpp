@@ -24,31 +24,13 @@
  */
 #include "proofnetwork/mis/data/job.h"
 
-#include "proofnetwork/networkdataentity_p.h"
+#include "proofnetwork/mis/data/job_p.h"
 
 #include <QJsonArray>
 
 namespace Proof {
 namespace Mis {
 
-class JobPrivate : NetworkDataEntityPrivate
-{
-    Q_DECLARE_PUBLIC(Job)
-
-    void setId(const QString &id);
-
-    QString id;
-    EntityStatus status = EntityStatus::ValidEntity;
-    QString name;
-    qlonglong quantity = 0;
-    double width = 0.0;
-    double height = 0.0;
-    QString source;
-    int pageCount = 0;
-    bool hasPreview = false;
-    QVector<WorkflowElement> workflow;
-};
-
 ObjectsCache<JobCacheKey, Job> &jobsCache()
 {
     return WeakObjectsCache<JobCacheKey, Job>::instance();
@@ -197,10 +179,7 @@ void Job::setHasPreview(bool hasPreview)
 void Job::setWorkflow(const QVector<WorkflowElement> &arg)
 {
     Q_D(Job);
-    bool emitNeeded = arg.count() != d->workflow.count();
-    for (int i = 0; i < arg.count() && !emitNeeded; ++i)
-        emitNeeded = arg[i] != d->workflow[i];
-    if (emitNeeded) {
+    if (d->workflow != arg) {
         d->workflow = arg;
         emit workflowChanged();
     }
@@ -298,29 +277,27 @@ JobSP Job::fromJson(const QJsonObject &json)
     if (!json.contains(QLatin1String("id")))
         return JobSP();
 
-    QString id = json.value(QStringLiteral("id")).toString();
-    JobSP job = create(id);
+    JobSP job = create(json.value(QStringLiteral("id")).toString(), json.value(QStringLiteral("source")).toString());
     job->setFetched(true);
-    job->setStatus(entityStatusFromString(json.value(QStringLiteral("status")).toString(QStringLiteral("valid"))));
-    job->setName(json.value(QStringLiteral("name")).toString());
-    job->setQuantity(json.value(QStringLiteral("quantity")).toInt());
-    job->setWidth(json.value(QStringLiteral("width")).toDouble());
-    job->setHeight(json.value(QStringLiteral("height")).toDouble());
-    job->setSource(json.value(QStringLiteral("source")).toString());
-    job->setPageCount(json.value(QStringLiteral("page_count")).toInt());
-    job->setHasPreview(json.value(QStringLiteral("has_preview")).toBool());
-    job->setWorkflow(algorithms::map(json.value(QStringLiteral("workflow")).toArray(),
-                                     [](const auto &value) { return WorkflowElement(value.toString()); },
-                                     QVector<WorkflowElement>()));
+    //Nobody can be connected to job that is not built yet, so fields are filled without change signals
+    JobPrivate *d = job->d_func();
+    d->status = entityStatusFromString(json.value(QStringLiteral("status")).toString(QStringLiteral("valid")));
+    d->name = json.value(QStringLiteral("name")).toString();
+    d->quantity = json.value(QStringLiteral("quantity")).toInt();
+    d->width = json.value(QStringLiteral("width")).toDouble();
+    d->height = json.value(QStringLiteral("height")).toDouble();
+    d->pageCount = json.value(QStringLiteral("page_count")).toInt();
+    d->hasPreview = json.value(QStringLiteral("has_preview")).toBool();
+    d->workflow = WorkflowElement::workflowFromJson(json.value(QStringLiteral("workflow")).toArray());
     return job;
 }
 
 Job::Job(const QString &id, const QString &source) : NetworkDataEntity(*new JobPrivate)
 {
     Q_D(Job);
-    d->setId(id);
-    setSource(source);
-    setName(id);
+    d->id = id;
+    d->source = source;
+    d->name = id;
 }
 
 void Job::updateSelf(const Proof::NetworkDataEntitySP &other)
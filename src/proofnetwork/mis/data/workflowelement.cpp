@@ -24,135 +24,160 @@
  */
 #include "proofnetwork/mis/data/workflowelement.h"
 
-#include <QRegExp>
+#include <QJsonDocument>
 
-namespace Proof {
-namespace Mis {
-
-class WorkflowElementPrivate
-{
-    Q_DECLARE_PUBLIC(WorkflowElement)
-    WorkflowElement *q_ptr;
-
-    WorkflowAction action = WorkflowAction::UnknownAction;
-    WorkflowStatus status = WorkflowStatus::UnknownStatus;
-    PaperSide paperSide = PaperSide::NotSetSide;
-};
-} // namespace Mis
-} // namespace Proof
+#include <algorithm>
+#include <type_traits>
 
 using namespace Proof;
 using namespace Proof::Mis;
 
-WorkflowElement::WorkflowElement(const QString &string) : d_ptr(new WorkflowElementPrivate)
-{
-    d_ptr->q_ptr = this;
-
-    if (!string.isEmpty()) {
-        QRegExp re("([^:]*)\\:([^:]*)(?:\\:([^:]*))?");
-        if (re.indexIn(string) != -1) {
-            d_ptr->status = workflowStatusFromString(re.cap(1));
-            d_ptr->action = workflowActionFromString(re.cap(2));
-            if (re.captureCount() > 2)
-                d_ptr->paperSide = paperSideFromString(re.cap(3));
-        }
-    }
-}
-
-WorkflowElement::WorkflowElement(WorkflowAction action, WorkflowStatus status, PaperSide paperSide)
-    : d_ptr(new WorkflowElementPrivate)
-{
-    d_ptr->q_ptr = this;
-    d_ptr->action = action;
-    d_ptr->status = status;
-    d_ptr->paperSide = paperSide;
-}
+static_assert(std::is_trivially_copyable<WorkflowElement>::value, "WorkflowElement should stay trivially copyable");
+static_assert(sizeof(WorkflowElement) == 3, "WorkflowElement should stay packed");
+static_assert(static_cast<int>(WorkflowAction::UnknownAction) <= 0xFF, "WorkflowAction doesn't fit into one byte");
 
-WorkflowElement::WorkflowElement(const WorkflowElement &other) : d_ptr(new WorkflowElementPrivate)
+namespace {
+inline bool isColon(char c)
 {
-    d_ptr->q_ptr = this;
-
-    d_ptr->action = other.action();
-    d_ptr->paperSide = other.paperSide();
-    d_ptr->status = other.status();
+    return c == ':';
 }
 
-WorkflowElement::WorkflowElement(WorkflowElement &&other) : d_ptr(other.d_ptr.take())
+inline bool isColon(QChar c)
 {
-    d_ptr->q_ptr = this;
+    return c.unicode() == ':';
 }
 
-WorkflowElement::~WorkflowElement()
-{}
-
-WorkflowAction WorkflowElement::action() const
+//Splits "status:action[:paper side]", token(from, size) makes string view of data for apihelper lookup
+template <typename Char, typename Token>
+WorkflowElement parseElement(const Char *data, int size, const Token &token)
 {
-    return d_ptr->action;
-}
+    const Char *end = data + size;
+    const Char *statusEnd = std::find_if(data, end, [](Char c) { return isColon(c); });
+    if (statusEnd == end)
+        return WorkflowElement();
+    const Char *actionStart = statusEnd + 1;
+    const Char *actionEnd = std::find_if(actionStart, end, [](Char c) { return isColon(c); });
+    const Char *sideStart = actionEnd == end ? end : actionEnd + 1;
+    const Char *sideEnd = std::find_if(sideStart, end, [](Char c) { return isColon(c); });
 
-void WorkflowElement::setAction(WorkflowAction arg)
-{
-    d_ptr->action = arg;
+    auto view = [data, &token](const Char *from, const Char *to) {
+        return token(static_cast<int>(from - data), static_cast<int>(to - from));
+    };
+    return WorkflowElement(workflowActionFromString(view(actionStart, actionEnd)),
+                           workflowStatusFromString(view(data, statusEnd)),
+                           paperSideFromString(view(sideStart, sideEnd)));
 }
 
-WorkflowStatus WorkflowElement::status() const
+WorkflowElement parseString(const QString &string)
 {
-    return d_ptr->status;
+    return parseElement(string.constData(), string.size(),
+                        [&string](int from, int length) { return QStringRef(&string, from, length); });
 }
 
-void WorkflowElement::setStatus(WorkflowStatus arg)
+//Names are ASCII only, so UTF-8 token can be looked up as Latin-1, non-ASCII bytes just never match
+WorkflowElement parseUtf8(const char *data, int size)
 {
-    d_ptr->status = arg;
+    return parseElement(data, size, [data](int from, int length) { return QLatin1String(data + from, length); });
 }
 
-PaperSide WorkflowElement::paperSide() const
+inline const char *skipWhitespaces(const char *it, const char *end)
 {
-    return d_ptr->paperSide;
+    while (it != end && (*it == ' ' || *it == '\n' || *it == '\r' || *it == '\t'))
+        ++it;
+    return it;
 }
+} // namespace
 
-void WorkflowElement::setPaperSide(PaperSide arg)
+WorkflowElement::WorkflowElement(const QString &string)
 {
-    d_ptr->paperSide = arg;
+    if (!string.isEmpty())
+        *this = parseString(string);
 }
 
 QString WorkflowElement::toString() const
 {
-    return QStringLiteral("%1:%2%3").arg(workflowStatusToString(d_ptr->status), workflowActionToString(d_ptr->action),
-                                         d_ptr->paperSide == PaperSide::NotSetSide
+    return QStringLiteral("%1:%2%3").arg(workflowStatusToString(status()), workflowActionToString(action()),
+                                         paperSide() == PaperSide::NotSetSide
                                              ? QString()
-                                             : QStringLiteral(":%1").arg(paperSideToString(d_ptr->paperSide)));
-}
-
-WorkflowElement &WorkflowElement::operator=(const WorkflowElement &other)
-{
-    d_ptr->action = other.action();
-    d_ptr->paperSide = other.paperSide();
-    d_ptr->status = other.status();
-    return *this;
-}
-
-WorkflowElement &WorkflowElement::operator=(WorkflowElement &&other)
-{
-    d_ptr.reset(other.d_ptr.take());
-    return *this;
-}
-
-bool WorkflowElement::operator==(const WorkflowElement &other) const
-{
-    return (d_ptr->status == other.d_ptr->status && d_ptr->action == other.d_ptr->action
-            && d_ptr->paperSide == other.d_ptr->paperSide);
-}
-
-bool WorkflowElement::operator!=(const WorkflowElement &other) const
-{
-    return !(*this == other);
-}
-
-void WorkflowElement::swap(WorkflowElement &other)
-{
-    WorkflowElementPrivate *otherPrivate = other.d_ptr.take();
-    other.d_ptr.reset(d_ptr.take());
-    d_ptr.reset(otherPrivate);
-    d_ptr->q_ptr = this;
-    other.d_ptr->q_ptr = &other;
+                                             : QStringLiteral(":%1").arg(paperSideToString(paperSide())));
+}
+
+WorkflowElement WorkflowElement::fromString(const QStringRef &string)
+{
+    const QString *source = string.string();
+    int position = string.position();
+    return parseElement(string.constData(), string.size(), [source, position](int from, int length) {
+        return QStringRef(source, position + from, length);
+    });
+}
+
+WorkflowElement WorkflowElement::fromUtf8(const char *data, int size)
+{
+    return parseUtf8(data, size);
+}
+
+QVector<WorkflowElement> WorkflowElement::workflowFromJson(const QJsonArray &workflow)
+{
+    QVector<WorkflowElement> result;
+    result.reserve(workflow.count());
+    for (const auto &value : workflow)
+        result << parseString(value.toString());
+    return result;
+}
+
+QVector<WorkflowElement> WorkflowElement::workflowFromJson(const QByteArray &workflowJson, bool *ok)
+{
+    QVector<WorkflowElement> result;
+    result.reserve(workflowJson.count(',') + 1);
+    const char *end = workflowJson.constData() + workflowJson.size();
+    const char *it = skipWhitespaces(workflowJson.constData(), end);
+    bool valid = it != end && *it == '[';
+    if (valid)
+        it = skipWhitespaces(it + 1, end);
+    if (valid && it != end && *it == ']') {
+        it = skipWhitespaces(it + 1, end);
+    } else {
+        while (valid) {
+            if (it == end || *it != '"') {
+                valid = false;
+                break;
+            }
+            const char *stringStart = ++it;
+            bool escaped = false;
+            while (it != end && *it != '"') {
+                if (*it == '\\') {
+                    escaped = true;
+                    if (++it == end)
+                        break;
+                }
+                ++it;
+            }
+            if (it == end) {
+                valid = false;
+                break;
+            }
+            if (escaped) {
+                //Escapes are never used by MIS for workflow, so rare case is left to QJsonDocument
+                QByteArray literal = "[" + QByteArray(stringStart - 1, static_cast<int>(it - stringStart) + 2) + "]";
+                QJsonDocument doc = QJsonDocument::fromJson(literal);
+                valid = doc.isArray();
+                result << parseString(doc.array().at(0).toString());
+            } else {
+                result << parseUtf8(stringStart, static_cast<int>(it - stringStart));
+            }
+            it = skipWhitespaces(it + 1, end);
+            if (it != end && *it == ',') {
+                it = skipWhitespaces(it + 1, end);
+            } else if (it != end && *it == ']') {
+                it = skipWhitespaces(it + 1, end);
+                break;
+            } else {
+                valid = false;
+            }
+        }
+    }
+    valid = valid && it == end;
+    if (ok != nullptr)
+        *ok = valid;
+    return valid ? result : QVector<WorkflowElement>();
 }
@@ -0,0 +1,485 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "proofnetwork/mis/jobsbinaryarchive.h"
+
+#include "proofnetwork/mis/data/job_p.h"
+
+#include <QBitArray>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+//Layout (little-endian):
+//  "PJOB", version byte
+//  varint strings count, then for each string: varint UTF-8 size, UTF-8 data
+//  varint jobs count, then for each job: varint record size, record
+//Record:
+//  varint indices of id, source and name strings, status byte, flags byte,
+//  zigzag varints of quantity, width, height (or raw doubles if flagged as not integral) and page count,
+//  varint workflow size, then action, status and paper side bytes for each element.
+//Next versions can append fields to records, readers skip unknown tail of record.
+static const char MAGIC[] = {'P', 'J', 'O', 'B'};
+static const int HEADER_SIZE = sizeof(MAGIC) + 1;
+static const quint64 WORKFLOW_ELEMENT_SIZE = 3;
+//Integral doubles above it can't be stored in varint without losing precision
+static const double MAX_COMPACT_DOUBLE = 9007199254740992.0;
+
+enum RecordFlag : quint8
+{
+    HasPreviewFlag = 0x01,
+    RawWidthFlag = 0x02,
+    RawHeightFlag = 0x04
+};
+
+namespace {
+class ByteReader
+{
+public:
+    ByteReader(const char *data, qint64 size)
+        : pos(reinterpret_cast<const uchar *>(data)), end(reinterpret_cast<const uchar *>(data) + size)
+    {}
+
+    bool isValid() const { return valid; }
+    const uchar *position() const { return pos; }
+
+    quint8 byte()
+    {
+        if (pos == end) {
+            valid = false;
+            return 0;
+        }
+        return *pos++;
+    }
+
+    quint64 varint()
+    {
+        quint64 result = 0;
+        for (int shift = 0; shift < 64 && pos != end; shift += 7) {
+            quint8 current = *pos++;
+            result |= static_cast<quint64>(current & 0x7F) << shift;
+            if (!(current & 0x80))
+                return result;
+        }
+        valid = false;
+        return 0;
+    }
+
+    qint64 zigZag()
+    {
+        quint64 value = varint();
+        return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+    }
+
+    double rawDouble()
+    {
+        const uchar *data = skip(sizeof(double));
+        if (!data)
+            return 0.0;
+        quint64 bits = qFromLittleEndian<quint64>(data);
+        double result;
+        memcpy(&result, &bits, sizeof(double));
+        return result;
+    }
+
+    const uchar *skip(quint64 size)
+    {
+        if (static_cast<quint64>(end - pos) < size) {
+            valid = false;
+            return nullptr;
+        }
+        const uchar *result = pos;
+        pos += size;
+        return result;
+    }
+
+    quint64 remaining() const { return static_cast<quint64>(end - pos); }
+
+private:
+    const uchar *pos;
+    const uchar *end;
+    bool valid = true;
+};
+} // namespace
+
+static void writeVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+static void writeZigZag(QByteArray &out, qint64 value)
+{
+    writeVarint(out, (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63));
+}
+
+static bool isCompactDouble(double value)
+{
+    //NaN fails first check, infinities fail second one, negative zero would lose its sign
+    return value == std::trunc(value) && std::abs(value) < MAX_COMPACT_DOUBLE && !(value == 0.0 && std::signbit(value));
+}
+
+static void writeDouble(QByteArray &out, double value)
+{
+    if (isCompactDouble(value)) {
+        writeZigZag(out, static_cast<qint64>(value));
+        return;
+    }
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(double));
+    uchar raw[sizeof(double)];
+    qToLittleEndian<quint64>(bits, raw);
+    out.append(reinterpret_cast<const char *>(raw), sizeof(double));
+}
+
+//Value unknown to this build, because of corruption or newer format, is replaced with fallback one
+template <typename Enum>
+static Enum enumFromByte(quint8 value, Enum last, Enum fallback)
+{
+    return value <= static_cast<quint8>(last) ? static_cast<Enum>(value) : fallback;
+}
+
+namespace Proof {
+namespace Mis {
+class JobsBinaryArchivePrivate
+{
+    Q_DECLARE_PUBLIC(JobsBinaryArchive)
+    JobsBinaryArchive *q_ptr = nullptr;
+
+    bool buildIndex();
+    bool fail(const QString &error);
+    QString string(quint64 index, bool *ok) const;
+
+    QFile file;
+    uchar *mapped = nullptr;
+    //Either owned data or raw data of mapped file
+    QByteArray data;
+    bool loaded = false;
+    quint8 version = 0;
+    QString error;
+
+    QVector<int> stringOffsets;
+    QVector<int> stringSizes;
+    QVector<int> jobOffsets;
+    QVector<int> jobSizes;
+    mutable QVector<QString> strings;
+    mutable QBitArray decodedStrings;
+};
+} // namespace Mis
+} // namespace Proof
+
+using namespace Proof::Mis;
+
+JobsBinaryArchive::JobsBinaryArchive() : d_ptr(new JobsBinaryArchivePrivate)
+{
+    d_ptr->q_ptr = this;
+}
+
+JobsBinaryArchive::~JobsBinaryArchive()
+{
+    close();
+}
+
+QByteArray JobsBinaryArchive::serialize(const QVector<JobSP> &jobs)
+{
+    QHash<QString, quint64> stringIndices;
+    QByteArray stringsTable;
+    auto intern = [&stringIndices, &stringsTable](const QString &string) -> quint64 {
+        auto it = stringIndices.constFind(string);
+        if (it != stringIndices.constEnd())
+            return it.value();
+        QByteArray utf8 = string.toUtf8();
+        writeVarint(stringsTable, static_cast<quint64>(utf8.size()));
+        stringsTable.append(utf8);
+        return stringIndices.insert(string, static_cast<quint64>(stringIndices.count())).value();
+    };
+
+    QByteArray records;
+    QByteArray record;
+    //Reserved capacity is kept by resize(0), so record buffer is allocated only once
+    record.reserve(256);
+    quint64 jobsCount = 0;
+    for (const JobSP &job : jobs) {
+        if (!job)
+            continue;
+        const JobPrivate *jobD = job->d_func();
+        record.resize(0);
+        writeVarint(record, intern(jobD->id));
+        writeVarint(record, intern(jobD->source));
+        writeVarint(record, intern(jobD->name));
+        record.append(static_cast<char>(jobD->status));
+        quint8 flags = jobD->hasPreview ? HasPreviewFlag : 0;
+        if (!isCompactDouble(jobD->width))
+            flags |= RawWidthFlag;
+        if (!isCompactDouble(jobD->height))
+            flags |= RawHeightFlag;
+        record.append(static_cast<char>(flags));
+        writeZigZag(record, jobD->quantity);
+        writeDouble(record, jobD->width);
+        writeDouble(record, jobD->height);
+        writeZigZag(record, jobD->pageCount);
+        writeVarint(record, static_cast<quint64>(jobD->workflow.count()));
+        for (const WorkflowElement &element : jobD->workflow) {
+            record.append(static_cast<char>(element.action()));
+            record.append(static_cast<char>(element.status()));
+            record.append(static_cast<char>(element.paperSide()));
+        }
+        writeVarint(records, static_cast<quint64>(record.size()));
+        records.append(record);
+        ++jobsCount;
+    }
+
+    QByteArray result;
+    result.reserve(HEADER_SIZE + 20 + stringsTable.size() + records.size());
+    result.append(MAGIC, sizeof(MAGIC));
+    result.append(static_cast<char>(FORMAT_VERSION));
+    writeVarint(result, static_cast<quint64>(stringIndices.count()));
+    result.append(stringsTable);
+    writeVarint(result, jobsCount);
+    result.append(records);
+    return result;
+}
+
+bool JobsBinaryArchive::save(const QVector<JobSP> &jobs, const QString &fileName)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(proofNetworkMisDataLog) << "JobsBinaryArchive: can't open" << fileName << file.errorString();
+        return false;
+    }
+    QByteArray data = serialize(jobs);
+    if (file.write(data) != data.size() || !file.commit()) {
+        qCWarning(proofNetworkMisDataLog) << "JobsBinaryArchive: can't write" << fileName << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    return true;
+}
+
+bool JobsBinaryArchive::load(const QByteArray &data)
+{
+    Q_D(JobsBinaryArchive);
+    close();
+    d->data = data;
+    return d->buildIndex();
+}
+
+bool JobsBinaryArchive::load(const QString &fileName)
+{
+    Q_D(JobsBinaryArchive);
+    close();
+    d->file.setFileName(fileName);
+    if (!d->file.open(QIODevice::ReadOnly))
+        return d->fail(QStringLiteral("Can't open %1: %2").arg(fileName, d->file.errorString()));
+    qint64 size = d->file.size();
+    if (size > std::numeric_limits<int>::max())
+        return d->fail(QStringLiteral("File %1 is too big").arg(fileName));
+    d->mapped = size ? d->file.map(0, size) : nullptr;
+    if (d->mapped)
+        d->data = QByteArray::fromRawData(reinterpret_cast<const char *>(d->mapped), static_cast<int>(size));
+    else
+        d->data = d->file.readAll();
+    return d->buildIndex();
+}
+
+void JobsBinaryArchive::close()
+{
+    Q_D(JobsBinaryArchive);
+    //Raw data must be released before file is unmapped
+    d->data.clear();
+    if (d->mapped)
+        d->file.unmap(d->mapped);
+    d->mapped = nullptr;
+    d->file.close();
+    d->loaded = false;
+    d->version = 0;
+    d->error.clear();
+    d->stringOffsets.clear();
+    d->stringSizes.clear();
+    d->jobOffsets.clear();
+    d->jobSizes.clear();
+    d->strings.clear();
+    d->decodedStrings.clear();
+}
+
+bool JobsBinaryArchive::isLoaded() const
+{
+    Q_D_CONST(JobsBinaryArchive);
+    return d->loaded;
+}
+
+QString JobsBinaryArchive::errorString() const
+{
+    Q_D_CONST(JobsBinaryArchive);
+    return d->error;
+}
+
+quint8 JobsBinaryArchive::version() const
+{
+    Q_D_CONST(JobsBinaryArchive);
+    return d->version;
+}
+
+int JobsBinaryArchive::count() const
+{
+    Q_D_CONST(JobsBinaryArchive);
+    return d->jobOffsets.count();
+}
+
+JobSP JobsBinaryArchive::job(int index) const
+{
+    Q_D_CONST(JobsBinaryArchive);
+    if (index < 0 || index >= d->jobOffsets.count())
+        return JobSP();
+
+    ByteReader reader(d->data.constData() + d->jobOffsets[index], d->jobSizes[index]);
+    bool stringsOk = true;
+    QString id = d->string(reader.varint(), &stringsOk);
+    QString source = d->string(reader.varint(), &stringsOk);
+    QString name = d->string(reader.varint(), &stringsOk);
+    auto status = enumFromByte(reader.byte(), EntityStatus::InvalidEntity, EntityStatus::InvalidEntity);
+    quint8 flags = reader.byte();
+    qint64 quantity = reader.zigZag();
+    double width = flags & RawWidthFlag ? reader.rawDouble() : static_cast<double>(reader.zigZag());
+    double height = flags & RawHeightFlag ? reader.rawDouble() : static_cast<double>(reader.zigZag());
+    qint64 pageCount = reader.zigZag();
+    quint64 workflowSize = reader.varint();
+    const uchar *workflow = workflowSize <= reader.remaining() / WORKFLOW_ELEMENT_SIZE
+                                ? reader.skip(workflowSize * WORKFLOW_ELEMENT_SIZE)
+                                : nullptr;
+    if (!reader.isValid() || !stringsOk || (workflowSize && !workflow)) {
+        qCWarning(proofNetworkMisDataLog) << "JobsBinaryArchive: job record" << index << "is corrupted";
+        return JobSP();
+    }
+
+    JobSP job = Job::create(id, source);
+    job->setFetched(true);
+    //Job is not shared yet, so fields are filled without change signals
+    JobPrivate *jobD = job->d_func();
+    jobD->name = name;
+    jobD->status = status;
+    jobD->hasPreview = flags & HasPreviewFlag;
+    jobD->quantity = quantity;
+    jobD->width = width;
+    jobD->height = height;
+    jobD->pageCount = static_cast<int>(pageCount);
+    jobD->workflow.reserve(static_cast<int>(workflowSize));
+    for (quint64 i = 0; i < workflowSize; ++i, workflow += WORKFLOW_ELEMENT_SIZE) {
+        jobD->workflow << WorkflowElement(enumFromByte(workflow[0], WorkflowAction::UnknownAction,
+                                                       WorkflowAction::UnknownAction),
+                                          enumFromByte(workflow[1], WorkflowStatus::UnknownStatus,
+                                                       WorkflowStatus::UnknownStatus),
+                                          enumFromByte(workflow[2], PaperSide::BackSide, PaperSide::NotSetSide));
+    }
+    return job;
+}
+
+QVector<JobSP> JobsBinaryArchive::jobs() const
+{
+    QVector<JobSP> result;
+    result.reserve(count());
+    for (int i = 0; i < count(); ++i) {
+        JobSP decoded = job(i);
+        if (decoded)
+            result << decoded;
+    }
+    return result;
+}
+
+bool JobsBinaryArchivePrivate::buildIndex()
+{
+    ByteReader reader(data.constData(), data.size());
+    const uchar *begin = reader.position();
+    const uchar *magic = reader.skip(sizeof(MAGIC));
+    if (!magic || memcmp(magic, MAGIC, sizeof(MAGIC)))
+        return fail(QStringLiteral("Not a jobs archive"));
+    version = reader.byte();
+    if (!version || version > JobsBinaryArchive::FORMAT_VERSION)
+        return fail(QStringLiteral("Unsupported jobs archive version %1").arg(version));
+
+    //Each string and record takes at least one byte for its size, it limits counts for corrupted data
+    quint64 stringsCount = reader.varint();
+    if (stringsCount > reader.remaining())
+        return fail(QStringLiteral("Jobs archive is corrupted"));
+    stringOffsets.reserve(static_cast<int>(stringsCount));
+    stringSizes.reserve(static_cast<int>(stringsCount));
+    for (quint64 i = 0; i < stringsCount && reader.isValid(); ++i) {
+        quint64 size = reader.varint();
+        const uchar *string = reader.skip(size);
+        if (!string)
+            break;
+        stringOffsets << static_cast<int>(string - begin);
+        stringSizes << static_cast<int>(size);
+    }
+    strings.resize(static_cast<int>(stringsCount));
+    decodedStrings.resize(static_cast<int>(stringsCount));
+
+    quint64 jobsCount = reader.varint();
+    if (jobsCount > reader.remaining())
+        return fail(QStringLiteral("Jobs archive is corrupted"));
+    jobOffsets.reserve(static_cast<int>(jobsCount));
+    jobSizes.reserve(static_cast<int>(jobsCount));
+    for (quint64 i = 0; i < jobsCount && reader.isValid(); ++i) {
+        quint64 size = reader.varint();
+        const uchar *record = reader.skip(size);
+        if (!record)
+            break;
+        jobOffsets << static_cast<int>(record - begin);
+        jobSizes << static_cast<int>(size);
+    }
+    if (!reader.isValid())
+        return fail(QStringLiteral("Jobs archive is truncated"));
+    loaded = true;
+    return true;
+}
+
+bool JobsBinaryArchivePrivate::fail(const QString &error)
+{
+    qCWarning(proofNetworkMisDataLog) << "JobsBinaryArchive:" << error;
+    q_func()->close();
+    this->error = error;
+    return false;
+}
+
+QString JobsBinaryArchivePrivate::string(quint64 index, bool *ok) const
+{
+    if (index >= static_cast<quint64>(strings.count())) {
+        *ok = false;
+        return QString();
+    }
+    int i = static_cast<int>(index);
+    if (!decodedStrings.testBit(i)) {
+        strings[i] = QString::fromUtf8(data.constData() + stringOffsets[i], stringSizes[i]);
+        decodedStrings.setBit(i);
+    }
+    return strings[i];
+}
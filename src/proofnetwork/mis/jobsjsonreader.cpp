@@ -0,0 +1,330 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "proofnetwork/mis/jobsjsonreader.h"
+
+#include "proofnetwork/mis/data/job.h"
+
+#include <QIODevice>
+#include <QJsonDocument>
+
+namespace Proof {
+namespace Mis {
+class JobsJsonReaderPrivate
+{
+    Q_DECLARE_PUBLIC(JobsJsonReader)
+    JobsJsonReader *q_ptr = nullptr;
+
+    enum class State
+    {
+        BeforeArray,
+        BeforeFirstJob,
+        BeforeJob,
+        InJob,
+        AfterJob,
+        AfterArray
+    };
+
+    bool scan();
+    bool parseJob(const char *data, int size);
+    bool fail(const QString &error);
+    void flushBatch();
+    void reportProgress() const;
+
+    int batchSize = JobsJsonReader::DEFAULT_BATCH_SIZE;
+    bool cacheUsed = true;
+    JobsJsonReader::BatchHandler batchHandler;
+    JobsJsonReader::ProgressHandler progressHandler;
+
+    //Holds unparsed data starting from current job, everything before it is dropped after each chunk
+    QByteArray buffer;
+    qint64 bufferOffset = 0;
+    int scanPos = 0;
+    int jobStart = 0;
+    int depth = 0;
+    bool inString = false;
+    bool escaped = false;
+    State state = State::BeforeArray;
+
+    QVector<JobSP> batch;
+    qint64 bytesRead = 0;
+    qint64 jobsRead = 0;
+    QString error;
+};
+} // namespace Mis
+} // namespace Proof
+
+using namespace Proof::Mis;
+
+static inline bool isJsonSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+JobsJsonReader::JobsJsonReader() : d_ptr(new JobsJsonReaderPrivate)
+{
+    d_ptr->q_ptr = this;
+}
+
+JobsJsonReader::~JobsJsonReader()
+{}
+
+int JobsJsonReader::batchSize() const
+{
+    Q_D_CONST(JobsJsonReader);
+    return d->batchSize;
+}
+
+void JobsJsonReader::setBatchSize(int batchSize)
+{
+    Q_D(JobsJsonReader);
+    d->batchSize = qMax(1, batchSize);
+}
+
+bool JobsJsonReader::isCacheUsed() const
+{
+    Q_D_CONST(JobsJsonReader);
+    return d->cacheUsed;
+}
+
+void JobsJsonReader::setCacheUsed(bool cacheUsed)
+{
+    Q_D(JobsJsonReader);
+    d->cacheUsed = cacheUsed;
+}
+
+void JobsJsonReader::setBatchHandler(const BatchHandler &handler)
+{
+    Q_D(JobsJsonReader);
+    d->batchHandler = handler;
+}
+
+void JobsJsonReader::setProgressHandler(const ProgressHandler &handler)
+{
+    Q_D(JobsJsonReader);
+    d->progressHandler = handler;
+}
+
+bool JobsJsonReader::addData(const QByteArray &data)
+{
+    Q_D(JobsJsonReader);
+    if (hasError())
+        return false;
+    d->bytesRead += data.size();
+    d->buffer.append(data);
+    bool result = d->scan();
+    d->reportProgress();
+    return result;
+}
+
+bool JobsJsonReader::finish()
+{
+    Q_D(JobsJsonReader);
+    if (hasError())
+        return false;
+    d->flushBatch();
+    if (d->state != JobsJsonReaderPrivate::State::AfterArray)
+        return d->fail(QStringLiteral("Unexpected end of data at offset %1").arg(d->bytesRead));
+    return true;
+}
+
+bool JobsJsonReader::read(QIODevice *device, qint64 chunkSize)
+{
+    Q_D(JobsJsonReader);
+    if (!device || !device->isReadable())
+        return d->fail(QStringLiteral("Device is not readable"));
+    chunkSize = qMax(chunkSize, 1ll);
+    while (!device->atEnd()) {
+        QByteArray chunk = device->read(chunkSize);
+        if (chunk.isEmpty() && !device->waitForReadyRead(-1))
+            break;
+        if (!addData(chunk))
+            return false;
+    }
+    return finish();
+}
+
+void JobsJsonReader::reset()
+{
+    Q_D(JobsJsonReader);
+    d->buffer.clear();
+    d->bufferOffset = 0;
+    d->scanPos = 0;
+    d->jobStart = 0;
+    d->depth = 0;
+    d->inString = false;
+    d->escaped = false;
+    d->state = JobsJsonReaderPrivate::State::BeforeArray;
+    d->batch.clear();
+    d->bytesRead = 0;
+    d->jobsRead = 0;
+    d->error.clear();
+}
+
+bool JobsJsonReader::atEnd() const
+{
+    Q_D_CONST(JobsJsonReader);
+    return d->state == JobsJsonReaderPrivate::State::AfterArray;
+}
+
+bool JobsJsonReader::hasError() const
+{
+    Q_D_CONST(JobsJsonReader);
+    return !d->error.isEmpty();
+}
+
+QString JobsJsonReader::errorString() const
+{
+    Q_D_CONST(JobsJsonReader);
+    return d->error;
+}
+
+qint64 JobsJsonReader::bytesRead() const
+{
+    Q_D_CONST(JobsJsonReader);
+    return d->bytesRead;
+}
+
+qint64 JobsJsonReader::jobsRead() const
+{
+    Q_D_CONST(JobsJsonReader);
+    return d->jobsRead;
+}
+
+bool JobsJsonReaderPrivate::scan()
+{
+    const char *data = buffer.constData();
+    const int size = buffer.size();
+    int pos = scanPos;
+    while (pos < size) {
+        char c = data[pos];
+        if (state == State::InJob) {
+            //Only job boundaries are looked for here, job itself is validated by parser
+            if (inString) {
+                if (escaped)
+                    escaped = false;
+                else if (c == '\\')
+                    escaped = true;
+                else if (c == '"')
+                    inString = false;
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == '{' || c == '[') {
+                ++depth;
+            } else if ((c == '}' || c == ']') && !--depth) {
+                if (!parseJob(data + jobStart, pos + 1 - jobStart))
+                    return false;
+                state = State::AfterJob;
+            }
+            ++pos;
+            continue;
+        }
+
+        if (isJsonSpace(c)) {
+            ++pos;
+            continue;
+        }
+        bool unexpected = false;
+        if (state == State::BeforeArray) {
+            unexpected = c != '[';
+            state = State::BeforeFirstJob;
+        } else if (state == State::BeforeFirstJob && c == ']') {
+            state = State::AfterArray;
+        } else if (state == State::BeforeFirstJob || state == State::BeforeJob) {
+            unexpected = c != '{';
+            state = State::InJob;
+            jobStart = pos;
+            depth = 1;
+        } else if (state == State::AfterJob) {
+            unexpected = c != ',' && c != ']';
+            state = c == ',' ? State::BeforeJob : State::AfterArray;
+        } else {
+            unexpected = true;
+        }
+        if (unexpected)
+            return fail(QStringLiteral("Unexpected character '%1' at offset %2").arg(c).arg(bufferOffset + pos));
+        ++pos;
+    }
+
+    int consumed = state == State::InJob ? jobStart : size;
+    buffer.remove(0, consumed);
+    bufferOffset += consumed;
+    scanPos = pos - consumed;
+    jobStart = 0;
+    return true;
+}
+
+bool JobsJsonReaderPrivate::parseJob(const char *data, int size)
+{
+    QJsonParseError jsonError;
+    QJsonDocument doc = QJsonDocument::fromJson(QByteArray::fromRawData(data, size), &jsonError);
+    if (jsonError.error != QJsonParseError::NoError || !doc.isObject()) {
+        return fail(QStringLiteral("Malformed job at offset %1: %2")
+                        .arg(bufferOffset + (data - buffer.constData()))
+                        .arg(jsonError.errorString()));
+    }
+    JobSP job = Job::fromJson(doc.object());
+    if (!job)
+        return true;
+    if (batch.isEmpty())
+        batch.reserve(batchSize);
+    batch << job;
+    ++jobsRead;
+    if (batch.count() >= batchSize)
+        flushBatch();
+    return true;
+}
+
+bool JobsJsonReaderPrivate::fail(const QString &error)
+{
+    qCWarning(proofNetworkMisDataLog) << "JobsJsonReader:" << error;
+    this->error = error;
+    buffer.clear();
+    batch.clear();
+    return false;
+}
+
+void JobsJsonReaderPrivate::flushBatch()
+{
+    if (batch.isEmpty())
+        return;
+    if (cacheUsed) {
+        for (JobSP &job : batch) {
+            JobSP cached = jobsCache().add(job->cacheKey(), job);
+            if (cached != job) {
+                cached->updateFrom(job);
+                job = cached;
+            }
+        }
+    }
+    if (batchHandler)
+        batchHandler(batch);
+    batch.clear();
+}
+
+void JobsJsonReaderPrivate::reportProgress() const
+{
+    if (progressHandler)
+        progressHandler(bytesRead, jobsRead);
+}
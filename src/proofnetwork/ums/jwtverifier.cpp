@@ -0,0 +1,220 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "proofnetwork/ums/jwtverifier.h"
+
+#include "proofseed/tasks.h"
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+#include <QtCrypto>
+
+namespace {
+constexpr int MIN_CLUSTER_SIZE = 16;
+
+//Immutable snapshot of verifier settings, so batch in progress is not affected by later changes.
+//QCA key can't be used from several threads at once, so each verification takes its own copy of it.
+//Copies are pooled, because each one clones provider context on its first use.
+class VerifierState
+{
+public:
+    VerifierState(const QCA::RSAPublicKey &key, qint64 leeway, bool unsignedAllowed)
+        : key(key), leeway(leeway), unsignedAllowed(unsignedAllowed)
+    {}
+
+    Proof::Ums::JwtVerifier::Verification verify(const QByteArray &token) const;
+
+    const QCA::RSAPublicKey key;
+    const qint64 leeway;
+    const bool unsignedAllowed;
+
+private:
+    bool verifySignature(const QByteArray &message, const QByteArray &signature) const;
+
+    mutable QMutex keysMutex;
+    mutable QVector<QCA::RSAPublicKey> idleKeys;
+};
+using VerifierStateSP = QSharedPointer<VerifierState>;
+
+QByteArray decodeSegment(const char *data, int size)
+{
+    QByteArray segment = QByteArray::fromRawData(data, size);
+    //JWT uses base64url, but segments encoded with standard alphabet are accepted too
+    bool standardAlphabet = segment.contains('+') || segment.contains('/');
+    return QByteArray::fromBase64(segment,
+                                  standardAlphabet ? QByteArray::Base64Encoding : QByteArray::Base64UrlEncoding);
+}
+} // namespace
+
+namespace Proof {
+namespace Ums {
+class JwtVerifierPrivate
+{
+    Q_DECLARE_PUBLIC(JwtVerifier)
+    JwtVerifier *q_ptr = nullptr;
+
+    VerifierStateSP currentState() const;
+
+    mutable QMutex stateMutex;
+    VerifierStateSP state;
+};
+} // namespace Ums
+} // namespace Proof
+
+using namespace Proof;
+using namespace Proof::Ums;
+
+JwtVerifier::JwtVerifier(const QCA::RSAPublicKey &key) : d_ptr(new JwtVerifierPrivate)
+{
+    d_ptr->q_ptr = this;
+    d_ptr->state = VerifierStateSP::create(key, 0, false);
+}
+
+JwtVerifier::~JwtVerifier()
+{}
+
+QCA::RSAPublicKey JwtVerifier::rsaKey() const
+{
+    Q_D_CONST(JwtVerifier);
+    return d->currentState()->key;
+}
+
+void JwtVerifier::setRsaKey(const QCA::RSAPublicKey &key)
+{
+    Q_D(JwtVerifier);
+    QMutexLocker lock(&d->stateMutex);
+    d->state = VerifierStateSP::create(key, d->state->leeway, d->state->unsignedAllowed);
+}
+
+int JwtVerifier::leeway() const
+{
+    Q_D_CONST(JwtVerifier);
+    return static_cast<int>(d->currentState()->leeway);
+}
+
+void JwtVerifier::setLeeway(int secs)
+{
+    Q_D(JwtVerifier);
+    QMutexLocker lock(&d->stateMutex);
+    d->state = VerifierStateSP::create(d->state->key, qMax(0, secs), d->state->unsignedAllowed);
+}
+
+bool JwtVerifier::isUnsignedAllowed() const
+{
+    Q_D_CONST(JwtVerifier);
+    return d->currentState()->unsignedAllowed;
+}
+
+void JwtVerifier::setUnsignedAllowed(bool allowed)
+{
+    Q_D(JwtVerifier);
+    QMutexLocker lock(&d->stateMutex);
+    d->state = VerifierStateSP::create(d->state->key, d->state->leeway, allowed);
+}
+
+JwtVerifier::Verification JwtVerifier::verify(const QByteArray &token) const
+{
+    Q_D_CONST(JwtVerifier);
+    return d->currentState()->verify(token);
+}
+
+FutureSP<QVector<JwtVerifier::Verification>> JwtVerifier::verify(const QVector<QByteArray> &tokens) const
+{
+    Q_D_CONST(JwtVerifier);
+    if (tokens.isEmpty())
+        return Future<>::successful(QVector<Verification>());
+    VerifierStateSP state = d->currentState();
+    return tasks::clusteredRun(tokens, [state](const QByteArray &token) { return state->verify(token); },
+                               MIN_CLUSTER_SIZE);
+}
+
+VerifierStateSP JwtVerifierPrivate::currentState() const
+{
+    QMutexLocker lock(&stateMutex);
+    return state;
+}
+
+JwtVerifier::Verification VerifierState::verify(const QByteArray &token) const
+{
+    JwtVerifier::Verification verification;
+    //Segments are referenced in place, only decoded data is allocated
+    int headerEnd = token.indexOf('.');
+    int payloadEnd = headerEnd > 0 ? token.indexOf('.', headerEnd + 1) : -1;
+    if (payloadEnd < 0 || token.indexOf('.', payloadEnd + 1) >= 0)
+        return verification;
+    const char *data = token.constData();
+
+    QJsonParseError jsonError;
+    QJsonDocument header = QJsonDocument::fromJson(decodeSegment(data, headerEnd), &jsonError);
+    if (jsonError.error != QJsonParseError::NoError || !header.isObject())
+        return verification;
+
+    QString algorithm = header.object().value(QStringLiteral("alg")).toString(QStringLiteral("none")).toLower();
+    //TODO: add HS256 support if ever will be needed
+    if (algorithm == QLatin1String("rs256")) {
+        QByteArray signature = decodeSegment(data + payloadEnd + 1, token.size() - payloadEnd - 1);
+        if (!verifySignature(QByteArray::fromRawData(data, payloadEnd), signature)) {
+            verification.result = JwtVerifier::Result::InvalidSignature;
+            return verification;
+        }
+    } else if (algorithm != QLatin1String("none") || !unsignedAllowed) {
+        verification.result = JwtVerifier::Result::UnsupportedAlgorithm;
+        return verification;
+    }
+
+    QJsonDocument payload = QJsonDocument::fromJson(decodeSegment(data + headerEnd + 1, payloadEnd - headerEnd - 1),
+                                                    &jsonError);
+    if (jsonError.error != QJsonParseError::NoError || !payload.isObject())
+        return verification;
+    verification.payload = payload.object();
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+    QJsonValue notBefore = verification.payload.value(QStringLiteral("nbf"));
+    QJsonValue expiresAt = verification.payload.value(QStringLiteral("exp"));
+    if (notBefore.isDouble() && now + leeway < static_cast<qint64>(notBefore.toDouble()))
+        verification.result = JwtVerifier::Result::NotYetValid;
+    else if (expiresAt.isDouble() && now - leeway >= static_cast<qint64>(expiresAt.toDouble()))
+        verification.result = JwtVerifier::Result::Expired;
+    else
+        verification.result = JwtVerifier::Result::Valid;
+    return verification;
+}
+
+bool VerifierState::verifySignature(const QByteArray &message, const QByteArray &signature) const
+{
+    if (key.isNull())
+        return false;
+    QCA::RSAPublicKey worker;
+    {
+        QMutexLocker lock(&keysMutex);
+        worker = idleKeys.isEmpty() ? key : idleKeys.takeLast();
+    }
+    bool verified = worker.verifyMessage(message, signature, QCA::EMSA3_SHA256);
+    QMutexLocker lock(&keysMutex);
+    idleKeys << worker;
+    return verified;
+}
@@ -0,0 +1,236 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "proofnetwork/ums/tokenmanager.h"
+
+#include "proofcore/proofobject_p.h"
+
+#include "proofnetwork/singleflight_p.h"
+
+#include "proofnetwork/ums/data/umstokeninfo.h"
+#include "proofnetwork/ums/tokensapi.h"
+
+#include <QDateTime>
+#include <QMutex>
+#include <QPointer>
+#include <QTimer>
+
+#include <atomic>
+#include <limits>
+#include <random>
+
+static const int DEFAULT_REFRESH_AHEAD = 60000;
+static const int DEFAULT_REFRESH_JITTER = 30000;
+static const int RETRY_INTERVAL = 5000;
+static const int MIN_REFRESH_INTERVAL = 1000;
+//Token that expires sooner is not given out, it could expire before request with it reaches server
+static const int EXPIRATION_MARGIN = 5000;
+
+namespace Proof {
+namespace Ums {
+class TokenManagerPrivate : public ProofObjectPrivate
+{
+    Q_DECLARE_PUBLIC(TokenManager)
+
+    bool isValid(const UmsTokenInfoSP &token) const;
+    CancelableFuture<UmsTokenInfoSP> sendRefresh(const QPointer<TokenManager> &manager);
+    void scheduleRefresh();
+    void refreshFailed();
+
+    TokensApi *tokensApi = nullptr;
+    QTimer *refreshTimer = nullptr;
+    std::mt19937 randomEngine{std::random_device()()};
+    std::atomic<int> refreshAhead{DEFAULT_REFRESH_AHEAD};
+    std::atomic<int> refreshJitter{DEFAULT_REFRESH_JITTER};
+    //There is only one token, so all refreshes go with the same empty key
+    SingleFlight<UmsTokenInfoSP> refreshes;
+
+    mutable QMutex mutex;
+    UmsTokenInfoSP tokenInfo;
+};
+} // namespace Ums
+} // namespace Proof
+
+using namespace Proof;
+using namespace Proof::Ums;
+
+TokenManager::TokenManager(TokensApi *tokensApi, QObject *parent) : ProofObject(*new TokenManagerPrivate, parent)
+{
+    Q_D(TokenManager);
+    d->tokensApi = tokensApi;
+    d->refreshTimer = new QTimer(this);
+    d->refreshTimer->setSingleShot(true);
+    connect(d->refreshTimer, &QTimer::timeout, this, [this] { refresh(); });
+    //Token can be updated from any thread, timer is rescheduled in manager thread
+    connect(this, &TokenManager::tokenChanged, this, [d] { d->scheduleRefresh(); });
+}
+
+TokenManager::~TokenManager()
+{
+    Q_D(TokenManager);
+    //Reply handlers check manager with QPointer, but there is no need to wait for reply nobody will use
+    d->refreshes.cancel(QString());
+}
+
+UmsTokenInfoSP TokenManager::tokenInfo() const
+{
+    Q_D_CONST(TokenManager);
+    QMutexLocker lock(&d->mutex);
+    return d->tokenInfo;
+}
+
+void TokenManager::setTokenInfo(const UmsTokenInfoSP &tokenInfo)
+{
+    Q_D(TokenManager);
+    {
+        QMutexLocker lock(&d->mutex);
+        if (d->tokenInfo == tokenInfo)
+            return;
+        d->tokenInfo = tokenInfo;
+    }
+    emit tokenChanged(tokenInfo);
+}
+
+int TokenManager::refreshAhead() const
+{
+    Q_D_CONST(TokenManager);
+    return d->refreshAhead;
+}
+
+void TokenManager::setRefreshAhead(int msecs)
+{
+    Q_D(TokenManager);
+    d->refreshAhead = qMax(0, msecs);
+}
+
+int TokenManager::refreshJitter() const
+{
+    Q_D_CONST(TokenManager);
+    return d->refreshJitter;
+}
+
+void TokenManager::setRefreshJitter(int msecs)
+{
+    Q_D(TokenManager);
+    d->refreshJitter = qMax(0, msecs);
+}
+
+qint64 TokenManager::deduplicatedRequestsCount() const
+{
+    Q_D_CONST(TokenManager);
+    return d->refreshes.deduplicatedCount();
+}
+
+CancelableFuture<UmsTokenInfoSP> TokenManager::token()
+{
+    Q_D(TokenManager);
+    QMutexLocker lock(&d->mutex);
+    if (d->isValid(d->tokenInfo)) {
+        PromiseSP<UmsTokenInfoSP> promise = PromiseSP<UmsTokenInfoSP>::create();
+        UmsTokenInfoSP current = d->tokenInfo;
+        lock.unlock();
+        promise->success(current);
+        return CancelableFuture<UmsTokenInfoSP>(promise);
+    }
+    lock.unlock();
+    return refresh();
+}
+
+CancelableFuture<UmsTokenInfoSP> TokenManager::refresh()
+{
+    Q_D(TokenManager);
+    QPointer<TokenManager> manager(this);
+    return d->refreshes.fetch(QString(), 0, [d, manager]() { return d->sendRefresh(manager); });
+}
+
+bool TokenManagerPrivate::isValid(const UmsTokenInfoSP &token) const
+{
+    return token && token->expiresAt().toMSecsSinceEpoch() - EXPIRATION_MARGIN > QDateTime::currentMSecsSinceEpoch();
+}
+
+//Token is stored before callers get it, so token() called from their continuations doesn't start new refresh
+CancelableFuture<UmsTokenInfoSP> TokenManagerPrivate::sendRefresh(const QPointer<TokenManager> &manager)
+{
+    QMutexLocker lock(&mutex);
+    UmsTokenInfoSP current = tokenInfo;
+    lock.unlock();
+    auto request = current && !current->token().isEmpty() ? tokensApi->refreshToken(current->token())
+                                                          : tokensApi->fetchToken();
+    PromiseSP<UmsTokenInfoSP> promise = PromiseSP<UmsTokenInfoSP>::create();
+    promise->future()->onFailure([request](const Failure &) mutable { request.cancel(); });
+    request
+        ->onSuccess([manager, promise](const UmsTokenInfoSP &fresh) {
+            if (manager) {
+                auto d = manager->d_func();
+                QMutexLocker lock(&d->mutex);
+                d->tokenInfo = fresh;
+                lock.unlock();
+                emit manager->tokenChanged(fresh);
+            }
+            promise->success(fresh);
+        })
+        ->onFailure([manager, promise](const Failure &failure) {
+            promise->failure(failure);
+            if (!manager)
+                return;
+            qCWarning(proofNetworkUmsApiLog) << "Token refresh failed:" << failure.message;
+            QTimer::singleShot(0, manager, [manager] {
+                if (manager)
+                    manager->d_func()->refreshFailed();
+            });
+        });
+    return CancelableFuture<UmsTokenInfoSP>(promise);
+}
+
+void TokenManagerPrivate::scheduleRefresh()
+{
+    QMutexLocker lock(&mutex);
+    UmsTokenInfoSP current = tokenInfo;
+    lock.unlock();
+    qint64 untilExpiration = current ? current->expiresAt().toMSecsSinceEpoch() - QDateTime::currentMSecsSinceEpoch()
+                                     : 0;
+    //Expired token is refreshed on next request
+    if (untilExpiration <= 0) {
+        refreshTimer->stop();
+        return;
+    }
+    int jitter = refreshJitter;
+    qint64 lead = static_cast<qint64>(refreshAhead)
+                  + (jitter > 0 ? std::uniform_int_distribution<int>(0, jitter)(randomEngine) : 0);
+    //Short-lived tokens are refreshed in the middle of their lifetime instead of right away
+    lead = qMin(lead, untilExpiration / 2);
+    qint64 delay = qMax(untilExpiration - lead, qMin<qint64>(MIN_REFRESH_INTERVAL, untilExpiration));
+    refreshTimer->start(static_cast<int>(qMin<qint64>(delay, std::numeric_limits<int>::max())));
+}
+
+void TokenManagerPrivate::refreshFailed()
+{
+    QMutexLocker lock(&mutex);
+    UmsTokenInfoSP current = tokenInfo;
+    lock.unlock();
+    if (refreshes.isInFlight(QString()) || !isValid(current))
+        return;
+    qint64 untilExpiration = current->expiresAt().toMSecsSinceEpoch() - QDateTime::currentMSecsSinceEpoch();
+    refreshTimer->start(static_cast<int>(qMin<qint64>(RETRY_INTERVAL, untilExpiration / 2)));
+}
@@ -26,24 +26,133 @@
 
 #include "proofnetwork/baserestapi_p.h"
 #include "proofnetwork/ums/data/umstokeninfo.h"
+#include "proofnetwork/ums/jwtverifier.h"
 
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMutex>
 #include <QNetworkReply>
-#include <QtCrypto>
+
+#include <atomic>
+#include <list>
 
 namespace Proof {
 namespace Ums {
 
+//Results of signature verification keyed by SHA-256 of token. Verified tokens are kept until they expire,
+//failed ones for a short time only. Least recently used entries are dropped when cache is full.
+//Only verified claims are stored, so each reply still gets its own UmsTokenInfo object.
+//Each clear starts new generation and results of verifications started before it are not stored.
+class VerifiedTokensCache
+{
+public:
+    static constexpr int DEFAULT_CAPACITY = 1024;
+    static constexpr qint64 FAILED_VERIFICATION_TTL = 60 * 1000;
+
+    struct Verification
+    {
+        bool verified;
+        QJsonObject payload;
+    };
+
+    static QByteArray key(const QByteArray &token)
+    {
+        return QCryptographicHash::hash(token, QCryptographicHash::Sha256);
+    }
+
+    bool find(const QByteArray &key, Verification &result)
+    {
+        QMutexLocker lock(&mutex);
+        auto it = index.find(key);
+        if (it == index.end())
+            return false;
+        if (it.value()->expiresAt <= QDateTime::currentMSecsSinceEpoch()) {
+            entries.erase(it.value());
+            index.erase(it);
+            return false;
+        }
+        entries.splice(entries.begin(), entries, it.value());
+        result = it.value()->verification;
+        ++hits;
+        return true;
+    }
+
+    void insert(const QByteArray &key, const Verification &verification, qint64 expiresAt, quint64 keyGeneration)
+    {
+        QMutexLocker lock(&mutex);
+        if (keyGeneration != generation || expiresAt <= QDateTime::currentMSecsSinceEpoch() || capacity <= 0
+            || index.contains(key)) {
+            return;
+        }
+        entries.push_front(Entry{key, verification, expiresAt});
+        index.insert(key, entries.begin());
+        evict();
+    }
+
+    void setCapacity(int newCapacity)
+    {
+        QMutexLocker lock(&mutex);
+        capacity = qMax(0, newCapacity);
+        evict();
+    }
+
+    int currentCapacity() const
+    {
+        QMutexLocker lock(&mutex);
+        return capacity;
+    }
+
+    quint64 currentGeneration() const
+    {
+        QMutexLocker lock(&mutex);
+        return generation;
+    }
+
+    void clear()
+    {
+        QMutexLocker lock(&mutex);
+        entries.clear();
+        index.clear();
+        ++generation;
+    }
+
+    std::atomic<qint64> hits{0};
+
+private:
+    struct Entry
+    {
+        QByteArray key;
+        Verification verification;
+        qint64 expiresAt;
+    };
+
+    void evict()
+    {
+        while (index.count() > capacity) {
+            index.remove(entries.back().key);
+            entries.pop_back();
+        }
+    }
+
+    mutable QMutex mutex;
+    std::list<Entry> entries;
+    QHash<QByteArray, std::list<Entry>::iterator> index;
+    int capacity = DEFAULT_CAPACITY;
+    quint64 generation = 0;
+};
+
 class TokensApiPrivate : public BaseRestApiPrivate
 {
     Q_DECLARE_PUBLIC(TokensApi)
     std::function<UmsTokenInfoSP(const RestApiReply &)> tokenUnmarshaller();
-    bool verifyToken(const QByteArrayList &tokenList);
 
-    QCA::RSAPublicKey rsaPublicKey;
+    JwtVerifier verifier;
+    JwtVerifier clientTokensVerifier;
     QString clientId;
     QString clientSecret;
+    VerifiedTokensCache verifiedTokens;
 };
 
 } // namespace Ums
@@ -58,18 +167,52 @@ TokensApi::TokensApi(const QString &clientId, const QString &clientSecret, const
     Q_D(TokensApi);
     d->clientId = clientId;
     d->clientSecret = clientSecret;
+    //Tokens are received directly from UMS, so unsigned ones are trusted
+    d->verifier.setUnsignedAllowed(true);
 }
 
 QCA::RSAPublicKey TokensApi::rsaKey() const
 {
     Q_D_CONST(TokensApi);
-    return d->rsaPublicKey;
+    return d->verifier.rsaKey();
 }
 
 void TokensApi::setRsaKey(const QCA::RSAPublicKey &key)
 {
     Q_D(TokensApi);
-    d->rsaPublicKey = key;
+    d->verifier.setRsaKey(key);
+    d->clientTokensVerifier.setRsaKey(key);
+    d->verifiedTokens.clear();
+}
+
+int TokensApi::verifiedTokensCacheCapacity() const
+{
+    Q_D_CONST(TokensApi);
+    return d->verifiedTokens.currentCapacity();
+}
+
+void TokensApi::setVerifiedTokensCacheCapacity(int tokensCount)
+{
+    Q_D(TokensApi);
+    d->verifiedTokens.setCapacity(tokensCount);
+}
+
+qint64 TokensApi::verifiedTokensCacheHits() const
+{
+    Q_D_CONST(TokensApi);
+    return d->verifiedTokens.hits;
+}
+
+const JwtVerifier *TokensApi::jwtVerifier() const
+{
+    Q_D_CONST(TokensApi);
+    return &d->clientTokensVerifier;
+}
+
+void TokensApi::clearVerifiedTokensCache()
+{
+    Q_D(TokensApi);
+    d->verifiedTokens.clear();
 }
 
 CancelableFuture<UmsTokenInfoSP> TokensApi::fetchToken()
@@ -136,13 +279,35 @@ std::function<UmsTokenInfoSP(const RestApiReply &)> TokensApiPrivate::tokenUnmar
 {
     return [this](const RestApiReply &reply) -> UmsTokenInfoSP {
         QString token = QJsonDocument::fromJson(reply.data).object().value(QStringLiteral("access_token")).toString();
-        QByteArrayList tokenList = token.toUtf8().split('.');
+        QByteArray tokenData = token.toUtf8();
+        QByteArray cacheKey = VerifiedTokensCache::key(tokenData);
+
+        VerifiedTokensCache::Verification cached;
+        if (!token.isEmpty() && verifiedTokens.find(cacheKey, cached)) {
+            if (!cached.verified) {
+                return WithFailure(QStringLiteral("Token signature verification failed"), NETWORK_UMS_MODULE_CODE,
+                                   NetworkErrorCode::InvalidTokenSignature);
+            }
+            return Proof::Ums::UmsTokenInfo::fromJson(cached.payload, token);
+        }
 
+        //Key can be replaced while token is being verified, such result must not get to cache
+        quint64 keyGeneration = verifiedTokens.currentGeneration();
         Proof::Ums::UmsTokenInfoSP tokenInfo;
-        bool signatureVerified = verifyToken(tokenList);
-        if (signatureVerified && tokenList.count() == 3) {
-            QJsonObject payload = QJsonDocument::fromJson(QByteArray::fromBase64(tokenList[1])).object();
-            tokenInfo = Proof::Ums::UmsTokenInfo::fromJson(payload, token);
+        JwtVerifier::Verification verification = verifier.verify(tokenData);
+        bool signatureVerified = verification.isSignatureVerified();
+        if (verification.result == JwtVerifier::Result::UnsupportedAlgorithm)
+            qCWarning(proofNetworkUmsApiLog) << "JWT algorithm is not supported. Token verification failed";
+        if (signatureVerified)
+            tokenInfo = Proof::Ums::UmsTokenInfo::fromJson(verification.payload, token);
+
+        if (!token.isEmpty() && !signatureVerified) {
+            verifiedTokens.insert(cacheKey, {false, QJsonObject()},
+                                  QDateTime::currentMSecsSinceEpoch() + VerifiedTokensCache::FAILED_VERIFICATION_TTL,
+                                  keyGeneration);
+        } else if (!token.isEmpty() && tokenInfo && tokenInfo->isDirty()) {
+            verifiedTokens.insert(cacheKey, {true, verification.payload}, tokenInfo->expiresAt().toMSecsSinceEpoch(),
+                                  keyGeneration);
         }
 
         if (!signatureVerified) {
@@ -155,29 +320,3 @@ std::function<UmsTokenInfoSP(const RestApiReply &)> TokensApiPrivate::tokenUnmar
         return tokenInfo;
     };
 }
-
-bool TokensApiPrivate::verifyToken(const QByteArrayList &tokenList)
-{
-    bool signatureVerified = false;
-    if (tokenList.count() == 3) {
-        QJsonObject header = QJsonDocument::fromJson(QByteArray::fromBase64(tokenList[0])).object();
-        QString algorithm = header.value(QStringLiteral("alg")).toString(QStringLiteral("none")).toLower();
-
-        QByteArray signature = QByteArray::fromBase64(tokenList[2], QByteArray::Base64UrlEncoding);
-        QByteArray signedMessage;
-        signedMessage.append(tokenList[0]);
-        signedMessage.append(".");
-        signedMessage.append(tokenList[1]);
-        //TODO: add HS256 support if ever will be needed
-        if (algorithm == QLatin1String("rs256")) {
-            signatureVerified = rsaPublicKey.verifyMessage(signedMessage, signature, QCA::EMSA3_SHA256);
-        } else if (algorithm == QLatin1String("none")) {
-            signatureVerified = true;
-        } else {
-            qCWarning(proofNetworkUmsApiLog)
-                << "JWT algorithm" << algorithm << "is not supported. Token verification failed";
-        }
-    }
-
-    return signatureVerified;
-}
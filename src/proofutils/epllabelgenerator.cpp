@@ -28,20 +28,59 @@
 
 #include "proofutils/qrcodegenerator.h"
 
+#include <QVector>
 #include <QtMath>
 
+#include <algorithm>
+
 //All constants here are taken from manual https://www.zebra.com/content/dam/zebra/manuals/en-us/printer/epl2-pm-en.pdf
 
 namespace Proof {
+struct LabelTemplateSlot
+{
+    enum class Type
+    {
+        QuotedText,
+        QrCode
+    };
+    int offset;
+    Type type;
+    QString name;
+    int x;
+    int y;
+    int width;
+};
+
+class LabelTemplatePrivate
+{
+    Q_DECLARE_PUBLIC(LabelTemplate)
+    friend class EplLabelGenerator;
+    LabelTemplate *q_ptr = nullptr;
+
+    QByteArray data;
+    QVector<LabelTemplateSlot> slots;
+    int bodyOffset = 0;
+    int printOffset = -1;
+};
+
 class EplLabelGeneratorPrivate
 {
     Q_DECLARE_PUBLIC(EplLabelGenerator)
 
     QSize charSize(int fontSize, int horizontalScale, int verticalScale) const;
+    void appendTextCommandHead(int x, int y, int rotation, int fontSize, int horizontalScale, int verticalScale,
+                               bool inverseColors);
+    void appendBarcodeCommandHead(EplLabelGenerator::BarcodeType type, int x, int y, int height,
+                                  bool printReadableCode, int narrowBarWidth, int wideBarWidth, int rotation);
+    QRect barcodeRect(int x, int y, int height, bool printReadableCode, int rotation) const;
+    void addSlot(LabelTemplateSlot::Type type, const QString &name, int x = 0, int y = 0, int width = 0);
 
     EplLabelGenerator *q_ptr = nullptr;
 
     QByteArray lastLabel;
+    QVector<LabelTemplateSlot> slots;
+    int bodyOffset = 0;
+    int printOffset = -1;
     int dpi = 203;
     int labelWidth = 795;
     int labelHeight = 1250;
@@ -50,46 +89,133 @@ class EplLabelGeneratorPrivate
     int gapLength = 24;
 };
 
-uint qHash(EplLabelGenerator::BarcodeType barcodeType, uint seed = 0)
-{
-    return ::qHash(static_cast<int>(barcodeType), seed);
-}
-
-//TODO: consider moving all big statics to Q_GLOBAL_STATIC
-static const QHash<EplLabelGenerator::BarcodeType, QString> STRINGIFIED_BARCODE_TYPES =
-    {{EplLabelGenerator::BarcodeType::Code39, "3"},
-     {EplLabelGenerator::BarcodeType::Code39WithCheckDigit, "3C"},
-     {EplLabelGenerator::BarcodeType::Code93, "9"},
-     {EplLabelGenerator::BarcodeType::Code128UCC, "0"},
-     {EplLabelGenerator::BarcodeType::Code128Auto, "1"},
-     {EplLabelGenerator::BarcodeType::Code128A, "1A"},
-     {EplLabelGenerator::BarcodeType::Code128B, "1B"},
-     {EplLabelGenerator::BarcodeType::Code128C, "1C"},
-     {EplLabelGenerator::BarcodeType::Code128DeutschePost, "1D"},
-     {EplLabelGenerator::BarcodeType::Codabar, "K"},
-     {EplLabelGenerator::BarcodeType::Ean8, "E80"},
-     {EplLabelGenerator::BarcodeType::Ean8Addon2, "E82"},
-     {EplLabelGenerator::BarcodeType::Ean8Addon5, "E85"},
-     {EplLabelGenerator::BarcodeType::Ean13, "E30"},
-     {EplLabelGenerator::BarcodeType::Ean13Addon2, "E32"},
-     {EplLabelGenerator::BarcodeType::Ean13Addon5, "E35"},
-     {EplLabelGenerator::BarcodeType::GermanPostCode, "2G"},
-     {EplLabelGenerator::BarcodeType::Interleaved2Of5, "2"},
-     {EplLabelGenerator::BarcodeType::Interleaved2Of5WithMod10CheckDigit, "2C"},
-     {EplLabelGenerator::BarcodeType::Interleaved2Of5WithHumanReadableCheckDigit, "2D"},
-     {EplLabelGenerator::BarcodeType::Postnet, "P"},
-     {EplLabelGenerator::BarcodeType::Planet, "PL"},
-     {EplLabelGenerator::BarcodeType::PostnetJapanese, "J"},
-     {EplLabelGenerator::BarcodeType::UccEan128, "1E"},
-     {EplLabelGenerator::BarcodeType::UpcA, "UA0"},
-     {EplLabelGenerator::BarcodeType::UpcAAddon2, "UA2"},
-     {EplLabelGenerator::BarcodeType::UpcAAddon5, "UA5"},
-     {EplLabelGenerator::BarcodeType::UpcE, "UE0"},
-     {EplLabelGenerator::BarcodeType::UpcEAddon2, "UE2"},
-     {EplLabelGenerator::BarcodeType::UpcEAddon5, "UE5"},
-     {EplLabelGenerator::BarcodeType::UpcInterleaved2Of5, "2U"},
-     {EplLabelGenerator::BarcodeType::Msi1WithMod10CheckDigit, "L"},
-     {EplLabelGenerator::BarcodeType::Msi3WithMod10CheckDigit, "M"}};
+namespace {
+constexpr int LABEL_BUFFER_RESERVE = 4096;
+constexpr int MAX_FORM_VARIABLES = 100;
+constexpr int MAX_FORM_VARIABLE_LENGTH = 99;
+constexpr int MAX_FORM_NAME_LENGTH = 8;
+
+const char *stringifiedBarcodeType(EplLabelGenerator::BarcodeType barcodeType)
+{
+    //Order must match EplLabelGenerator::BarcodeType
+    static const char *const types[] = {"3",   "3C",  "9",   "0",   "1",   "1A",  "1B",  "1C",  "1D",  "K",   "E80",
+                                        "E82", "E85", "E30", "E32", "E35", "2G",  "2",   "2C",  "2D",  "P",   "PL",
+                                        "J",   "1E",  "UA0", "UA2", "UA5", "UE0", "UE2", "UE5", "2U",  "L",   "M"};
+    auto index = static_cast<size_t>(barcodeType);
+    return index < sizeof(types) / sizeof(types[0]) ? types[index] : "1";
+}
+
+//Commands are written straight into label buffer without any intermediate QString
+void appendNumber(QByteArray &target, int value)
+{
+    char buffer[12];
+    char *const end = buffer + sizeof(buffer);
+    char *begin = end;
+    unsigned int absValue = value < 0 ? 0u - static_cast<unsigned int>(value) : static_cast<unsigned int>(value);
+    do {
+        *--begin = static_cast<char>('0' + absValue % 10);
+        absValue /= 10;
+    } while (absValue);
+    if (value < 0)
+        *--begin = '-';
+    target.append(begin, static_cast<int>(end - begin));
+}
+
+void appendNumbers(QByteArray &target, std::initializer_list<int> values)
+{
+    bool first = true;
+    for (int value : values) {
+        if (!first)
+            target.append(',');
+        first = false;
+        appendNumber(target, value);
+    }
+}
+
+void appendEscaped(QByteArray &target, char c)
+{
+    if (c == '\\' || c == '"')
+        target.append('\\');
+    target.append(c);
+}
+
+void appendQuoted(QByteArray &target, const QString &text)
+{
+    target.append('"');
+    const QChar *it = text.constBegin();
+    const QChar *const end = text.constEnd();
+    for (; it != end && it->unicode() < 0x80; ++it)
+        appendEscaped(target, static_cast<char>(it->unicode()));
+    //Non-ASCII tail is rare, so it is fine to convert it the same way QByteArray::append(QString) does
+    if (it != end) {
+        const QByteArray tail = QString::fromRawData(it, static_cast<int>(end - it)).toUtf8();
+        for (char c : tail)
+            appendEscaped(target, c);
+    }
+    target.append('"');
+}
+
+//Form names are sent quoted, so only printable ASCII without quotes and backslashes is allowed
+bool isValidFormName(const QString &formName)
+{
+    if (formName.isEmpty() || formName.size() > MAX_FORM_NAME_LENGTH)
+        return false;
+    return std::all_of(formName.cbegin(), formName.cend(), [](QChar c) {
+        return c.unicode() > 0x20 && c.unicode() < 0x7F && c != QLatin1Char('"') && c != QLatin1Char('\\');
+    });
+}
+
+void appendVariableName(QByteArray &target, int index)
+{
+    target.append('V');
+    target.append(static_cast<char>('0' + index / 10));
+    target.append(static_cast<char>('0' + index % 10));
+}
+
+int appendQrCode(QByteArray &target, const QString &data, int x, int y, int width)
+{
+    auto rawBinary = QrCodeGenerator::generateEplBinaryData(data, width);
+    width = width + ((width + 8) % 8);
+
+    target.append("GW");
+    appendNumbers(target, {x, y, width / 8, width});
+    target.append(',');
+    target.append(rawBinary);
+    target.append('\n');
+    return width;
+}
+
+int normalizedFontSize(int fontSize, bool numericText)
+{
+    if (fontSize > 7)
+        fontSize = 7;
+    if (fontSize < 1)
+        fontSize = 1;
+    if (!numericText && fontSize > 5)
+        fontSize = 5;
+    return fontSize;
+}
+
+int normalizedHorizontalScale(int horizontalScale)
+{
+    if (horizontalScale < 1)
+        horizontalScale = 1;
+    if (horizontalScale > 8)
+        horizontalScale = 8;
+    if (horizontalScale == 7)
+        horizontalScale = 6;
+    return horizontalScale;
+}
+
+int normalizedVerticalScale(int verticalScale)
+{
+    if (verticalScale < 1)
+        verticalScale = 1;
+    if (verticalScale > 9)
+        verticalScale = 9;
+    return verticalScale;
+}
+} // namespace
 
 } // namespace Proof
 
@@ -114,6 +240,9 @@ void EplLabelGenerator::startLabel(int width, int height, int speed, int density
     d->density = density;
     d->gapLength = gapLength;
     d->lastLabel.clear();
+    d->lastLabel.reserve(LABEL_BUFFER_RESERVE);
+    d->slots.clear();
+    d->printOffset = -1;
     startPage();
 }
 
@@ -122,39 +251,14 @@ QRect EplLabelGenerator::addText(const QString &text, int x, int y, int fontSize
 {
     Q_D(EplLabelGenerator);
 
-    if (fontSize > 7)
-        fontSize = 7;
-    if (fontSize < 1)
-        fontSize = 1;
-    if (!text.toInt() && fontSize > 5)
-        fontSize = 5;
-
-    if (horizontalScale < 1)
-        horizontalScale = 1;
-    if (horizontalScale > 8)
-        horizontalScale = 8;
-    if (horizontalScale == 7)
-        horizontalScale = 6;
-
-    if (verticalScale < 1)
-        verticalScale = 1;
-    if (verticalScale > 9)
-        verticalScale = 9;
-
-    QString preparedText = text;
-    preparedText.replace(QLatin1String("\\"), QLatin1String("\\\\")).replace(QLatin1String("\""), QLatin1String("\\\""));
-
+    fontSize = normalizedFontSize(fontSize, text.toInt() != 0);
+    horizontalScale = normalizedHorizontalScale(horizontalScale);
+    verticalScale = normalizedVerticalScale(verticalScale);
     rotation = (rotation % 360) / 90;
 
-    d->lastLabel.append(QStringLiteral("A%1,%2,%3,%4,%5,%6,%7,\"%8\"\n")
-                            .arg(x)
-                            .arg(y)
-                            .arg(rotation)
-                            .arg(fontSize)
-                            .arg(horizontalScale)
-                            .arg(verticalScale)
-                            .arg(inverseColors ? QStringLiteral("R") : QStringLiteral("N")) // clazy:exclude=qstring-arg
-                            .arg(preparedText));
+    d->appendTextCommandHead(x, y, rotation, fontSize, horizontalScale, verticalScale, inverseColors);
+    appendQuoted(d->lastLabel, text);
+    d->lastLabel.append('\n');
 
     QRect rect(QPoint(x, y), textSize(text, fontSize, horizontalScale, verticalScale));
 
@@ -192,74 +296,75 @@ QRect EplLabelGenerator::addBarcode(const QString &data, EplLabelGenerator::Barc
                                     bool printReadableCode, int narrowBarWidth, int wideBarWidth, int rotation)
 {
     Q_D(EplLabelGenerator);
-    QString preparedData = data;
-    preparedData.replace(QLatin1String("\\"), QLatin1String("\\\\")).replace(QLatin1String("\""), QLatin1String("\\\""));
-
     rotation = (rotation % 360) / 90;
 
-    d->lastLabel.append(QStringLiteral("B%1,%2,%3,%4,%5,%6,%7,%8,\"%9\"\n")
-                            .arg(x)
-                            .arg(y)
-                            .arg(rotation)
-                            .arg(STRINGIFIED_BARCODE_TYPES.value(type, QStringLiteral("1")))
-                            .arg(narrowBarWidth)
-                            .arg(wideBarWidth)
-                            .arg(height)
-                            .arg(printReadableCode ? QStringLiteral("B") : QStringLiteral("N")) // clazy:exclude=qstring-arg
-                            .arg(preparedData));
+    d->appendBarcodeCommandHead(type, x, y, height, printReadableCode, narrowBarWidth, wideBarWidth, rotation);
+    appendQuoted(d->lastLabel, data);
+    d->lastLabel.append('\n');
 
-    if (printReadableCode)
-        height += d->charSize(4, 1, 1).height();
-    QRect rect(x, y, d->labelWidth - x, height);
+    return d->barcodeRect(x, y, height, printReadableCode, rotation);
+}
 
-    //We can't calc width here, so let's assume it goes straight to the end
-    switch (rotation) {
-    case 1:
-        rect = QRect(rect.x() - rect.height(), rect.y(), rect.height(), d->labelHeight - rect.y());
-        break;
-    case 2:
-        rect = QRect(0, rect.y() - rect.height(), rect.x(), rect.height());
-        break;
-    case 3:
-        rect = QRect(rect.x(), 0, rect.height(), rect.y());
-        break;
-    default:
-        break;
-    }
+QRect EplLabelGenerator::addQrCode(const QString &data, int x, int y, int width)
+{
+    Q_D(EplLabelGenerator);
+    width = appendQrCode(d->lastLabel, data, x, y, width);
+    return QRect(x, y, width, width);
+}
 
-    return rect;
+void EplLabelGenerator::addTextPlaceholder(const QString &name, int x, int y, int fontSize, int horizontalScale,
+                                           int verticalScale, int rotation, bool inverseColors, bool numericText)
+{
+    Q_D(EplLabelGenerator);
+    fontSize = normalizedFontSize(fontSize, numericText);
+    horizontalScale = normalizedHorizontalScale(horizontalScale);
+    verticalScale = normalizedVerticalScale(verticalScale);
+    rotation = (rotation % 360) / 90;
+
+    d->appendTextCommandHead(x, y, rotation, fontSize, horizontalScale, verticalScale, inverseColors);
+    d->addSlot(LabelTemplateSlot::Type::QuotedText, name);
+    d->lastLabel.append('\n');
 }
 
-QRect EplLabelGenerator::addQrCode(const QString &data, int x, int y, int width)
+QRect EplLabelGenerator::addBarcodePlaceholder(const QString &name, BarcodeType type, int x, int y, int height,
+                                               bool printReadableCode, int narrowBarWidth, int wideBarWidth,
+                                               int rotation)
 {
     Q_D(EplLabelGenerator);
-    auto rawBinary = QrCodeGenerator::generateEplBinaryData(data, width);
-    width = width + ((width + 8) % 8);
+    rotation = (rotation % 360) / 90;
+
+    d->appendBarcodeCommandHead(type, x, y, height, printReadableCode, narrowBarWidth, wideBarWidth, rotation);
+    d->addSlot(LabelTemplateSlot::Type::QuotedText, name);
+    d->lastLabel.append('\n');
 
-    d->lastLabel.append(QStringLiteral("GW%1,%2,%3,%4,").arg(x).arg(y).arg(width / 8).arg(width));
-    d->lastLabel.append(rawBinary);
-    d->lastLabel.append("\n");
+    return d->barcodeRect(x, y, height, printReadableCode, rotation);
+}
 
+QRect EplLabelGenerator::addQrCodePlaceholder(const QString &name, int x, int y, int width)
+{
+    Q_D(EplLabelGenerator);
+    d->addSlot(LabelTemplateSlot::Type::QrCode, name, x, y, width);
+    width = width + ((width + 8) % 8);
     return QRect(x, y, width, width);
 }
 
 QRect EplLabelGenerator::addLine(int x, int y, int width, int height, EplLabelGenerator::LineType type)
 {
     Q_D(EplLabelGenerator);
-    QString lineTypeString;
+    d->lastLabel.append('L');
     switch (type) {
     case LineType::Black:
-        lineTypeString = QStringLiteral("O");
+        d->lastLabel.append('O');
         break;
     case LineType::White:
-        lineTypeString = QStringLiteral("W");
+        d->lastLabel.append('W');
         break;
     case LineType::Xor:
-        lineTypeString = QStringLiteral("E");
+        d->lastLabel.append('E');
         break;
     }
-
-    d->lastLabel.append(QStringLiteral("L%1%2,%3,%4,%5\n").arg(lineTypeString).arg(x).arg(y).arg(width).arg(height));
+    appendNumbers(d->lastLabel, {x, y, width, height});
+    d->lastLabel.append('\n');
 
     return QRect(x, y, width, height);
 }
@@ -267,7 +372,9 @@ QRect EplLabelGenerator::addLine(int x, int y, int width, int height, EplLabelGe
 QRect EplLabelGenerator::addDiagonalLine(int x, int y, int endX, int endY, int width)
 {
     Q_D(EplLabelGenerator);
-    d->lastLabel.append(QStringLiteral("LS%1,%2,%3,%4,%5\n").arg(x).arg(y).arg(width).arg(endX).arg(endY));
+    d->lastLabel.append("LS");
+    appendNumbers(d->lastLabel, {x, y, width, endX, endY});
+    d->lastLabel.append('\n');
 
     return {QPoint(qMin(x, endX), qMin(y, endY)), QSize(qAbs(endX - x), qAbs(endY - y) + width)};
 }
@@ -275,7 +382,11 @@ QRect EplLabelGenerator::addDiagonalLine(int x, int y, int endX, int endY, int w
 void EplLabelGenerator::addPrintCommand(int copies)
 {
     Q_D(EplLabelGenerator);
-    d->lastLabel.append(QStringLiteral("P%1\n").arg(copies));
+    if (d->printOffset < 0)
+        d->printOffset = d->lastLabel.size();
+    d->lastLabel.append('P');
+    appendNumber(d->lastLabel, copies);
+    d->lastLabel.append('\n');
 }
 
 void EplLabelGenerator::addClearBufferCommand()
@@ -289,11 +400,17 @@ void EplLabelGenerator::startPage()
     Q_D(EplLabelGenerator);
     d->lastLabel.append("I8,A,001\n");
     d->lastLabel.append("OD\n");
-    d->lastLabel.append(QStringLiteral("q%1\n").arg(d->labelWidth));
-    d->lastLabel.append(QStringLiteral("Q%1,%2\n").arg(d->labelHeight).arg(d->gapLength));
-    d->lastLabel.append(QStringLiteral("S%1\n").arg(d->speed));
-    d->lastLabel.append(QStringLiteral("D%1\n").arg(d->density));
+    d->lastLabel.append('q');
+    appendNumber(d->lastLabel, d->labelWidth);
+    d->lastLabel.append("\nQ");
+    appendNumbers(d->lastLabel, {d->labelHeight, d->gapLength});
+    d->lastLabel.append("\nS");
+    appendNumber(d->lastLabel, d->speed);
+    d->lastLabel.append("\nD");
+    appendNumber(d->lastLabel, d->density);
+    d->lastLabel.append('\n');
     d->lastLabel.append("JF\n\n");
+    d->bodyOffset = d->lastLabel.size();
 }
 
 QByteArray EplLabelGenerator::labelData() const
@@ -302,6 +419,67 @@ QByteArray EplLabelGenerator::labelData() const
     return d->lastLabel;
 }
 
+LabelTemplate EplLabelGenerator::labelTemplate() const
+{
+    Q_D_CONST(EplLabelGenerator);
+    LabelTemplate result;
+    result.d_ptr->data = d->lastLabel;
+    result.d_ptr->slots = d->slots;
+    result.d_ptr->bodyOffset = d->bodyOffset;
+    result.d_ptr->printOffset = d->printOffset;
+    return result;
+}
+
+void EplLabelGeneratorPrivate::appendTextCommandHead(int x, int y, int rotation, int fontSize, int horizontalScale,
+                                                     int verticalScale, bool inverseColors)
+{
+    lastLabel.append('A');
+    appendNumbers(lastLabel, {x, y, rotation, fontSize, horizontalScale, verticalScale});
+    lastLabel.append(inverseColors ? ",R," : ",N,");
+}
+
+void EplLabelGeneratorPrivate::appendBarcodeCommandHead(EplLabelGenerator::BarcodeType type, int x, int y, int height,
+                                                        bool printReadableCode, int narrowBarWidth, int wideBarWidth,
+                                                        int rotation)
+{
+    lastLabel.append('B');
+    appendNumbers(lastLabel, {x, y, rotation});
+    lastLabel.append(',');
+    lastLabel.append(stringifiedBarcodeType(type));
+    lastLabel.append(',');
+    appendNumbers(lastLabel, {narrowBarWidth, wideBarWidth, height});
+    lastLabel.append(printReadableCode ? ",B," : ",N,");
+}
+
+QRect EplLabelGeneratorPrivate::barcodeRect(int x, int y, int height, bool printReadableCode, int rotation) const
+{
+    if (printReadableCode)
+        height += charSize(4, 1, 1).height();
+    QRect rect(x, y, labelWidth - x, height);
+
+    //We can't calc width here, so let's assume it goes straight to the end
+    switch (rotation) {
+    case 1:
+        rect = QRect(rect.x() - rect.height(), rect.y(), rect.height(), labelHeight - rect.y());
+        break;
+    case 2:
+        rect = QRect(0, rect.y() - rect.height(), rect.x(), rect.height());
+        break;
+    case 3:
+        rect = QRect(rect.x(), 0, rect.height(), rect.y());
+        break;
+    default:
+        break;
+    }
+
+    return rect;
+}
+
+void EplLabelGeneratorPrivate::addSlot(LabelTemplateSlot::Type type, const QString &name, int x, int y, int width)
+{
+    slots.append(LabelTemplateSlot{lastLabel.size(), type, name, x, y, width});
+}
+
 QSize EplLabelGeneratorPrivate::charSize(int fontSize, int horizontalScale, int verticalScale) const
 {
     QSize result;
@@ -332,3 +510,168 @@ QSize EplLabelGeneratorPrivate::charSize(int fontSize, int horizontalScale, int
     }
     return QSize(result.width() * horizontalScale, result.height() * verticalScale);
 }
+
+LabelTemplate::LabelTemplate() : d_ptr(new LabelTemplatePrivate)
+{
+    d_ptr->q_ptr = this;
+}
+
+LabelTemplate::LabelTemplate(const LabelTemplate &other) : d_ptr(new LabelTemplatePrivate)
+{
+    d_ptr->q_ptr = this;
+    d_ptr->data = other.d_ptr->data;
+    d_ptr->slots = other.d_ptr->slots;
+    d_ptr->bodyOffset = other.d_ptr->bodyOffset;
+    d_ptr->printOffset = other.d_ptr->printOffset;
+}
+
+//Moved-from template gets fresh empty private part, so it stays usable
+LabelTemplate::LabelTemplate(LabelTemplate &&other) : d_ptr(new LabelTemplatePrivate)
+{
+    d_ptr.swap(other.d_ptr);
+    d_ptr->q_ptr = this;
+    other.d_ptr->q_ptr = &other;
+}
+
+LabelTemplate::~LabelTemplate()
+{}
+
+LabelTemplate &LabelTemplate::operator=(const LabelTemplate &other)
+{
+    d_ptr->data = other.d_ptr->data;
+    d_ptr->slots = other.d_ptr->slots;
+    d_ptr->bodyOffset = other.d_ptr->bodyOffset;
+    d_ptr->printOffset = other.d_ptr->printOffset;
+    return *this;
+}
+
+LabelTemplate &LabelTemplate::operator=(LabelTemplate &&other)
+{
+    d_ptr.swap(other.d_ptr);
+    d_ptr->q_ptr = this;
+    other.d_ptr->q_ptr = &other;
+    return *this;
+}
+
+bool LabelTemplate::isEmpty() const
+{
+    Q_D_CONST(LabelTemplate);
+    return d->data.isEmpty();
+}
+
+QStringList LabelTemplate::placeholders() const
+{
+    Q_D_CONST(LabelTemplate);
+    QStringList result;
+    for (const auto &slot : qAsConst(d->slots)) {
+        if (!result.contains(slot.name))
+            result << slot.name;
+    }
+    return result;
+}
+
+QByteArray LabelTemplate::render(const QHash<QString, QString> &values) const
+{
+    Q_D_CONST(LabelTemplate);
+    //Most of substituted values are ASCII, so twice their length is more than enough for escaping and quotes
+    int estimatedSize = d->data.size();
+    for (const auto &slot : qAsConst(d->slots))
+        estimatedSize += 2 * values.value(slot.name).size() + 2;
+
+    QByteArray result;
+    result.reserve(estimatedSize);
+    int staticOffset = 0;
+    for (const auto &slot : qAsConst(d->slots)) {
+        result.append(d->data.constData() + staticOffset, slot.offset - staticOffset);
+        staticOffset = slot.offset;
+        const QString value = values.value(slot.name);
+        switch (slot.type) {
+        case LabelTemplateSlot::Type::QuotedText:
+            appendQuoted(result, value);
+            break;
+        case LabelTemplateSlot::Type::QrCode:
+            appendQrCode(result, value, slot.x, slot.y, slot.width);
+            break;
+        }
+    }
+    result.append(d->data.constData() + staticOffset, d->data.size() - staticOffset);
+    return result;
+}
+
+bool LabelTemplate::canBeStoredAsForm() const
+{
+    Q_D_CONST(LabelTemplate);
+    if (d->data.isEmpty() || placeholders().count() > MAX_FORM_VARIABLES)
+        return false;
+    return std::none_of(d->slots.cbegin(), d->slots.cend(),
+                        [](const auto &slot) { return slot.type == LabelTemplateSlot::Type::QrCode; });
+}
+
+QByteArray LabelTemplate::formUploadData(const QString &formName) const
+{
+    Q_D_CONST(LabelTemplate);
+    if (!canBeStoredAsForm()) {
+        qCWarning(proofUtilsEplGeneratorLog) << "Label template can't be stored as form" << formName;
+        return QByteArray();
+    }
+    if (!isValidFormName(formName)) {
+        qCWarning(proofUtilsEplGeneratorLog) << "Invalid form name" << formName;
+        return QByteArray();
+    }
+
+    const QStringList variables = placeholders();
+    const QByteArray quotedName = '"' + formName.toUtf8() + '"';
+    const int bodyEnd = d->printOffset < 0 ? d->data.size() : d->printOffset;
+
+    QByteArray result;
+    result.reserve(bodyEnd - d->bodyOffset + 64 * variables.count() + 64);
+    result.append("\nFK").append(quotedName).append("\nFS").append(quotedName).append('\n');
+    for (int i = 0; i < variables.count(); ++i) {
+        appendVariableName(result, i);
+        result.append(',');
+        appendNumber(result, MAX_FORM_VARIABLE_LENGTH);
+        result.append(",N,");
+        appendQuoted(result, variables[i]);
+        result.append('\n');
+    }
+
+    int staticOffset = d->bodyOffset;
+    for (const auto &slot : qAsConst(d->slots)) {
+        if (slot.offset < d->bodyOffset || slot.offset > bodyEnd)
+            continue;
+        result.append(d->data.constData() + staticOffset, slot.offset - staticOffset);
+        staticOffset = slot.offset;
+        appendVariableName(result, variables.indexOf(slot.name));
+    }
+    result.append(d->data.constData() + staticOffset, bodyEnd - staticOffset);
+    result.append("FE\n");
+    return result;
+}
+
+QByteArray LabelTemplate::formRecallData(const QString &formName, const QHash<QString, QString> &values) const
+{
+    Q_D_CONST(LabelTemplate);
+    if (!canBeStoredAsForm()) {
+        qCWarning(proofUtilsEplGeneratorLog) << "Label template can't be recalled as form" << formName;
+        return QByteArray();
+    }
+    if (!isValidFormName(formName)) {
+        qCWarning(proofUtilsEplGeneratorLog) << "Invalid form name" << formName;
+        return QByteArray();
+    }
+
+    const QStringList variables = placeholders();
+    QByteArray result;
+    result.reserve(d->data.size() - d->bodyOffset + 32 * variables.count());
+    result.append(d->data.constData(), d->bodyOffset);
+    result.append("FR\"").append(formName.toUtf8()).append("\"\n");
+    if (!variables.isEmpty()) {
+        result.append("?\n");
+        //Variable data is sent as is, one line per variable, so line breaks can't be part of value
+        for (const auto &variable : variables)
+            result.append(values.value(variable).toUtf8().replace('\n', ' ').replace('\r', ' ')).append('\n');
+    }
+    if (d->printOffset >= 0)
+        result.append(d->data.constData() + d->printOffset, d->data.size() - d->printOffset);
+    return result;
+}
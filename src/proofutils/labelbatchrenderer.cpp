@@ -0,0 +1,70 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "proofutils/labelbatchrenderer.h"
+
+#include "proofseed/tasks.h"
+
+using namespace Proof;
+
+namespace {
+//Rendering of one label takes few microseconds, so it doesn't make sense to schedule them one by one
+constexpr qlonglong MIN_CLUSTER_SIZE = 64;
+} // namespace
+
+FutureSP<QVector<QByteArray>> LabelBatchRenderer::render(const LabelTemplate &labelTemplate,
+                                                         const QVector<LabelValues> &rows)
+{
+    if (rows.isEmpty())
+        return Future<>::successful(QVector<QByteArray>());
+    return tasks::clusteredRun(rows,
+                               [labelTemplate](const LabelValues &values) { return labelTemplate.render(values); },
+                               MIN_CLUSTER_SIZE);
+}
+
+FutureSP<QVector<QByteArray>> LabelBatchRenderer::render(const QVector<LabelDescription> &labels, int printerDpi)
+{
+    if (labels.isEmpty())
+        return Future<>::successful(QVector<QByteArray>());
+    return tasks::clusteredRun(labels,
+                               [printerDpi](const LabelDescription &description) {
+                                   EplLabelGenerator generator(printerDpi);
+                                   generator.startLabel();
+                                   description(generator);
+                                   return generator.labelData();
+                               },
+                               MIN_CLUSTER_SIZE);
+}
+
+QByteArray LabelBatchRenderer::joined(const QVector<QByteArray> &labels)
+{
+    int size = 0;
+    for (const auto &label : labels)
+        size += label.size();
+    QByteArray result;
+    result.reserve(size);
+    for (const auto &label : labels)
+        result.append(label);
+    return result;
+}
@@ -30,10 +30,17 @@
 
 #include "proofnetwork/lprprinter/lprprinterapi.h"
 
+#include "proofutils/printspool.h"
+#include "proofutils/rawsocketprinter.h"
+
 #ifndef Q_OS_ANDROID
 #    include "proofutils/lprprinter.h"
 #endif
 
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QMutex>
+
 namespace Proof {
 class LabelPrinterPrivate : public ProofObjectPrivate
 {
@@ -42,11 +49,70 @@ class LabelPrinterPrivate : public ProofObjectPrivate
 #ifndef Q_OS_ANDROID
     Proof::Hardware::LprPrinter *hardwareLabelPrinter = nullptr;
 #endif
+    Proof::Hardware::RawSocketPrinter *rawSocketPrinter = nullptr;
     Proof::NetworkServices::LprPrinterApi *labelPrinterApi = nullptr;
 
+    void createTransport();
+    FutureSP<bool> printDirectly(const QByteArray &label, bool ignorePrinterState) const;
+    FutureSP<bool> sendToTransport(const QByteArray &label, bool ignorePrinterState) const;
+    FutureSP<bool> checkTransportReadiness() const;
+    QString printerKey() const;
+
     LabelPrinterParams params;
+    QSharedPointer<PrintSpool> spool;
+    qint64 spoolSenderId = 0;
+};
+
+//Forms are stored at printer itself, so all LabelPrinter instances pointing to same printer share this knowledge.
+//Printer can lose its forms after reset without any sign at transport level, so residency expires after ttl
+//and is dropped for whole printer on any failed print or readiness check.
+struct ResidentForm
+{
+    QByteArray hash;
+    qint64 expiresAt = 0;
 };
 
+struct ResidentForms
+{
+    QMutex mutex;
+    QHash<QString, QHash<QString, ResidentForm>> forms;
+
+    bool isResident(const QString &printerKey, const QString &formName, const QByteArray &hash)
+    {
+        QMutexLocker lock(&mutex);
+        ResidentForm form = forms.value(printerKey).value(formName);
+        return form.hash == hash && form.expiresAt > QDateTime::currentMSecsSinceEpoch();
+    }
+
+    void insert(const QString &printerKey, const QString &formName, const QByteArray &hash, int ttl)
+    {
+        if (ttl <= 0)
+            return;
+        QMutexLocker lock(&mutex);
+        forms[printerKey][formName] = ResidentForm{hash, QDateTime::currentMSecsSinceEpoch() + ttl};
+    }
+
+    void remove(const QString &printerKey, const QString &formName)
+    {
+        QMutexLocker lock(&mutex);
+        auto it = forms.find(printerKey);
+        if (it != forms.end())
+            it->remove(formName);
+    }
+
+    void clear(const QString &printerKey)
+    {
+        QMutexLocker lock(&mutex);
+        forms.remove(printerKey);
+    }
+};
+Q_GLOBAL_STATIC(ResidentForms, residentForms)
+
+static QByteArray formHash(const QByteArray &uploadData)
+{
+    return QCryptographicHash::hash(uploadData, QCryptographicHash::Sha1);
+}
+
 } // namespace Proof
 
 using namespace Proof;
@@ -56,10 +122,127 @@ LabelPrinter::LabelPrinter(const LabelPrinterParams &params, QObject *parent)
 {
     Q_D(LabelPrinter);
     d->params = params;
+    d->createTransport();
+
+    if (!params.spoolDirectory.isEmpty()) {
+        d->spool = PrintSpool::forDirectory(params.spoolDirectory, params.spoolSyncPolicy);
+        //Spooled labels are sent only to ready printer unless they were enqueued with ignorePrinterState,
+        //otherwise they will be retried later. They are sent from thread of this printer as direct prints are.
+        //Spool is shared with other printers and outlives this one, detach guarantees that d is not used after it
+        d->spoolSenderId = d->spool->attach(
+            d->printerKey(),
+            [d](const QByteArray &label, bool ignorePrinterState) {
+                return d->printDirectly(label, ignorePrinterState);
+            },
+            this);
+    }
+}
+
+LabelPrinter::~LabelPrinter()
+{
+    Q_D(LabelPrinter);
+    if (d->spool)
+        d->spool->detach(d->printerKey(), d->spoolSenderId);
+}
+
+FutureSP<bool> LabelPrinter::printLabel(const QByteArray &label, bool ignorePrinterState) const
+{
+    Q_D_CONST(LabelPrinter);
+    if (d->spool)
+        return d->spool->enqueue(d->printerKey(), label, ignorePrinterState);
+    return d->printDirectly(label, ignorePrinterState);
+}
+
+qint64 LabelPrinter::spooledLabelsCount() const
+{
+    Q_D_CONST(LabelPrinter);
+    return d->spool ? d->spool->pendingCount(d->printerKey()) : 0;
+}
+
+FutureSP<bool> LabelPrinter::printerIsReady() const
+{
+    Q_D_CONST(LabelPrinter);
+    //Printer that was not ready could be reset meanwhile, so its forms are uploaded again next time
+    const QString printerKey = d->printerKey();
+    return d->checkTransportReadiness()
+        ->onSuccess([printerKey](bool ready) {
+            if (!ready)
+                residentForms->clear(printerKey);
+        })
+        ->onFailure([printerKey](const Failure &) { residentForms->clear(printerKey); });
+}
+
+FutureSP<bool> LabelPrinter::printStoredForm(const QString &formName, const LabelTemplate &labelTemplate,
+                                             const QHash<QString, QString> &values, bool ignorePrinterState) const
+{
+    Q_D_CONST(LabelPrinter);
+    QByteArray uploadData = labelTemplate.formUploadData(formName);
+    if (uploadData.isEmpty()) {
+        return Future<bool>::fail(Failure(QStringLiteral("Label template can't be stored at printer"),
+                                          UTILS_MODULE_CODE, UtilsErrorCode::FormCannotBeStored));
+    }
+
+    const QString printerKey = d->printerKey();
+    const QByteArray hash = formHash(uploadData);
+    QByteArray data = labelTemplate.formRecallData(formName, values);
+    //Resident form is only recalled, so such label can go through spool as any other one.
+    //Failed sends of it, including spooled ones, drop residency of all printer forms in printDirectly()
+    if (residentForms->isResident(printerKey, formName, hash))
+        return printLabel(data, ignorePrinterState);
+
+    //Spool resolves its future before label reaches printer, so upload is always sent directly
+    //and form is marked as resident only after printer accepted it
+    data.prepend(uploadData);
+    const int ttl = d->params.residentFormTtl;
+    return d->printDirectly(data, ignorePrinterState)->onSuccess([printerKey, formName, hash, ttl](bool printed) {
+        if (printed)
+            residentForms->insert(printerKey, formName, hash, ttl);
+    });
+}
+
+bool LabelPrinter::isFormResident(const QString &formName, const LabelTemplate &labelTemplate) const
+{
+    Q_D_CONST(LabelPrinter);
+    QByteArray uploadData = labelTemplate.formUploadData(formName);
+    if (uploadData.isEmpty())
+        return false;
+    return residentForms->isResident(d->printerKey(), formName, formHash(uploadData));
+}
+
+void LabelPrinter::forgetResidentForm(const QString &formName) const
+{
+    Q_D_CONST(LabelPrinter);
+    residentForms->remove(d->printerKey(), formName);
+}
+
+void LabelPrinter::forgetResidentForms() const
+{
+    Q_D_CONST(LabelPrinter);
+    residentForms->clear(d->printerKey());
+}
+
+QString LabelPrinter::title() const
+{
+    Q_D_CONST(LabelPrinter);
+    return d->params.printerTitle;
+}
+
+void LabelPrinterPrivate::createTransport()
+{
+    Q_Q(LabelPrinter);
+    if (params.rawSocket) {
+        rawSocketPrinter = new Proof::Hardware::RawSocketPrinter(params.printerHost,
+                                                                 static_cast<quint16>(params.rawSocketPort), q);
+        return;
+    }
 #ifndef Q_OS_ANDROID
     if (!params.forceServiceUsage && !params.printerName.isEmpty()) {
-        d->hardwareLabelPrinter = new Proof::Hardware::LprPrinter(params.printerHost, params.printerName,
-                                                                  params.strictHardwareCheck, this);
+        hardwareLabelPrinter = new Proof::Hardware::LprPrinter(params.printerHost, params.printerName,
+                                                               params.strictHardwareCheck, q);
+        if (params.nativeLpd)
+            hardwareLabelPrinter->setUseNativeLpd(true, static_cast<quint16>(params.lpdPort));
+        hardwareLabelPrinter->setReadinessCacheTtl(params.readinessCacheTtl);
+        hardwareLabelPrinter->setReadinessPollingInterval(params.readinessPollingInterval);
         return;
     }
 #endif
@@ -69,32 +252,44 @@ LabelPrinter::LabelPrinter(const LabelPrinterParams &params, QObject *parent)
     restClient->setScheme(QStringLiteral("http"));
     restClient->setHost(params.printerHost.isEmpty() ? QStringLiteral("127.0.0.1") : params.printerHost);
     restClient->setPort(params.printerPort);
-    d->labelPrinterApi = new Proof::NetworkServices::LprPrinterApi(restClient, this);
+    labelPrinterApi = new Proof::NetworkServices::LprPrinterApi(restClient, q);
 }
 
-LabelPrinter::~LabelPrinter()
-{}
+FutureSP<bool> LabelPrinterPrivate::printDirectly(const QByteArray &label, bool ignorePrinterState) const
+{
+    //Printer could be reset or replaced, so its forms will be uploaded again next time
+    const QString key = printerKey();
+    return sendToTransport(label, ignorePrinterState)
+        ->onSuccess([key](bool printed) {
+            if (!printed)
+                residentForms->clear(key);
+        })
+        ->onFailure([key](const Failure &) { residentForms->clear(key); });
+}
 
-FutureSP<bool> LabelPrinter::printLabel(const QByteArray &label, bool ignorePrinterState) const
+FutureSP<bool> LabelPrinterPrivate::sendToTransport(const QByteArray &label, bool ignorePrinterState) const
 {
-    Q_D_CONST(LabelPrinter);
+    //Raw port gives no way to ask printer about its state without sending something, so it is never checked here
+    if (rawSocketPrinter)
+        return rawSocketPrinter->printRawData(label);
 #ifndef Q_OS_ANDROID
-    if (d->hardwareLabelPrinter)
-        return d->hardwareLabelPrinter->printRawData(label, ignorePrinterState);
+    if (hardwareLabelPrinter)
+        return hardwareLabelPrinter->printRawData(label, ignorePrinterState);
 #else
     Q_UNUSED(ignorePrinterState)
 #endif
-    return d->labelPrinterApi->printLabel(label, d->params.printerName);
+    return labelPrinterApi->printLabel(label, params.printerName);
 }
 
-FutureSP<bool> LabelPrinter::printerIsReady() const
+FutureSP<bool> LabelPrinterPrivate::checkTransportReadiness() const
 {
-    Q_D_CONST(LabelPrinter);
+    if (rawSocketPrinter)
+        return rawSocketPrinter->printerIsReady();
 #ifndef Q_OS_ANDROID
-    if (d->hardwareLabelPrinter)
-        return d->hardwareLabelPrinter->printerIsReady();
+    if (hardwareLabelPrinter)
+        return hardwareLabelPrinter->printerIsReady();
 #endif
-    return d->labelPrinterApi->fetchStatus(d->params.printerName)->map([](const auto &status) -> bool {
+    return labelPrinterApi->fetchStatus(params.printerName)->map([](const auto &status) -> bool {
         if (status.isReady)
             return true;
         else
@@ -102,8 +297,17 @@ FutureSP<bool> LabelPrinter::printerIsReady() const
     });
 }
 
-QString LabelPrinter::title() const
+QString LabelPrinterPrivate::printerKey() const
 {
-    Q_D_CONST(LabelPrinter);
-    return d->params.printerTitle;
+    //Describes where labels really go, so same printer reached through different transports is not mixed up
+    if (rawSocketPrinter)
+        return QStringLiteral("raw:%1:%2").arg(params.printerHost).arg(params.rawSocketPort);
+#ifndef Q_OS_ANDROID
+    if (hardwareLabelPrinter && params.nativeLpd)
+        return QStringLiteral("lpd:%1:%2/%3").arg(params.printerHost).arg(params.lpdPort).arg(params.printerName);
+    if (hardwareLabelPrinter)
+        return QStringLiteral("lpr:%1/%2").arg(params.printerHost, params.printerName);
+#endif
+    const QString serviceHost = params.printerHost.isEmpty() ? QStringLiteral("127.0.0.1") : params.printerHost;
+    return QStringLiteral("service:%1:%2/%3").arg(serviceHost).arg(params.printerPort).arg(params.printerName);
 }
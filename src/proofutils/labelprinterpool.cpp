@@ -0,0 +1,266 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "proofutils/labelprinterpool.h"
+
+#include "proofcore/proofobject_p.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSet>
+#include <QTimer>
+
+#include <atomic>
+
+static const int DEFAULT_FAILOVER_COOLDOWN = 10000;
+
+namespace Proof {
+struct PooledPrinter
+{
+    LabelPrinter *printer = nullptr;
+    int queueDepth = 0;
+    qint64 averageLatency = 0;
+    //-1 if printer is available, otherwise time of its last failure
+    qint64 failedAt = -1;
+    bool healthCheckInProgress = false;
+};
+
+class LabelPrinterPoolPrivate : public ProofObjectPrivate
+{
+    Q_DECLARE_PUBLIC(LabelPrinterPool)
+
+    int reservePrinter(const QSet<int> &tried) const;
+    void printWithFailover(const QByteArray &label, bool ignorePrinterState, QSet<int> tried,
+                           const PromiseSP<bool> &promise, const Failure &lastFailure) const;
+    void jobFinished(int index, qint64 startedAt, bool succeeded) const;
+    bool isAvailable(const PooledPrinter &pooled, qint64 now) const;
+    void checkUnavailablePrinters();
+
+    mutable QMutex mutex;
+    mutable QVector<PooledPrinter> printers;
+    mutable int nextStart = 0;
+    QElapsedTimer clock;
+    std::atomic<int> failoverCooldown{DEFAULT_FAILOVER_COOLDOWN};
+    QTimer *healthChecker = nullptr;
+};
+} // namespace Proof
+
+using namespace Proof;
+
+LabelPrinterPool::LabelPrinterPool(const QVector<LabelPrinterParams> &params, QObject *parent)
+    : ProofObject(*new LabelPrinterPoolPrivate, parent)
+{
+    Q_D(LabelPrinterPool);
+    d->clock.start();
+    d->printers.reserve(params.count());
+    for (LabelPrinterParams printerParams : params) {
+        //Spooled printer never fails, so pool would never fail over from it
+        if (!printerParams.spoolDirectory.isEmpty()) {
+            qCWarning(proofUtilsMiscLog) << "Printer" << printerParams.printerTitle
+                                         << "is used in pool, so its spool is not used";
+            printerParams.spoolDirectory.clear();
+        }
+        PooledPrinter pooled;
+        pooled.printer = new LabelPrinter(printerParams, this);
+        d->printers << pooled;
+    }
+}
+
+int LabelPrinterPool::printersCount() const
+{
+    Q_D_CONST(LabelPrinterPool);
+    return d->printers.count();
+}
+
+QString LabelPrinterPool::printerTitle(int index) const
+{
+    Q_D_CONST(LabelPrinterPool);
+    return index >= 0 && index < d->printers.count() ? d->printers[index].printer->title() : QString();
+}
+
+int LabelPrinterPool::queueDepth(int index) const
+{
+    Q_D_CONST(LabelPrinterPool);
+    QMutexLocker lock(&d->mutex);
+    return index >= 0 && index < d->printers.count() ? d->printers[index].queueDepth : 0;
+}
+
+qint64 LabelPrinterPool::averageLatency(int index) const
+{
+    Q_D_CONST(LabelPrinterPool);
+    QMutexLocker lock(&d->mutex);
+    return index >= 0 && index < d->printers.count() ? d->printers[index].averageLatency : 0;
+}
+
+bool LabelPrinterPool::isPrinterAvailable(int index) const
+{
+    Q_D_CONST(LabelPrinterPool);
+    QMutexLocker lock(&d->mutex);
+    return index >= 0 && index < d->printers.count() && d->isAvailable(d->printers[index], d->clock.elapsed());
+}
+
+int LabelPrinterPool::failoverCooldown() const
+{
+    Q_D_CONST(LabelPrinterPool);
+    return d->failoverCooldown;
+}
+
+void LabelPrinterPool::setFailoverCooldown(int msecs)
+{
+    Q_D(LabelPrinterPool);
+    d->failoverCooldown = qMax(0, msecs);
+}
+
+int LabelPrinterPool::healthCheckInterval() const
+{
+    Q_D_CONST(LabelPrinterPool);
+    return d->healthChecker && d->healthChecker->isActive() ? d->healthChecker->interval() : 0;
+}
+
+void LabelPrinterPool::setHealthCheckInterval(int msecs)
+{
+    Q_D(LabelPrinterPool);
+    if (msecs <= 0) {
+        if (d->healthChecker)
+            d->healthChecker->stop();
+        return;
+    }
+    if (!d->healthChecker) {
+        d->healthChecker = new QTimer(this);
+        connect(d->healthChecker, &QTimer::timeout, this, [d] { d->checkUnavailablePrinters(); });
+    }
+    d->healthChecker->start(msecs);
+}
+
+FutureSP<bool> LabelPrinterPool::printLabel(const QByteArray &label, bool ignorePrinterState) const
+{
+    Q_D_CONST(LabelPrinterPool);
+    Failure noPrinters(QStringLiteral("No printers configured"), UTILS_MODULE_CODE, UtilsErrorCode::LabelPrinterError);
+    if (d->printers.isEmpty())
+        return Future<bool>::fail(noPrinters);
+    PromiseSP<bool> promise = PromiseSP<bool>::create();
+    d->printWithFailover(label, ignorePrinterState, QSet<int>(), promise, noPrinters);
+    return promise->future();
+}
+
+int LabelPrinterPoolPrivate::reservePrinter(const QSet<int> &tried) const
+{
+    QMutexLocker lock(&mutex);
+    qint64 now = clock.elapsed();
+    int chosen = -1;
+    int fallback = -1;
+    //Scan starts after last chosen printer, so equally loaded printers are used in turn
+    for (int i = 0; i < printers.count(); ++i) {
+        int index = (nextStart + i) % printers.count();
+        if (tried.contains(index))
+            continue;
+        const PooledPrinter &candidate = printers[index];
+        if (!isAvailable(candidate, now)) {
+            //If all printers are down, label still goes to the one that failed earliest instead of failing at once.
+            //It is done only for first attempt, failover never goes to unavailable printers.
+            if (tried.isEmpty() && (fallback < 0 || candidate.failedAt < printers[fallback].failedAt))
+                fallback = index;
+            continue;
+        }
+        if (chosen < 0 || candidate.queueDepth < printers[chosen].queueDepth
+            || (candidate.queueDepth == printers[chosen].queueDepth
+                && candidate.averageLatency < printers[chosen].averageLatency)) {
+            chosen = index;
+        }
+    }
+    if (chosen < 0)
+        chosen = fallback;
+    if (chosen >= 0) {
+        ++printers[chosen].queueDepth;
+        nextStart = (chosen + 1) % printers.count();
+    }
+    return chosen;
+}
+
+void LabelPrinterPoolPrivate::printWithFailover(const QByteArray &label, bool ignorePrinterState, QSet<int> tried,
+                                                const PromiseSP<bool> &promise, const Failure &lastFailure) const
+{
+    int index = reservePrinter(tried);
+    if (index < 0) {
+        promise->failure(lastFailure);
+        return;
+    }
+    tried << index;
+    qint64 startedAt = clock.elapsed();
+    printers[index]
+        .printer->printLabel(label, ignorePrinterState)
+        ->onSuccess([this, index, startedAt, promise](bool result) {
+            jobFinished(index, startedAt, true);
+            promise->success(result);
+        })
+        ->onFailure([this, index, startedAt, label, ignorePrinterState, tried, promise](const Failure &failure) {
+            jobFinished(index, startedAt, false);
+            qCWarning(proofUtilsMiscLog) << "Printer" << printers[index].printer->title()
+                                         << "failed, trying next one:" << failure.message;
+            printWithFailover(label, ignorePrinterState, tried, promise, failure);
+        });
+}
+
+void LabelPrinterPoolPrivate::jobFinished(int index, qint64 startedAt, bool succeeded) const
+{
+    QMutexLocker lock(&mutex);
+    PooledPrinter &pooled = printers[index];
+    --pooled.queueDepth;
+    qint64 now = clock.elapsed();
+    if (!succeeded) {
+        pooled.failedAt = now;
+        return;
+    }
+    qint64 latency = qMax(now - startedAt, 1ll);
+    pooled.averageLatency = pooled.averageLatency ? (pooled.averageLatency * 7 + latency) / 8 : latency;
+    pooled.failedAt = -1;
+}
+
+bool LabelPrinterPoolPrivate::isAvailable(const PooledPrinter &pooled, qint64 now) const
+{
+    return pooled.failedAt < 0 || now - pooled.failedAt >= failoverCooldown;
+}
+
+void LabelPrinterPoolPrivate::checkUnavailablePrinters()
+{
+    QMutexLocker lock(&mutex);
+    for (int i = 0; i < printers.count(); ++i) {
+        PooledPrinter &pooled = printers[i];
+        if (pooled.failedAt < 0 || pooled.healthCheckInProgress)
+            continue;
+        pooled.healthCheckInProgress = true;
+        lock.unlock();
+        pooled.printer->printerIsReady()
+            ->onSuccess([this, i](bool) {
+                QMutexLocker lock(&mutex);
+                printers[i].failedAt = -1;
+                printers[i].healthCheckInProgress = false;
+            })
+            ->onFailure([this, i](const Failure &) {
+                QMutexLocker lock(&mutex);
+                printers[i].healthCheckInProgress = false;
+            });
+        lock.relock();
+    }
+}
@@ -0,0 +1,336 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "proofutils/lpdclient.h"
+
+#include "proofseed/tasks.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QHostInfo>
+#include <QTcpSocket>
+
+//Protocol description: https://tools.ietf.org/html/rfc1179
+
+namespace Proof {
+namespace Hardware {
+class LpdClientPrivate
+{
+    Q_DECLARE_PUBLIC(LpdClient)
+    LpdClient *q_ptr = nullptr;
+
+    QString restrictor() const;
+
+    QString host;
+    QString queue;
+    quint16 port = LpdClient::DEFAULT_PORT;
+    int timeout = 10000;
+};
+} // namespace Hardware
+} // namespace Proof
+
+using namespace Proof;
+using namespace Proof::Hardware;
+
+namespace {
+constexpr char RECEIVE_JOB_COMMAND = '\x02';
+constexpr char SHORT_QUEUE_STATE_COMMAND = '\x03';
+constexpr char LONG_QUEUE_STATE_COMMAND = '\x04';
+constexpr char RECEIVE_CONTROL_FILE_SUBCOMMAND = '\x02';
+constexpr char RECEIVE_DATA_FILE_SUBCOMMAND = '\x03';
+constexpr qint64 FILE_CHUNK_SIZE = 64 * 1024;
+constexpr int MAX_HOST_NAME_LENGTH = 31;
+
+QAtomicInt jobsCounter;
+
+//Blocking LPD conversation, lives only inside a single task
+class LpdSession
+{
+public:
+    LpdSession(const QString &host, quint16 port, int timeout) : host(host), port(port), timeout(timeout) {}
+
+    bool open()
+    {
+        socket.connectToHost(host, port);
+        if (socket.waitForConnected(timeout))
+            return true;
+        return fail(QStringLiteral("Can't connect to LPD at %1:%2.\n%3").arg(host).arg(port).arg(socket.errorString()),
+                    UtilsErrorCode::LpdConnectionError);
+    }
+
+    bool sendCommand(char command, const QByteArray &operands)
+    {
+        QByteArray line;
+        line.reserve(operands.size() + 2);
+        line.append(command).append(operands).append('\n');
+        return write(line);
+    }
+
+    bool write(const char *data, qint64 size)
+    {
+        while (size > 0) {
+            qint64 written = socket.write(data, size);
+            if (written < 0)
+                return fail(QStringLiteral("Can't send data to LPD.\n%1").arg(socket.errorString()),
+                            UtilsErrorCode::LpdConnectionError);
+            data += written;
+            size -= written;
+        }
+        while (socket.bytesToWrite()) {
+            if (!socket.waitForBytesWritten(timeout))
+                return fail(QStringLiteral("Can't send data to LPD.\n%1").arg(socket.errorString()),
+                            UtilsErrorCode::LpdConnectionError);
+        }
+        return true;
+    }
+
+    bool write(const QByteArray &data) { return write(data.constData(), data.size()); }
+
+    bool write(QIODevice *device)
+    {
+        QByteArray chunk;
+        while (!device->atEnd()) {
+            chunk = device->read(FILE_CHUNK_SIZE);
+            if (chunk.isEmpty())
+                return fail(QStringLiteral("Can't read file.\n%1").arg(device->errorString()),
+                            UtilsErrorCode::FileCannotBeRead);
+            if (!write(chunk))
+                return false;
+        }
+        return true;
+    }
+
+    bool waitForAck()
+    {
+        if (!socket.bytesAvailable() && !socket.waitForReadyRead(timeout))
+            return fail(QStringLiteral("LPD didn't acknowledge request.\n%1").arg(socket.errorString()),
+                        UtilsErrorCode::LpdProtocolError);
+        char ack = 1;
+        socket.getChar(&ack);
+        if (ack != '\0')
+            return fail(QStringLiteral("LPD rejected request with code %1").arg(static_cast<int>(ack)),
+                        UtilsErrorCode::LpdProtocolError);
+        return true;
+    }
+
+    QByteArray readAll()
+    {
+        QByteArray result;
+        while (socket.state() == QAbstractSocket::ConnectedState && socket.waitForReadyRead(timeout))
+            result.append(socket.readAll());
+        result.append(socket.readAll());
+        return result;
+    }
+
+    void close()
+    {
+        socket.disconnectFromHost();
+        if (socket.state() != QAbstractSocket::UnconnectedState)
+            socket.waitForDisconnected(timeout);
+    }
+
+    bool fail(const QString &message, long code)
+    {
+        qCWarning(proofUtilsLprPrinterInfoLog) << "LPD" << host << port << message;
+        errorMessage = message;
+        errorCode = code;
+        return false;
+    }
+
+    QString errorMessage;
+    long errorCode = UtilsErrorCode::UnknownError;
+
+private:
+    QTcpSocket socket;
+    QString host;
+    quint16 port;
+    int timeout;
+};
+
+QByteArray localHostName()
+{
+    QByteArray result = QHostInfo::localHostName().toLatin1().left(MAX_HOST_NAME_LENGTH);
+    return result.isEmpty() ? QByteArrayLiteral("localhost") : result;
+}
+
+QByteArray userName()
+{
+    QByteArray result = qgetenv("USER");
+    if (result.isEmpty())
+        result = qgetenv("USERNAME");
+    return result.isEmpty() ? QByteArrayLiteral("proof") : result;
+}
+
+QByteArray controlFile(const QByteArray &hostName, const QByteArray &dataFileName, const QString &jobName,
+                       unsigned int copies)
+{
+    QByteArray name = jobName.toUtf8().left(99);
+    QByteArray result;
+    result.append('H').append(hostName).append('\n');
+    result.append('P').append(userName()).append('\n');
+    if (!name.isEmpty())
+        result.append('J').append(name).append('\n');
+    for (unsigned int i = 0; i < qMax(copies, 1u); ++i)
+        result.append('l').append(dataFileName).append('\n');
+    result.append('U').append(dataFileName).append('\n');
+    if (!name.isEmpty())
+        result.append('N').append(name).append('\n');
+    return result;
+}
+
+//Both control and data files are sent inside one job, data is written by writer callback after subcommand is accepted
+template <typename Writer>
+bool sendJob(LpdSession &session, const QString &queue, qint64 dataSize, const QString &jobName, unsigned int copies,
+             Writer &&writeData)
+{
+    const QByteArray hostName = localHostName();
+    const QByteArray jobNumber = QByteArray::number(jobsCounter.fetchAndAddRelaxed(1) % 1000).rightJustified(3, '0');
+    const QByteArray dataFileName = "dfA" + jobNumber + hostName;
+    const QByteArray controlFileName = "cfA" + jobNumber + hostName;
+    const QByteArray control = controlFile(hostName, dataFileName, jobName, copies);
+
+    return session.open() && session.sendCommand(RECEIVE_JOB_COMMAND, queue.toUtf8()) && session.waitForAck()
+           && session.sendCommand(RECEIVE_CONTROL_FILE_SUBCOMMAND,
+                                  QByteArray::number(control.size()) + ' ' + controlFileName)
+           && session.waitForAck() && session.write(control) && session.write(QByteArray(1, '\0'))
+           && session.waitForAck()
+           && session.sendCommand(RECEIVE_DATA_FILE_SUBCOMMAND, QByteArray::number(dataSize) + ' ' + dataFileName)
+           && session.waitForAck() && writeData() && session.write(QByteArray(1, '\0')) && session.waitForAck();
+}
+} // namespace
+
+LpdClient::LpdClient(const QString &host, const QString &queue, quint16 port) : d_ptr(new LpdClientPrivate)
+{
+    d_ptr->q_ptr = this;
+    d_ptr->host = host.trimmed().isEmpty() ? QStringLiteral("127.0.0.1") : host.trimmed();
+    d_ptr->queue = queue.trimmed();
+    d_ptr->port = port;
+}
+
+LpdClient::~LpdClient()
+{}
+
+QString LpdClient::host() const
+{
+    Q_D_CONST(LpdClient);
+    return d->host;
+}
+
+QString LpdClient::queue() const
+{
+    Q_D_CONST(LpdClient);
+    return d->queue;
+}
+
+quint16 LpdClient::port() const
+{
+    Q_D_CONST(LpdClient);
+    return d->port;
+}
+
+int LpdClient::timeout() const
+{
+    Q_D_CONST(LpdClient);
+    return d->timeout;
+}
+
+void LpdClient::setTimeout(int msecs)
+{
+    Q_D(LpdClient);
+    d->timeout = msecs;
+}
+
+FutureSP<bool> LpdClient::printRawData(const QByteArray &data, unsigned int copies, const QString &jobName) const
+{
+    Q_D_CONST(LpdClient);
+    QString host = d->host;
+    QString queue = d->queue;
+    quint16 port = d->port;
+    int timeout = d->timeout;
+    return tasks::run(tasks::RestrictionType::ThreadBound, d->restrictor(),
+                      [host, queue, port, timeout, data, copies, jobName]() -> bool {
+                          LpdSession session(host, port, timeout);
+                          bool result = sendJob(session, queue, data.size(), jobName, copies,
+                                                [&session, &data]() { return session.write(data); });
+                          session.close();
+                          if (!result)
+                              return WithFailure(session.errorMessage, UTILS_MODULE_CODE, session.errorCode);
+                          qCDebug(proofUtilsLprPrinterInfoLog) << "Raw data sent to LPD" << queue << "at" << host;
+                          return true;
+                      });
+}
+
+FutureSP<bool> LpdClient::printFile(const QString &fileName, unsigned int copies) const
+{
+    Q_D_CONST(LpdClient);
+    QString host = d->host;
+    QString queue = d->queue;
+    quint16 port = d->port;
+    int timeout = d->timeout;
+    return tasks::run(tasks::RestrictionType::ThreadBound, d->restrictor(),
+                      [host, queue, port, timeout, fileName, copies]() -> bool {
+                          QFile file(fileName);
+                          if (!file.open(QIODevice::ReadOnly)) {
+                              return WithFailure(QStringLiteral("Printing aborted.\nCan't open file %1").arg(fileName),
+                                                 UTILS_MODULE_CODE, UtilsErrorCode::FileCannotBeRead);
+                          }
+                          LpdSession session(host, port, timeout);
+                          bool result = sendJob(session, queue, file.size(), QFileInfo(fileName).fileName(), copies,
+                                                [&session, &file]() { return session.write(&file); });
+                          session.close();
+                          if (!result)
+                              return WithFailure(session.errorMessage, UTILS_MODULE_CODE, session.errorCode);
+                          qCDebug(proofUtilsLprPrinterInfoLog) << "File sent to LPD" << queue << "at" << host;
+                          return true;
+                      });
+}
+
+FutureSP<QString> LpdClient::fetchQueueState(bool verbose) const
+{
+    Q_D_CONST(LpdClient);
+    QString host = d->host;
+    QString queue = d->queue;
+    quint16 port = d->port;
+    int timeout = d->timeout;
+    return tasks::run(tasks::RestrictionType::ThreadBound, d->restrictor(),
+                      [host, queue, port, timeout, verbose]() -> QString {
+                          LpdSession session(host, port, timeout);
+                          if (!session.open()
+                              || !session.sendCommand(verbose ? LONG_QUEUE_STATE_COMMAND : SHORT_QUEUE_STATE_COMMAND,
+                                                      queue.toUtf8())) {
+                              session.close();
+                              return WithFailure(session.errorMessage, UTILS_MODULE_CODE, session.errorCode);
+                          }
+                          QString result = QString::fromUtf8(session.readAll());
+                          session.close();
+                          qCDebug(proofUtilsLprPrinterDataLog)
+                              << "LPD queue state for" << queue << host << ":" << result;
+                          return result;
+                      });
+}
+
+QString LpdClientPrivate::restrictor() const
+{
+    return QStringLiteral("__Proof_Lpd_%1@%2:%3").arg(queue, host).arg(port);
+}
@@ -29,12 +29,18 @@
 #include "proofcore/proofobject_p.h"
 
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QMutex>
 #include <QProcess>
+#include <QQueue>
 #include <QThread>
+#include <QTimer>
+
+#include <atomic>
+#include <functional>
 
 static const QString EMPTY_PRINTER_TEXT = QStringLiteral("Printing aborted.\n Empty printer.");
-static const QString RESTRICTOR = QStringLiteral("__Proof_Lpr");
 
 namespace Proof {
 namespace Hardware {
@@ -46,11 +52,131 @@ class LprPrinterPrivate : public ProofObjectPrivate
     FutureSP<bool> printFile(const QString &fileName, unsigned int quantity, bool ignorePrinterState) const;
 
     FutureSP<bool> printerIsReady() const;
+    FutureSP<bool> checkPrinterIsReady() const;
     FutureSP<bool> checkLpOptions() const;
+    FutureSP<bool> runProcessTask(const std::function<bool()> &task) const;
+    bool checkQueueInfo(QString queueInfo, const QString &errorOutput, Failure &failure) const;
+    Failure notReadyFailure() const;
+
+    void pollReadiness();
+    void storeReadiness(quint64 generation) const;
+    void invalidateReadiness() const;
 
     QString printerName;
     QString printerHost;
+    QString restrictor;
     bool strictPrinterCheck = false;
+    QScopedPointer<LpdClient> lpdClient;
+
+    //Only positive check results are cached, so failed printer is rechecked on each request.
+    //Invalidation bumps generation, so check started before it can't store its result afterwards
+    QElapsedTimer readinessClock;
+    mutable QMutex readinessMutex;
+    mutable quint64 readinessGeneration = 0;
+    mutable std::atomic<qint64> readinessCheckedAt{-1};
+    std::atomic<int> readinessCacheTtl{0};
+    std::atomic<bool> readinessPollInProgress{false};
+    QTimer *readinessPoller = nullptr;
+};
+
+//Each printer has its own thread, but amount of lpr/lpq/lpoptions processes running at once can be capped.
+//Tasks that don't fit into limit are queued and started when slot frees, so no pool thread waits for a slot.
+//Queued tasks belong to printer that created them and are dropped when this printer is destroyed.
+class ProcessesLimiter
+{
+public:
+    void acquire(const LprPrinterPrivate *owner, const PromiseSP<bool> &promise, const std::function<void()> &starter)
+    {
+        {
+            QMutexLocker lock(&mutex);
+            if (limit > 0 && running >= limit) {
+                waiting.enqueue(WaitingTask{owner, promise, starter});
+                return;
+            }
+            ++running;
+        }
+        starter();
+    }
+
+    void release()
+    {
+        std::function<void()> next;
+        {
+            QMutexLocker lock(&mutex);
+            //Slot is handed over to next waiting task if limit is not exceeded
+            if (!waiting.isEmpty() && (limit <= 0 || running <= limit))
+                next = waiting.dequeue().starter;
+            else
+                --running;
+        }
+        if (next)
+            next();
+    }
+
+    void dropWaiting(const LprPrinterPrivate *owner)
+    {
+        QVector<PromiseSP<bool>> dropped;
+        {
+            QMutexLocker lock(&mutex);
+            for (auto it = waiting.begin(); it != waiting.end();) {
+                if (it->owner == owner) {
+                    dropped << it->promise;
+                    it = waiting.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        for (const auto &promise : qAsConst(dropped)) {
+            promise->failure(Failure(QStringLiteral("Printing aborted.\nPrinter was removed."), UTILS_MODULE_CODE,
+                                     UtilsErrorCode::LprCannotBeStarted));
+        }
+    }
+
+    int maxRunning()
+    {
+        QMutexLocker lock(&mutex);
+        return limit;
+    }
+
+    void setMaxRunning(int count)
+    {
+        QVector<std::function<void()>> ready;
+        {
+            QMutexLocker lock(&mutex);
+            limit = qMax(count, 0);
+            while (!waiting.isEmpty() && (limit <= 0 || running < limit)) {
+                ++running;
+                ready << waiting.dequeue().starter;
+            }
+        }
+        for (const auto &starter : qAsConst(ready))
+            starter();
+    }
+
+private:
+    struct WaitingTask
+    {
+        const LprPrinterPrivate *owner;
+        PromiseSP<bool> promise;
+        std::function<void()> starter;
+    };
+
+    QMutex mutex;
+    QQueue<WaitingTask> waiting;
+    int running = 0;
+    int limit = 0;
+};
+Q_GLOBAL_STATIC(ProcessesLimiter, processesLimiter)
+
+//Frees slot taken for task when task is finished
+class ProcessSlot
+{
+public:
+    ProcessSlot() = default;
+    ~ProcessSlot() { processesLimiter->release(); }
+    ProcessSlot(const ProcessSlot &) = delete;
+    ProcessSlot &operator=(const ProcessSlot &) = delete;
 };
 } // namespace Hardware
 } // namespace Proof
@@ -79,21 +205,96 @@ LprPrinter::LprPrinter(const QString &printerHost, const QString &printerName, b
     d->printerName = printerName.trimmed();
     d->printerHost = printerHost.trimmed();
     d->strictPrinterCheck = strictPrinterCheck;
+    d->restrictor = QStringLiteral("__Proof_Lpr_%1@%2").arg(d->printerName, d->printerHost);
+    d->readinessClock.start();
     qCDebug(proofUtilsLprPrinterInfoLog) << "Label printer name:" << printerName << "at host" << printerHost;
     if (printerHost.isEmpty() && printerName.isEmpty())
         qCWarning(proofUtilsLprPrinterInfoLog) << QStringLiteral("Empty printer!");
 }
 
+LprPrinter::~LprPrinter()
+{
+    Q_D(LprPrinter);
+    if (!processesLimiter.isDestroyed())
+        processesLimiter->dropWaiting(d);
+}
+
+int LprPrinter::maxConcurrentProcesses()
+{
+    return processesLimiter->maxRunning();
+}
+
+void LprPrinter::setMaxConcurrentProcesses(int count)
+{
+    processesLimiter->setMaxRunning(count);
+}
+
+bool LprPrinter::usesNativeLpd() const
+{
+    Q_D_CONST(LprPrinter);
+    return !d->lpdClient.isNull();
+}
+
+void LprPrinter::setUseNativeLpd(bool useNativeLpd, quint16 lpdPort)
+{
+    Q_D(LprPrinter);
+    if (useNativeLpd)
+        d->lpdClient.reset(new LpdClient(d->printerHost, d->printerName, lpdPort));
+    else
+        d->lpdClient.reset();
+}
+
+int LprPrinter::readinessCacheTtl() const
+{
+    Q_D_CONST(LprPrinter);
+    return d->readinessCacheTtl;
+}
+
+void LprPrinter::setReadinessCacheTtl(int msecs)
+{
+    Q_D(LprPrinter);
+    d->readinessCacheTtl = qMax(msecs, 0);
+}
+
+int LprPrinter::readinessPollingInterval() const
+{
+    Q_D_CONST(LprPrinter);
+    return d->readinessPoller && d->readinessPoller->isActive() ? d->readinessPoller->interval() : 0;
+}
+
+void LprPrinter::setReadinessPollingInterval(int msecs)
+{
+    Q_D(LprPrinter);
+    if (msecs <= 0) {
+        if (d->readinessPoller)
+            d->readinessPoller->stop();
+        return;
+    }
+    if (!d->readinessPoller) {
+        d->readinessPoller = new QTimer(this);
+        connect(d->readinessPoller, &QTimer::timeout, this, [d] { d->pollReadiness(); });
+    }
+    d->readinessPoller->start(msecs);
+}
+
+void LprPrinter::invalidateReadinessCache()
+{
+    Q_D(LprPrinter);
+    d->invalidateReadiness();
+}
+
 FutureSP<bool> LprPrinter::printRawData(const QByteArray &data, bool ignorePrinterState) const
 {
     Q_D_CONST(LprPrinter);
-    return d->printRawData(data, ignorePrinterState);
+    return d->printRawData(data, ignorePrinterState)->onFailure([d](const Failure &) { d->invalidateReadiness(); });
 }
 
 FutureSP<bool> LprPrinter::printFile(const QString &fileName, unsigned int quantity, bool ignorePrinterState) const
 {
     Q_D_CONST(LprPrinter);
-    return d->printFile(fileName, quantity, ignorePrinterState);
+    return d->printFile(fileName, quantity, ignorePrinterState)->onFailure([d](const Failure &) {
+        d->invalidateReadiness();
+    });
 }
 
 FutureSP<bool> LprPrinter::printerIsReady() const
@@ -105,8 +306,10 @@ FutureSP<bool> LprPrinter::printerIsReady() const
 FutureSP<bool> LprPrinterPrivate::printRawData(const QByteArray &data, bool ignorePrinterState) const
 {
     FutureSP<bool> status = ignorePrinterState ? Future<>::successful(true) : printerIsReady();
+    if (lpdClient)
+        return status->andThen([this, data] { return lpdClient->printRawData(data); });
     return status->andThen([this, data] {
-        return tasks::run(tasks::RestrictionType::ThreadBound, RESTRICTOR, [this, data]() -> bool {
+        return runProcessTask([this, data]() -> bool {
             QScopedPointer<QProcess> printProcess(new QProcess);
 
             QStringList args;
@@ -122,7 +325,8 @@ FutureSP<bool> LprPrinterPrivate::printRawData(const QByteArray &data, bool igno
 
 #ifdef Q_OS_WIN
             QFile printFile;
-            printFile.setFileName(QStringLiteral("%1/proof_last_label_to_print").arg(QDir::tempPath()));
+            printFile.setFileName(
+                QStringLiteral("%1/proof_last_label_to_print_%2").arg(QDir::tempPath()).arg(qHash(restrictor)));
             if (!printFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
                 qCWarning(proofUtilsLprPrinterInfoLog) << "Can't open temporary file";
                 return WithFailure(QStringLiteral("Printing aborted.\nCan't open temporary file."), UTILS_MODULE_CODE,
@@ -171,8 +375,10 @@ FutureSP<bool> LprPrinterPrivate::printRawData(const QByteArray &data, bool igno
 FutureSP<bool> LprPrinterPrivate::printFile(const QString &fileName, unsigned int quantity, bool ignorePrinterState) const
 {
     FutureSP<bool> status = ignorePrinterState ? Future<>::successful(true) : printerIsReady();
+    if (lpdClient)
+        return status->andThen([this, fileName, quantity] { return lpdClient->printFile(fileName, quantity); });
     return status->andThen([this, fileName, quantity] {
-        return tasks::run(tasks::RestrictionType::ThreadBound, RESTRICTOR, [this, fileName, quantity]() -> bool {
+        return runProcessTask([this, fileName, quantity]() -> bool {
 #ifdef Q_OS_WIN
             unsigned int qty = quantity;
             while (qty--) {
@@ -226,12 +432,43 @@ FutureSP<bool> LprPrinterPrivate::printFile(const QString &fileName, unsigned in
 }
 
 FutureSP<bool> LprPrinterPrivate::printerIsReady() const
+{
+    const qint64 checkedAt = readinessCheckedAt;
+    if (readinessCacheTtl > 0 && checkedAt >= 0 && readinessClock.elapsed() - checkedAt < readinessCacheTtl)
+        return Future<>::successful(true);
+
+    quint64 generation = 0;
+    {
+        QMutexLocker lock(&readinessMutex);
+        generation = readinessGeneration;
+    }
+    return checkPrinterIsReady()
+        ->onSuccess([this, generation](bool) { storeReadiness(generation); })
+        ->onFailure([this](const Failure &) { invalidateReadiness(); });
+}
+
+FutureSP<bool> LprPrinterPrivate::checkPrinterIsReady() const
 {
     if (printerHost.isEmpty() && printerName.isEmpty()) {
         return Future<bool>::fail(Failure(EMPTY_PRINTER_TEXT, UTILS_MODULE_CODE, UtilsErrorCode::LpqCannotBeStarted));
     }
 
-    return tasks::run(tasks::RestrictionType::ThreadBound, RESTRICTOR, [this]() -> FutureSP<bool> {
+    if (lpdClient) {
+        //There is no lpoptions analogue in LPD, so queue state is the only thing we can check.
+        //RFC 1179 doesn't specify its format and daemons reply differently (even with nothing if queue is empty),
+        //so any reply means printer is reachable unless it explicitly says it is not ready
+        return lpdClient->fetchQueueState()->map([this](const QString &queueInfo) -> bool {
+            QString notReadyMarker = printerName.isEmpty() ? QStringLiteral("is not ready")
+                                                           : QStringLiteral("%1 is not ready").arg(printerName);
+            if (queueInfo.contains(notReadyMarker, Qt::CaseInsensitive)) {
+                qCWarning(proofUtilsLprPrinterInfoLog) << printerHost << printerName << "is not ready";
+                return WithFailure(notReadyFailure());
+            }
+            return true;
+        });
+    }
+
+    return runProcessTask([this]() -> bool {
         QScopedPointer<QProcess> queueProcess(new QProcess);
         QStringList args;
         if (!printerHost.isEmpty()) {
@@ -253,51 +490,9 @@ FutureSP<bool> LprPrinterPrivate::printerIsReady() const
             queueProcess->waitForReadyRead();
             queueProcess->waitForFinished();
             QString queueInfo = queueProcess->readAll().trimmed().toLower();
-            qCDebug(proofUtilsLprPrinterDataLog) << "Queue info for" << printerHost << printerName << ":" << queueInfo;
-            if (queueInfo.isEmpty()) {
-                QString errorOutput = queueProcess->readAllStandardError();
-                qCWarning(proofUtilsLprPrinterInfoLog) << "Queue info for" << printerHost << printerName
-                                                       << "is empty. Probably printer doesn't exist." << errorOutput;
-                return WithFailure(QStringLiteral(
-                                       "Can't query printer %1@%2 info.\nProbably this printer doesn't exist\n%3")
-                                       .arg(printerName.isEmpty() ? QStringLiteral("default") : printerName,
-                                            printerHost.isEmpty() ? QStringLiteral("localhost") : printerHost,
-                                            errorOutput),
-                                   UTILS_MODULE_CODE, UtilsErrorCode::PrinterInfoCannotBeQueried);
-            }
-
-            if (queueInfo.contains(QStringLiteral("%1 is not ready").arg(printerName.toLower()))) {
-                qCWarning(proofUtilsLprPrinterInfoLog) << printerHost << printerName << "is not ready";
-                return WithFailure(QString(QObject::tr("Printer \n%1@%2 is not ready."))
-                                       .arg(printerName.isEmpty() ? QStringLiteral("default") : printerName,
-                                            printerHost.isEmpty() ? QStringLiteral("localhost") : printerHost),
-                                   UTILS_MODULE_CODE, UtilsErrorCode::PrinterNotReady, Failure::UserFriendlyHint);
-            }
-
-            if (queueInfo.startsWith(QLatin1String("windows lpd"))) {
-                if (queueInfo.contains(QLatin1String("error:"))
-                    || (!printerName.isEmpty() && !queueInfo.contains(printerName.toLower()))) {
-                    qCWarning(proofUtilsLprPrinterInfoLog)
-                        << "Something is wrong with" << printerHost << printerName << ". Info:"
-                        << queueInfo.replace(QLatin1String("\n"), QLatin1String(" "))
-                               .replace(QLatin1String("\r"), QString());
-                    return WithFailure(QString(QObject::tr("Printer \n%1@%2 is not ready."))
-                                           .arg(printerName.isEmpty() ? QStringLiteral("default") : printerName,
-                                                printerHost.isEmpty() ? QStringLiteral("localhost") : printerHost),
-                                       UTILS_MODULE_CODE, UtilsErrorCode::PrinterNotReady, Failure::UserFriendlyHint);
-                }
-                qCWarning(proofUtilsLprPrinterInfoLog)
-                    << printerHost << printerName << "is hosted at Windows and probably is ready. Info:"
-                    << queueInfo.replace(QLatin1String("\n"), QLatin1String(" ")).replace(QLatin1String("\r"), QString());
-            } else if (!queueInfo.contains(QStringLiteral("%1 is ready").arg(printerName.toLower()))) {
-                qCWarning(proofUtilsLprPrinterInfoLog)
-                    << "Queue info for" << printerHost << printerName
-                    << "contains unrecognized info:" << queueInfo.replace(QLatin1String("\n"), QLatin1String(" "));
-                return WithFailure(QStringLiteral("Printer error.\nQueue info for %1@%2:\n%3")
-                                       .arg(printerName.isEmpty() ? QStringLiteral("default") : printerName,
-                                            printerHost.isEmpty() ? QStringLiteral("localhost") : printerHost, queueInfo),
-                                   UTILS_MODULE_CODE, UtilsErrorCode::PrinterInfoError);
-            }
+            Failure failure;
+            if (!checkQueueInfo(queueInfo, queueProcess->readAllStandardError(), failure))
+                return WithFailure(failure);
         } else {
             queueProcess->waitForFinished();
             qCWarning(proofUtilsLprPrinterInfoLog) << "lpq can't be started";
@@ -306,14 +501,103 @@ FutureSP<bool> LprPrinterPrivate::printerIsReady() const
                                    UtilsErrorCode::LpqCannotBeStarted);
             }
         }
-
+        return true;
+    })->andThen([this] {
+        //lpoptions task takes its own slot
         return checkLpOptions();
     });
 }
 
+bool LprPrinterPrivate::checkQueueInfo(QString queueInfo, const QString &errorOutput, Failure &failure) const
+{
+    qCDebug(proofUtilsLprPrinterDataLog) << "Queue info for" << printerHost << printerName << ":" << queueInfo;
+    if (queueInfo.isEmpty()) {
+        qCWarning(proofUtilsLprPrinterInfoLog) << "Queue info for" << printerHost << printerName
+                                               << "is empty. Probably printer doesn't exist." << errorOutput;
+        failure = Failure(QStringLiteral("Can't query printer %1@%2 info.\nProbably this printer doesn't exist\n%3")
+                              .arg(printerName.isEmpty() ? QStringLiteral("default") : printerName,
+                                   printerHost.isEmpty() ? QStringLiteral("localhost") : printerHost, errorOutput),
+                          UTILS_MODULE_CODE, UtilsErrorCode::PrinterInfoCannotBeQueried);
+        return false;
+    }
+
+    if (queueInfo.contains(QStringLiteral("%1 is not ready").arg(printerName.toLower()))) {
+        qCWarning(proofUtilsLprPrinterInfoLog) << printerHost << printerName << "is not ready";
+        failure = notReadyFailure();
+        return false;
+    }
+
+    if (queueInfo.startsWith(QLatin1String("windows lpd"))) {
+        if (queueInfo.contains(QLatin1String("error:"))
+            || (!printerName.isEmpty() && !queueInfo.contains(printerName.toLower()))) {
+            qCWarning(proofUtilsLprPrinterInfoLog)
+                << "Something is wrong with" << printerHost << printerName << ". Info:"
+                << queueInfo.replace(QLatin1String("\n"), QLatin1String(" ")).replace(QLatin1String("\r"), QString());
+            failure = notReadyFailure();
+            return false;
+        }
+        qCWarning(proofUtilsLprPrinterInfoLog)
+            << printerHost << printerName << "is hosted at Windows and probably is ready. Info:"
+            << queueInfo.replace(QLatin1String("\n"), QLatin1String(" ")).replace(QLatin1String("\r"), QString());
+    } else if (!queueInfo.contains(QStringLiteral("%1 is ready").arg(printerName.toLower()))) {
+        qCWarning(proofUtilsLprPrinterInfoLog) << "Queue info for" << printerHost << printerName
+                                               << "contains unrecognized info:"
+                                               << queueInfo.replace(QLatin1String("\n"), QLatin1String(" "));
+        failure = Failure(QStringLiteral("Printer error.\nQueue info for %1@%2:\n%3")
+                              .arg(printerName.isEmpty() ? QStringLiteral("default") : printerName,
+                                   printerHost.isEmpty() ? QStringLiteral("localhost") : printerHost, queueInfo),
+                          UTILS_MODULE_CODE, UtilsErrorCode::PrinterInfoError);
+        return false;
+    }
+    return true;
+}
+
+Failure LprPrinterPrivate::notReadyFailure() const
+{
+    return Failure(QString(QObject::tr("Printer \n%1@%2 is not ready."))
+                       .arg(printerName.isEmpty() ? QStringLiteral("default") : printerName,
+                            printerHost.isEmpty() ? QStringLiteral("localhost") : printerHost),
+                   UTILS_MODULE_CODE, UtilsErrorCode::PrinterNotReady, Failure::UserFriendlyHint);
+}
+
+void LprPrinterPrivate::pollReadiness()
+{
+    //Poll results are used only through cache
+    if (readinessCacheTtl <= 0 || readinessPollInProgress.exchange(true))
+        return;
+    quint64 generation = 0;
+    {
+        QMutexLocker lock(&readinessMutex);
+        generation = readinessGeneration;
+    }
+    checkPrinterIsReady()
+        ->onSuccess([this, generation](bool) {
+            storeReadiness(generation);
+            readinessPollInProgress = false;
+        })
+        ->onFailure([this](const Failure &) {
+            invalidateReadiness();
+            readinessPollInProgress = false;
+        });
+}
+
+void LprPrinterPrivate::storeReadiness(quint64 generation) const
+{
+    QMutexLocker lock(&readinessMutex);
+    if (generation == readinessGeneration)
+        readinessCheckedAt = readinessClock.elapsed();
+}
+
+void LprPrinterPrivate::invalidateReadiness() const
+{
+    QMutexLocker lock(&readinessMutex);
+    ++readinessGeneration;
+    readinessCheckedAt = -1;
+}
+
 FutureSP<bool> LprPrinterPrivate::checkLpOptions() const
 {
-    return tasks::run(tasks::RestrictionType::ThreadBound, RESTRICTOR, [this]() -> bool {
+    return runProcessTask([this]() -> bool {
         QScopedPointer<QProcess> optionsProcess(new QProcess);
         QStringList args;
         if (!printerHost.isEmpty())
@@ -373,3 +657,20 @@ FutureSP<bool> LprPrinterPrivate::checkLpOptions() const
         return true;
     });
 }
+
+FutureSP<bool> LprPrinterPrivate::runProcessTask(const std::function<bool()> &task) const
+{
+    PromiseSP<bool> promise = PromiseSP<bool>::create();
+    //Starter can be called from other printer thread, so it doesn't touch this object
+    const QString taskRestrictor = restrictor;
+    processesLimiter->acquire(this, promise, [taskRestrictor, task, promise] {
+        tasks::run(tasks::RestrictionType::ThreadBound, taskRestrictor,
+                   [task]() -> bool {
+                       ProcessSlot processSlot;
+                       return task();
+                   })
+            ->onSuccess([promise](bool result) { promise->success(result); })
+            ->onFailure([promise](const Failure &failure) { promise->failure(failure); });
+    });
+    return promise->future();
+}
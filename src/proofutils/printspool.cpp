@@ -0,0 +1,742 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "proofutils/printspool.h"
+
+#include "proofseed/tasks.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QEnableSharedFromThis>
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QThread>
+#include <QTimer>
+#include <QWaitCondition>
+#include <QtEndian>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#    include <io.h>
+#    include <windows.h>
+#else
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+namespace Proof {
+namespace {
+//Record is header (magic, payload size, payload checksum, all little-endian quint32) followed by payload.
+//Magic also tells if label should be sent without printer state check
+constexpr quint32 RECORD_MAGIC = 0x31505350;
+constexpr quint32 RECORD_IGNORING_STATE_MAGIC = 0x32505350;
+constexpr qint64 RECORD_HEADER_SIZE = 12;
+//Data file grows by zero-filled chunks, so it is not remapped on each append
+constexpr qint64 DATA_FILE_GROWTH = 1024 * 1024;
+constexpr int DEFAULT_RETRY_INTERVAL = 5000;
+constexpr qint64 DEFAULT_MAX_QUEUE_SIZE = 256 * 1024 * 1024;
+constexpr int DEFAULT_SYNC_GROUP_SIZE = 32;
+constexpr int DEFAULT_SYNC_INTERVAL = 1000;
+
+bool syncFile(QFile &file)
+{
+#ifdef Q_OS_WIN
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle())));
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+quint32 payloadChecksum(const uchar *data, qint64 size)
+{
+    return qChecksum(reinterpret_cast<const char *>(data), static_cast<uint>(size));
+}
+
+//Queue name can contain anything, so file name is built from its readable part and stable hash of it
+QString queueFileBaseName(const QString &queueName)
+{
+    QString readable = queueName;
+    for (QChar &c : readable) {
+        if (!c.isLetterOrNumber() && c != QLatin1Char('-') && c != QLatin1Char('_'))
+            c = QLatin1Char('_');
+    }
+    QByteArray hash = QCryptographicHash::hash(queueName.toUtf8(), QCryptographicHash::Md5).toHex().left(8);
+    return QStringLiteral("%1_%2").arg(readable.left(64), QString::fromLatin1(hash));
+}
+
+struct SpoolSettings
+{
+    explicit SpoolSettings(PrintSpool::SyncPolicy syncPolicy) : syncPolicy(syncPolicy) {}
+    const PrintSpool::SyncPolicy syncPolicy;
+    std::atomic<int> retryInterval{DEFAULT_RETRY_INTERVAL};
+    std::atomic<qint64> maxQueueSize{DEFAULT_MAX_QUEUE_SIZE};
+    std::atomic<int> syncGroupSize{DEFAULT_SYNC_GROUP_SIZE};
+    std::atomic<int> syncInterval{DEFAULT_SYNC_INTERVAL};
+};
+
+//Retries and grouped syncs are postponed with timers of separate thread, so no pool thread sleeps while printer
+//is offline
+class RetryTimers
+{
+public:
+    RetryTimers()
+    {
+        context.moveToThread(&thread);
+        thread.start();
+    }
+
+    ~RetryTimers()
+    {
+        thread.quit();
+        thread.wait();
+    }
+
+    void schedule(int delay, const std::function<void()> &callback)
+    {
+        QMetaObject::invokeMethod(
+            &context, [this, delay, callback] { QTimer::singleShot(delay, &context, callback); }, Qt::QueuedConnection);
+    }
+
+private:
+    QThread thread;
+    QObject context;
+};
+Q_GLOBAL_STATIC(RetryTimers, retryTimers)
+
+struct SpoolSender
+{
+    PrintSpool::Sender send;
+    QObject *context = nullptr;
+};
+
+//All methods except delivery helpers below require mutex to be locked.
+//Data file is mapped once and both read and written through this mapping, it is remapped only when file grows.
+//File can be longer than its records because of zero-filled space reserved for next ones.
+struct SpoolQueue : public QEnableSharedFromThis<SpoolQueue>
+{
+    bool open();
+    void close();
+    bool readRecord(qint64 offset, QByteArray *payload, bool *ignorePrinterState, qint64 &nextOffset) const;
+    bool append(const QByteArray &data, bool ignorePrinterState, Failure &failure);
+    bool reserve(qint64 size);
+    bool map();
+    void truncate(qint64 size);
+    void advance(qint64 nextCursor);
+    void writeCursor();
+    void jobDone(bool dataChanged);
+    void syncData();
+    void syncAll();
+    void finishSenderCall();
+
+    QMutex mutex;
+    QString name;
+    QString restrictor;
+    QSharedPointer<SpoolSettings> settings;
+    QFile dataFile;
+    QFile cursorFile;
+    uchar *mappedData = nullptr;
+    qint64 mappedSize = 0;
+    qint64 dataEnd = 0;
+    qint64 cursor = 0;
+    qint64 pendingCount = 0;
+    int unsyncedJobs = 0;
+    //First attached sender is used, the rest are waiting for it to be detached
+    QMap<qint64, SpoolSender> senders;
+    qint64 lastSenderId = 0;
+    //Sender call is in flight from the moment it is scheduled till its result is resolved.
+    //Call scheduled to other thread is not started yet until that thread gets to it
+    quint64 lastSenderCallId = 0;
+    quint64 senderCallId = 0;
+    qint64 callingSenderId = 0;
+    bool senderCallStarted = false;
+    QWaitCondition senderCallFinished;
+    bool delivering = false;
+    bool stopped = false;
+};
+
+bool SpoolQueue::open()
+{
+    if (!dataFile.open(QIODevice::ReadWrite | QIODevice::Unbuffered)
+        || !cursorFile.open(QIODevice::ReadWrite | QIODevice::Unbuffered)) {
+        qCWarning(proofUtilsPrintSpoolLog) << "Can't open spool files for" << name << dataFile.errorString()
+                                           << cursorFile.errorString();
+        return false;
+    }
+    if (dataFile.size() && !map())
+        return false;
+
+    const QByteArray storedCursor = cursorFile.readAll();
+    const uchar *storedCursorData = reinterpret_cast<const uchar *>(storedCursor.constData());
+    const qint64 savedCursor = storedCursor.size() == sizeof(qint64) ? qFromLittleEndian<qint64>(storedCursorData)
+                                                                     : 0;
+
+    //Everything after last valid record is either reserved space or a leftover of interrupted write
+    dataEnd = mappedSize;
+    qint64 validEnd = 0;
+    qint64 nextOffset = 0;
+    cursor = -1;
+    pendingCount = 0;
+    while (readRecord(validEnd, nullptr, nullptr, nextOffset)) {
+        if (cursor < 0 && validEnd >= savedCursor)
+            cursor = validEnd;
+        if (cursor >= 0)
+            ++pendingCount;
+        validEnd = nextOffset;
+    }
+    dataEnd = validEnd;
+    if (cursor < 0)
+        cursor = validEnd;
+
+    const uchar *tail = mappedData + validEnd;
+    const qint64 tailSize = mappedSize - validEnd;
+    if (tailSize > 0 && std::any_of(tail, tail + tailSize, [](uchar c) { return c != 0; })) {
+        qCWarning(proofUtilsPrintSpoolLog) << "Spool" << name << "has broken data after" << validEnd
+                                           << "bytes, dropping it";
+        truncate(validEnd);
+        syncFile(dataFile);
+    }
+    if (!pendingCount && mappedSize) {
+        truncate(0);
+        syncFile(dataFile);
+        cursor = 0;
+    }
+    if (cursor != savedCursor) {
+        writeCursor();
+        syncFile(cursorFile);
+    }
+    qCDebug(proofUtilsPrintSpoolLog) << "Spool" << name << "opened with" << pendingCount << "labels to print";
+    return true;
+}
+
+//Reserved space is not needed anymore, so file is left with records only
+void SpoolQueue::close()
+{
+    if (unsyncedJobs)
+        syncAll();
+    if (mappedSize > dataEnd) {
+        truncate(dataEnd);
+        if (settings->syncPolicy != PrintSpool::SyncPolicy::None)
+            syncFile(dataFile);
+    }
+}
+
+bool SpoolQueue::readRecord(qint64 offset, QByteArray *payload, bool *ignorePrinterState, qint64 &nextOffset) const
+{
+    if (offset + RECORD_HEADER_SIZE > dataEnd)
+        return false;
+    const uchar *header = mappedData + offset;
+    const quint32 magic = qFromLittleEndian<quint32>(header);
+    const qint64 size = qFromLittleEndian<quint32>(header + 4);
+    const quint32 checksum = qFromLittleEndian<quint32>(header + 8);
+    if ((magic != RECORD_MAGIC && magic != RECORD_IGNORING_STATE_MAGIC) || size <= 0
+        || offset + RECORD_HEADER_SIZE + size > dataEnd) {
+        return false;
+    }
+
+    const uchar *content = header + RECORD_HEADER_SIZE;
+    if (payloadChecksum(content, size) != checksum)
+        return false;
+    if (payload)
+        *payload = QByteArray(reinterpret_cast<const char *>(content), static_cast<int>(size));
+    if (ignorePrinterState)
+        *ignorePrinterState = magic == RECORD_IGNORING_STATE_MAGIC;
+    nextOffset = offset + RECORD_HEADER_SIZE + size;
+    return true;
+}
+
+bool SpoolQueue::append(const QByteArray &data, bool ignorePrinterState, Failure &failure)
+{
+    const qint64 recordSize = RECORD_HEADER_SIZE + data.size();
+    if (dataEnd - cursor + recordSize > settings->maxQueueSize) {
+        qCWarning(proofUtilsPrintSpoolLog) << "Spool" << name << "is full";
+        failure = Failure(QStringLiteral("Too many labels are waiting for printing"), UTILS_MODULE_CODE,
+                          UtilsErrorCode::SpoolIsFull, Failure::UserFriendlyHint);
+        return false;
+    }
+    if (!reserve(dataEnd + recordSize)) {
+        qCWarning(proofUtilsPrintSpoolLog) << "Can't write to spool" << name << dataFile.errorString();
+        failure = Failure(QStringLiteral("Can't save label to print spool.\n%1").arg(dataFile.errorString()),
+                          UTILS_MODULE_CODE, UtilsErrorCode::SpoolError);
+        return false;
+    }
+
+    uchar *header = mappedData + dataEnd;
+    const uchar *payload = reinterpret_cast<const uchar *>(data.constData());
+    memcpy(header + RECORD_HEADER_SIZE, payload, static_cast<size_t>(data.size()));
+    qToLittleEndian<quint32>(ignorePrinterState ? RECORD_IGNORING_STATE_MAGIC : RECORD_MAGIC, header);
+    qToLittleEndian<quint32>(static_cast<quint32>(data.size()), header + 4);
+    qToLittleEndian<quint32>(payloadChecksum(payload, data.size()), header + 8);
+    dataEnd += recordSize;
+    ++pendingCount;
+    jobDone(true);
+    return true;
+}
+
+//Space is filled with real zeros instead of just resizing file, so full disk is noticed here
+//and not as a crash on write to mapped memory
+bool SpoolQueue::reserve(qint64 size)
+{
+    if (size <= mappedSize)
+        return true;
+    const qint64 oldSize = dataFile.size();
+    const qint64 newSize = (size / DATA_FILE_GROWTH + 1) * DATA_FILE_GROWTH;
+    if (newSize > oldSize) {
+        const QByteArray zeros(static_cast<int>(qMin(newSize - oldSize, DATA_FILE_GROWTH)), '\0');
+        if (!dataFile.seek(oldSize))
+            return false;
+        for (qint64 left = newSize - oldSize; left > 0; left -= zeros.size()) {
+            if (dataFile.write(zeros.constData(), qMin<qint64>(left, zeros.size())) <= 0) {
+                dataFile.resize(oldSize);
+                return false;
+            }
+        }
+    }
+    return map();
+}
+
+bool SpoolQueue::map()
+{
+    if (mappedData)
+        dataFile.unmap(mappedData);
+    mappedSize = dataFile.size();
+    mappedData = mappedSize ? dataFile.map(0, mappedSize) : nullptr;
+    if (mappedSize && !mappedData) {
+        qCWarning(proofUtilsPrintSpoolLog) << "Can't map spool" << name << dataFile.errorString();
+        mappedSize = 0;
+        return false;
+    }
+    return true;
+}
+
+void SpoolQueue::truncate(qint64 size)
+{
+    if (mappedData)
+        dataFile.unmap(mappedData);
+    mappedData = nullptr;
+    mappedSize = 0;
+    dataFile.resize(size);
+    dataEnd = qMin(dataEnd, size);
+    map();
+}
+
+void SpoolQueue::advance(qint64 nextCursor)
+{
+    cursor = nextCursor;
+    --pendingCount;
+    if (!pendingCount) {
+        //Everything is printed, so file can start from scratch instead of growing forever.
+        //Truncate goes first, stale cursor beyond file end is reset on open.
+        truncate(0);
+        cursor = 0;
+        if (settings->syncPolicy != PrintSpool::SyncPolicy::None)
+            syncFile(dataFile);
+    }
+    writeCursor();
+    jobDone(false);
+}
+
+void SpoolQueue::writeCursor()
+{
+    QByteArray storedCursor(sizeof(qint64), Qt::Uninitialized);
+    qToLittleEndian<qint64>(cursor, reinterpret_cast<uchar *>(storedCursor.data()));
+    if (!cursorFile.seek(0) || cursorFile.write(storedCursor) != storedCursor.size())
+        qCWarning(proofUtilsPrintSpoolLog) << "Can't save cursor of spool" << name << cursorFile.errorString();
+}
+
+void SpoolQueue::jobDone(bool dataChanged)
+{
+    switch (settings->syncPolicy) {
+    case PrintSpool::SyncPolicy::EveryJob:
+        if (dataChanged)
+            syncData();
+        else
+            syncFile(cursorFile);
+        break;
+    case PrintSpool::SyncPolicy::Grouped:
+        if (++unsyncedJobs >= settings->syncGroupSize) {
+            syncAll();
+        } else if (unsyncedJobs == 1) {
+            //Group can be filled slowly, so it is synced by time too
+            QWeakPointer<SpoolQueue> weakSelf = sharedFromThis();
+            retryTimers->schedule(settings->syncInterval, [weakSelf]() {
+                auto queue = weakSelf.toStrongRef();
+                if (!queue)
+                    return;
+                tasks::run(tasks::RestrictionType::ThreadBound, queue->restrictor, [queue]() {
+                    QMutexLocker lock(&queue->mutex);
+                    if (queue->unsyncedJobs)
+                        queue->syncAll();
+                    return true;
+                });
+            });
+        }
+        break;
+    case PrintSpool::SyncPolicy::None:
+        break;
+    }
+}
+
+//Changes made through mapping are not covered by fsync everywhere, so mapping is flushed explicitly
+void SpoolQueue::syncData()
+{
+    if (mappedData) {
+#ifdef Q_OS_WIN
+        FlushViewOfFile(mappedData, 0);
+#else
+        msync(mappedData, static_cast<size_t>(mappedSize), MS_SYNC);
+#endif
+    }
+    syncFile(dataFile);
+}
+
+void SpoolQueue::syncAll()
+{
+    syncData();
+    syncFile(cursorFile);
+    unsyncedJobs = 0;
+}
+
+void SpoolQueue::finishSenderCall()
+{
+    senderCallId = 0;
+    callingSenderId = 0;
+    senderCallStarted = false;
+    senderCallFinished.wakeAll();
+}
+
+void deliverNext(const QSharedPointer<SpoolQueue> &queue);
+
+void continueDelivery(const QSharedPointer<SpoolQueue> &queue, int delay)
+{
+    auto deliver = [queue]() {
+        tasks::run(tasks::RestrictionType::ThreadBound, queue->restrictor, [queue]() {
+            deliverNext(queue);
+            return true;
+        });
+    };
+    if (delay > 0)
+        retryTimers->schedule(delay, deliver);
+    else
+        deliver();
+}
+
+void scheduleDelivery(const QSharedPointer<SpoolQueue> &queue)
+{
+    {
+        QMutexLocker lock(&queue->mutex);
+        if (queue->delivering || queue->stopped || queue->senders.isEmpty() || !queue->pendingCount)
+            return;
+        queue->delivering = true;
+    }
+    continueDelivery(queue, 0);
+}
+
+void callSender(const QSharedPointer<SpoolQueue> &queue, const PrintSpool::Sender &sender, const QByteArray &payload,
+                bool ignorePrinterState, qint64 nextCursor)
+{
+    //Sender and its result are not used anymore once detach returns, so they can safely refer to its owner
+    sender(payload, ignorePrinterState)
+        ->onSuccess([queue, nextCursor](bool printed) {
+            {
+                QMutexLocker lock(&queue->mutex);
+                if (printed)
+                    queue->advance(nextCursor);
+                queue->finishSenderCall();
+            }
+            continueDelivery(queue, printed ? 0 : queue->settings->retryInterval.load());
+        })
+        ->onFailure([queue](const Failure &failure) {
+            qCWarning(proofUtilsPrintSpoolLog) << "Spooled label for" << queue->name
+                                               << "was not printed, will retry later:" << failure.message;
+            {
+                QMutexLocker lock(&queue->mutex);
+                queue->finishSenderCall();
+            }
+            continueDelivery(queue, queue->settings->retryInterval);
+        });
+}
+
+//Only one label of queue is in flight at a time, next one is read from disk after previous is confirmed
+void deliverNext(const QSharedPointer<SpoolQueue> &queue)
+{
+    QByteArray payload;
+    bool ignorePrinterState = false;
+    qint64 nextCursor = 0;
+    SpoolSender sender;
+    quint64 callId = 0;
+    {
+        QMutexLocker lock(&queue->mutex);
+        if (queue->stopped || queue->senders.isEmpty() || !queue->pendingCount) {
+            queue->delivering = false;
+            if (queue->unsyncedJobs)
+                queue->syncAll();
+            return;
+        }
+        if (!queue->readRecord(queue->cursor, &payload, &ignorePrinterState, nextCursor)) {
+            //Spool is validated on open and written only by us, so it means something outside damaged it
+            qCWarning(proofUtilsPrintSpoolLog) << "Spool" << queue->name << "is broken at" << queue->cursor
+                                               << ", dropping the rest of it";
+            queue->truncate(queue->cursor);
+            queue->pendingCount = 0;
+            queue->delivering = false;
+            return;
+        }
+        callId = ++queue->lastSenderCallId;
+        queue->senderCallId = callId;
+        queue->callingSenderId = queue->senders.firstKey();
+        queue->senderCallStarted = !queue->senders.first().context;
+        sender = queue->senders.first();
+    }
+
+    if (!sender.context) {
+        callSender(queue, sender.send, payload, ignorePrinterState, nextCursor);
+        return;
+    }
+    //Call is dropped by Qt if context is destroyed before it, detach has already passed delivery on in this case
+    QMetaObject::invokeMethod(
+        sender.context,
+        [queue, callId, send = sender.send, payload, ignorePrinterState, nextCursor]() {
+            {
+                QMutexLocker lock(&queue->mutex);
+                if (queue->senderCallId != callId)
+                    return;
+                queue->senderCallStarted = true;
+            }
+            callSender(queue, send, payload, ignorePrinterState, nextCursor);
+        },
+        Qt::QueuedConnection);
+}
+
+struct SharedSpools
+{
+    QMutex mutex;
+    QHash<QString, QWeakPointer<PrintSpool>> spools;
+};
+Q_GLOBAL_STATIC(SharedSpools, sharedSpools)
+} // namespace
+
+class PrintSpoolPrivate
+{
+    Q_DECLARE_PUBLIC(PrintSpool)
+    PrintSpool *q_ptr = nullptr;
+
+    QSharedPointer<SpoolQueue> queue(const QString &queueName) const;
+
+    QString directory;
+    QSharedPointer<SpoolSettings> settings;
+    mutable QMutex queuesMutex;
+    mutable QHash<QString, QSharedPointer<SpoolQueue>> queues;
+};
+} // namespace Proof
+
+using namespace Proof;
+
+PrintSpool::PrintSpool(const QString &directory, SyncPolicy syncPolicy) : d_ptr(new PrintSpoolPrivate)
+{
+    d_ptr->q_ptr = this;
+    d_ptr->directory = QDir(directory).absolutePath();
+    d_ptr->settings = QSharedPointer<SpoolSettings>::create(syncPolicy);
+}
+
+PrintSpool::~PrintSpool()
+{
+    Q_D(PrintSpool);
+    QMutexLocker lock(&d->queuesMutex);
+    for (const auto &queue : qAsConst(d->queues)) {
+        QMutexLocker queueLock(&queue->mutex);
+        queue->stopped = true;
+        queue->close();
+    }
+}
+
+QSharedPointer<PrintSpool> PrintSpool::forDirectory(const QString &directory, SyncPolicy syncPolicy)
+{
+    const QString key = QDir(directory).absolutePath();
+    QMutexLocker lock(&sharedSpools->mutex);
+    QSharedPointer<PrintSpool> result = sharedSpools->spools.value(key).toStrongRef();
+    if (!result) {
+        result = QSharedPointer<PrintSpool>::create(key, syncPolicy);
+        sharedSpools->spools[key] = result;
+    }
+    return result;
+}
+
+QString PrintSpool::directory() const
+{
+    Q_D_CONST(PrintSpool);
+    return d->directory;
+}
+
+PrintSpool::SyncPolicy PrintSpool::syncPolicy() const
+{
+    Q_D_CONST(PrintSpool);
+    return d->settings->syncPolicy;
+}
+
+int PrintSpool::retryInterval() const
+{
+    Q_D_CONST(PrintSpool);
+    return d->settings->retryInterval;
+}
+
+void PrintSpool::setRetryInterval(int msecs)
+{
+    Q_D(PrintSpool);
+    d->settings->retryInterval = qMax(msecs, 0);
+}
+
+qint64 PrintSpool::maxQueueSize() const
+{
+    Q_D_CONST(PrintSpool);
+    return d->settings->maxQueueSize;
+}
+
+void PrintSpool::setMaxQueueSize(qint64 bytes)
+{
+    Q_D(PrintSpool);
+    d->settings->maxQueueSize = bytes;
+}
+
+int PrintSpool::syncGroupSize() const
+{
+    Q_D_CONST(PrintSpool);
+    return d->settings->syncGroupSize;
+}
+
+void PrintSpool::setSyncGroupSize(int jobsCount)
+{
+    Q_D(PrintSpool);
+    d->settings->syncGroupSize = qMax(jobsCount, 1);
+}
+
+int PrintSpool::syncInterval() const
+{
+    Q_D_CONST(PrintSpool);
+    return d->settings->syncInterval;
+}
+
+void PrintSpool::setSyncInterval(int msecs)
+{
+    Q_D(PrintSpool);
+    d->settings->syncInterval = qMax(msecs, 0);
+}
+
+qint64 PrintSpool::attach(const QString &queueName, const Sender &sender, QObject *context)
+{
+    Q_D(PrintSpool);
+    auto queue = d->queue(queueName);
+    if (!queue)
+        return 0;
+    qint64 senderId = 0;
+    {
+        QMutexLocker lock(&queue->mutex);
+        senderId = ++queue->lastSenderId;
+        queue->senders[senderId] = SpoolSender{sender, context};
+    }
+    scheduleDelivery(queue);
+    return senderId;
+}
+
+void PrintSpool::detach(const QString &queueName, qint64 senderId)
+{
+    Q_D(PrintSpool);
+    QSharedPointer<SpoolQueue> queue;
+    {
+        QMutexLocker lock(&d->queuesMutex);
+        queue = d->queues.value(queueName);
+    }
+    if (!queue)
+        return;
+    QMutexLocker lock(&queue->mutex);
+    queue->senders.remove(senderId);
+    if (queue->callingSenderId == senderId && !queue->senderCallStarted) {
+        //Call is still waiting for context thread and will be skipped there, so delivery goes on from here
+        queue->finishSenderCall();
+        lock.unlock();
+        continueDelivery(queue, 0);
+        return;
+    }
+    while (queue->callingSenderId == senderId)
+        queue->senderCallFinished.wait(&queue->mutex);
+}
+
+FutureSP<bool> PrintSpool::enqueue(const QString &queueName, const QByteArray &data, bool ignorePrinterState)
+{
+    Q_D(PrintSpool);
+    if (data.isEmpty())
+        return Future<>::successful(true);
+
+    auto queue = d->queue(queueName);
+    if (!queue) {
+        return Future<bool>::fail(Failure(QStringLiteral("Can't open print spool at %1").arg(d->directory),
+                                          UTILS_MODULE_CODE, UtilsErrorCode::SpoolError));
+    }
+    {
+        Failure failure;
+        QMutexLocker lock(&queue->mutex);
+        if (!queue->append(data, ignorePrinterState, failure))
+            return Future<bool>::fail(failure);
+    }
+    scheduleDelivery(queue);
+    return Future<>::successful(true);
+}
+
+qint64 PrintSpool::pendingCount(const QString &queueName) const
+{
+    Q_D_CONST(PrintSpool);
+    auto queue = d->queue(queueName);
+    if (!queue)
+        return 0;
+    QMutexLocker lock(&queue->mutex);
+    return queue->pendingCount;
+}
+
+QSharedPointer<SpoolQueue> PrintSpoolPrivate::queue(const QString &queueName) const
+{
+    QMutexLocker lock(&queuesMutex);
+    auto result = queues.value(queueName);
+    if (result)
+        return result;
+
+    if (!QDir().mkpath(directory)) {
+        qCWarning(proofUtilsPrintSpoolLog) << "Can't create spool directory" << directory;
+        return QSharedPointer<SpoolQueue>();
+    }
+    const QString baseName = QDir(directory).filePath(queueFileBaseName(queueName));
+    result = QSharedPointer<SpoolQueue>::create();
+    result->name = queueName;
+    result->restrictor = QStringLiteral("__Proof_PrintSpool_%1").arg(baseName);
+    result->settings = settings;
+    result->dataFile.setFileName(baseName + QStringLiteral(".spool"));
+    result->cursorFile.setFileName(baseName + QStringLiteral(".cursor"));
+    if (!result->open())
+        return QSharedPointer<SpoolQueue>();
+    queues[queueName] = result;
+    return result;
+}
@@ -35,6 +35,7 @@ Q_LOGGING_CATEGORY(proofUtilsEplGeneratorLog, "proof.utils.eplgenerator")
 Q_LOGGING_CATEGORY(proofUtilsQrCodeGeneratorLog, "proof.utils.qrcodegenerator")
 Q_LOGGING_CATEGORY(proofUtilsLprPrinterInfoLog, "proof.utils.lprprinter.info")
 Q_LOGGING_CATEGORY(proofUtilsLprPrinterDataLog, "proof.utils.lprprinter.data")
+Q_LOGGING_CATEGORY(proofUtilsPrintSpoolLog, "proof.utils.printspool")
 
 PROOF_LIBRARY_INITIALIZER(libraryInit)
 {
@@ -24,9 +24,14 @@
  */
 #include "proofutils/qrcodegenerator.h"
 
+#include <QMutex>
 #include <QPainter>
 #include <qrencode.h>
 
+#include <atomic>
+#include <cstring>
+#include <list>
+
 using namespace Proof;
 
 namespace {
@@ -53,6 +58,10 @@ QrCodeData generateRawQrCode(const QString &string, QrCodeGenerator::Mode mode,
     auto result = QRcode_encodeString(string.toLatin1().constData(), 0, ERROR_CORRECTION_CONVERTOR[errorCorrection],
                                       MODE_CONVERTOR[mode], 1);
     QrCodeData data;
+    if (!result) {
+        qCWarning(proofUtilsQrCodeGeneratorLog) << "QR code can't be generated for" << string;
+        return data;
+    }
     data.width = result->width;
     data.data = QByteArray(reinterpret_cast<char *>(result->data), data.width * data.width);
     QRcode_free(result);
@@ -72,7 +81,8 @@ QImage generateBitmap(const QrCodeData &rawData, int width)
     }
 
     QTransform transform;
-    transform.scale(width / rawData.width, width / rawData.width);
+    if (rawData.width)
+        transform.scale(width / rawData.width, width / rawData.width);
     image = image.transformed(transform);
     int resultWidth = width + ((width + 8) % 8);
 
@@ -85,6 +95,215 @@ QImage generateBitmap(const QrCodeData &rawData, int width)
 
     return resultImage;
 }
+
+//Clears (makes black) pixels [begin, end) of MSB-first packed row
+void clearBits(uchar *row, int begin, int end)
+{
+    if (begin >= end)
+        return;
+    const int firstByte = begin / 8;
+    const int lastByte = (end - 1) / 8;
+    const auto firstMask = static_cast<uchar>(0xFF >> (begin % 8));
+    const auto lastMask = static_cast<uchar>(0xFF << (7 - (end - 1) % 8));
+    if (firstByte == lastByte) {
+        row[firstByte] &= static_cast<uchar>(~(firstMask & lastMask));
+        return;
+    }
+    row[firstByte] &= static_cast<uchar>(~firstMask);
+    memset(row + firstByte + 1, 0, static_cast<size_t>(lastByte - firstByte - 1));
+    row[lastByte] &= static_cast<uchar>(~lastMask);
+}
+
+//Produces same bits as generateBitmap() followed by per-pixel packing, but packs modules into GW rows directly.
+//Every module row is packed once as byte ranges and then copied to the rest of its scaled rows.
+QByteArray generateEplBinaryData(const QrCodeData &rawData, int width)
+{
+    const int resultWidth = width + ((width + 8) % 8);
+    const int bytesPerRow = resultWidth / 8;
+    if (bytesPerRow <= 0)
+        return QByteArray();
+    QByteArray result(bytesPerRow * resultWidth, static_cast<char>(0xFF));
+    const int scale = rawData.width ? width / rawData.width : 0;
+    if (!scale)
+        return result;
+
+    const int rowPixels = bytesPerRow * 8;
+    const auto *modules = reinterpret_cast<const uchar *>(rawData.data.constData());
+    auto *bitmap = reinterpret_cast<uchar *>(result.data());
+    for (int moduleRow = 0; moduleRow < rawData.width; ++moduleRow) {
+        uchar *row = bitmap + moduleRow * scale * bytesPerRow;
+        const uchar *rowModules = modules + moduleRow * rawData.width;
+        for (int moduleColumn = 0; moduleColumn < rawData.width; ++moduleColumn) {
+            if (rowModules[moduleColumn] & 1)
+                clearBits(row, moduleColumn * scale, qMin((moduleColumn + 1) * scale, rowPixels));
+        }
+        for (int i = 1; i < scale; ++i)
+            memcpy(row + i * bytesPerRow, row, static_cast<size_t>(bytesPerRow));
+    }
+    return result;
+}
+
+struct CacheKey
+{
+    QString data;
+    int width;
+    QrCodeGenerator::Mode mode;
+    QrCodeGenerator::ErrorCorrection errorCorrection;
+
+    bool operator==(const CacheKey &other) const
+    {
+        return width == other.width && mode == other.mode && errorCorrection == other.errorCorrection
+               && data == other.data;
+    }
+};
+
+uint qHash(const CacheKey &key, uint seed = 0)
+{
+    seed = ::qHash(key.data, seed);
+    seed = ::qHash(key.width, seed);
+    seed = ::qHash(static_cast<int>(key.mode), seed);
+    return ::qHash(static_cast<int>(key.errorCorrection), seed);
+}
+
+//Cache is split to independently locked shards to not serialize parallel label rendering on single mutex.
+//Each shard is a separate LRU list, memory limit is shared by all of them, so big entries can be cached
+//with small limit too. Shard that got new entry is cleaned first, others only if it has nothing more to drop.
+class QrCodeCache
+{
+public:
+    static constexpr int SHARDS_COUNT = 16;
+    static constexpr qlonglong DEFAULT_MEMORY_LIMIT = 16 * 1024 * 1024;
+    //Rough per-entry bookkeeping overhead (list node, hash node, key)
+    static constexpr qlonglong ENTRY_OVERHEAD = 128;
+
+    bool find(const CacheKey &key, QByteArray &result)
+    {
+        //Disabled cache is not used at all, so it doesn't count misses either
+        if (!memoryLimit.load())
+            return false;
+        Shard &shard = shardFor(key);
+        QMutexLocker lock(&shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            ++shard.misses;
+            return false;
+        }
+        ++shard.hits;
+        shard.entries.splice(shard.entries.begin(), shard.entries, it.value());
+        result = it.value()->value;
+        return true;
+    }
+
+    void insert(const CacheKey &key, const QByteArray &value)
+    {
+        const qlonglong limit = memoryLimit.load();
+        const qlonglong cost = entryCost(key, value);
+        if (cost > limit)
+            return;
+        Shard &shard = shardFor(key);
+        {
+            QMutexLocker lock(&shard.mutex);
+            if (shard.index.contains(key))
+                return;
+            shard.entries.push_front(Entry{key, value, cost});
+            shard.index.insert(key, shard.entries.begin());
+            shard.usedMemory += cost;
+            usedMemory += cost;
+            //New entry is kept even if there is nothing else to drop, other shards have to free memory then
+            evict(shard, limit, 1);
+        }
+        evictAll(limit);
+    }
+
+    void setMemoryLimit(qlonglong limit)
+    {
+        memoryLimit.store(qMax(0ll, limit));
+        evictAll(memoryLimit.load());
+    }
+
+    qlonglong currentMemoryLimit() const { return memoryLimit.load(); }
+
+    void clear()
+    {
+        for (auto &shard : shards) {
+            QMutexLocker lock(&shard.mutex);
+            shard.entries.clear();
+            shard.index.clear();
+            usedMemory -= shard.usedMemory;
+            shard.usedMemory = 0;
+        }
+    }
+
+    QrCodeGenerator::CacheStatistics statistics()
+    {
+        QrCodeGenerator::CacheStatistics result;
+        result.memoryLimit = memoryLimit.load();
+        for (auto &shard : shards) {
+            QMutexLocker lock(&shard.mutex);
+            result.hits += shard.hits;
+            result.misses += shard.misses;
+            result.evictions += shard.evictions;
+            result.usedMemory += shard.usedMemory;
+            result.entriesCount += shard.index.count();
+        }
+        return result;
+    }
+
+private:
+    struct Entry
+    {
+        CacheKey key;
+        QByteArray value;
+        qlonglong cost;
+    };
+
+    struct Shard
+    {
+        QMutex mutex;
+        std::list<Entry> entries;
+        QHash<CacheKey, std::list<Entry>::iterator> index;
+        qlonglong usedMemory = 0;
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+    };
+
+    static qlonglong entryCost(const CacheKey &key, const QByteArray &value)
+    {
+        return value.size() + key.data.size() * static_cast<qlonglong>(sizeof(QChar)) + ENTRY_OVERHEAD;
+    }
+
+    Shard &shardFor(const CacheKey &key) { return shards[qHash(key) % SHARDS_COUNT]; }
+
+    //Only one shard is locked at a time, so parallel evictions can't deadlock
+    void evictAll(qlonglong limit)
+    {
+        for (auto &shard : shards) {
+            if (usedMemory.load() <= limit)
+                return;
+            QMutexLocker lock(&shard.mutex);
+            evict(shard, limit, 0);
+        }
+    }
+
+    void evict(Shard &shard, qlonglong limit, size_t entriesToKeep)
+    {
+        while (usedMemory.load() > limit && shard.entries.size() > entriesToKeep) {
+            const Entry &last = shard.entries.back();
+            shard.usedMemory -= last.cost;
+            usedMemory -= last.cost;
+            shard.index.remove(last.key);
+            shard.entries.pop_back();
+            ++shard.evictions;
+        }
+    }
+
+    Shard shards[SHARDS_COUNT];
+    std::atomic<qlonglong> memoryLimit{DEFAULT_MEMORY_LIMIT};
+    std::atomic<qlonglong> usedMemory{0};
+};
+
+Q_GLOBAL_STATIC(QrCodeCache, qrCodeCache)
 } // namespace
 
 QImage QrCodeGenerator::generateBitmap(const QString &string, int width, QrCodeGenerator::Mode mode,
@@ -96,23 +315,35 @@ QImage QrCodeGenerator::generateBitmap(const QString &string, int width, QrCodeG
 QByteArray QrCodeGenerator::generateEplBinaryData(const QString &string, int width, QrCodeGenerator::Mode mode,
                                                   QrCodeGenerator::ErrorCorrection errorCorrection)
 {
+    CacheKey key{string, width, mode, errorCorrection};
     QByteArray result;
-    auto bitmap = generateBitmap(string, width, mode, errorCorrection);
-
-    for (int i = 0; i < bitmap.height(); ++i) {
-        for (int j = 0; j < bitmap.width() / 8; ++j) {
-            qint8 byte = 0;
-            for (int bit = 0; bit < 8; ++bit) {
-                if (bitmap.pixel(j * 8 + bit, i) == QColor(Qt::white).rgb())
-                    byte |= 1 << (7 - bit);
-            }
-            result.append(byte);
-        }
-    }
-
+    if (qrCodeCache->find(key, result))
+        return result;
+    result = ::generateEplBinaryData(::generateRawQrCode(string, mode, errorCorrection), width);
+    qrCodeCache->insert(key, result);
     return result;
 }
 
+void QrCodeGenerator::setCacheMemoryLimit(qlonglong bytes)
+{
+    qrCodeCache->setMemoryLimit(bytes);
+}
+
+qlonglong QrCodeGenerator::cacheMemoryLimit()
+{
+    return qrCodeCache->currentMemoryLimit();
+}
+
+QrCodeGenerator::CacheStatistics QrCodeGenerator::cacheStatistics()
+{
+    return qrCodeCache->statistics();
+}
+
+void QrCodeGenerator::clearCache()
+{
+    qrCodeCache->clear();
+}
+
 uint QrCodeGenerator::qHash(QrCodeGenerator::Mode arg, uint seed)
 {
     return ::qHash(static_cast<int>(arg), seed);
@@ -0,0 +1,369 @@
+/* Copyright 2018, OpenSoft Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted
+ * provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright notice, this list of
+ * conditions and the following disclaimer.
+ *    * Redistributions in binary form must reproduce the above copyright notice, this list of
+ * conditions and the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *     * Neither the name of OpenSoft Inc. nor the names of its contributors may be used to endorse
+ * or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "proofutils/rawsocketprinter.h"
+
+#include "proofseed/tasks.h"
+
+#include "proofcore/proofobject_p.h"
+
+#include <QEnableSharedFromThis>
+#include <QMutex>
+#include <QTcpSocket>
+
+#include <atomic>
+#include <deque>
+
+namespace {
+constexpr qint64 DEFAULT_MAX_BATCH_SIZE = 64 * 1024;
+constexpr qint64 DEFAULT_MAX_PENDING_SIZE = 4 * 1024 * 1024;
+constexpr int DEFAULT_TIMEOUT = 10000;
+
+struct PendingLabel
+{
+    QByteArray data;
+    Proof::PromiseSP<bool> promise;
+};
+} // namespace
+
+namespace Proof {
+namespace Hardware {
+class RawSocketConnection : public QEnableSharedFromThis<RawSocketConnection>
+{
+public:
+    RawSocketConnection(const QString &host, quint16 port);
+    ~RawSocketConnection();
+
+    FutureSP<bool> enqueue(const QByteArray &data);
+    FutureSP<bool> checkConnection();
+
+    const QString host;
+    const quint16 port;
+    const QString restrictor;
+
+    std::atomic<int> timeout{DEFAULT_TIMEOUT};
+    std::atomic<qint64> maxBatchSize{DEFAULT_MAX_BATCH_SIZE};
+    std::atomic<qint64> maxPendingSize{DEFAULT_MAX_PENDING_SIZE};
+    std::atomic<qint64> pendingSize{0};
+    std::atomic<bool> congested{false};
+
+private:
+    //Methods below are called only from restrictor thread
+    void flush();
+    bool ensureConnected(Failure &failure);
+    bool write(const QByteArray &data, Failure &failure);
+    void dropSocket();
+
+    QMutex pendingMutex;
+    std::deque<PendingLabel> pending;
+    bool flushScheduled = false;
+
+    QTcpSocket *socket = nullptr;
+};
+
+class RawSocketPrinterPrivate : public ProofObjectPrivate
+{
+    Q_DECLARE_PUBLIC(RawSocketPrinter)
+
+    QSharedPointer<RawSocketConnection> connection;
+};
+
+//Most printers accept only one connection at raw port, so all printer objects share it
+struct RawSocketConnections
+{
+    QMutex mutex;
+    QHash<QString, QWeakPointer<RawSocketConnection>> connections;
+};
+Q_GLOBAL_STATIC(RawSocketConnections, rawSocketConnections)
+
+static QSharedPointer<RawSocketConnection> sharedConnection(const QString &host, quint16 port)
+{
+    const QString key = QStringLiteral("%1:%2").arg(host).arg(port);
+    QMutexLocker lock(&rawSocketConnections->mutex);
+    //Entries of connections without printers are removed here, so registry doesn't grow with every printer ever used
+    auto &connections = rawSocketConnections->connections;
+    for (auto it = connections.begin(); it != connections.end();) {
+        if (it.value().isNull())
+            it = connections.erase(it);
+        else
+            ++it;
+    }
+    QSharedPointer<RawSocketConnection> result = connections.value(key).toStrongRef();
+    if (!result) {
+        result = QSharedPointer<RawSocketConnection>::create(host, port);
+        connections[key] = result;
+    }
+    return result;
+}
+} // namespace Hardware
+} // namespace Proof
+
+using namespace Proof;
+using namespace Proof::Hardware;
+
+RawSocketPrinter::RawSocketPrinter(const QString &printerHost, quint16 printerPort, QObject *parent)
+    : ProofObject(*new RawSocketPrinterPrivate, parent)
+{
+    Q_D(RawSocketPrinter);
+    QString host = printerHost.trimmed().isEmpty() ? QStringLiteral("127.0.0.1") : printerHost.trimmed();
+    d->connection = sharedConnection(host, printerPort);
+    qCDebug(proofUtilsLprPrinterInfoLog) << "Raw socket printer at" << host << printerPort;
+}
+
+QString RawSocketPrinter::printerHost() const
+{
+    Q_D_CONST(RawSocketPrinter);
+    return d->connection->host;
+}
+
+quint16 RawSocketPrinter::printerPort() const
+{
+    Q_D_CONST(RawSocketPrinter);
+    return d->connection->port;
+}
+
+int RawSocketPrinter::timeout() const
+{
+    Q_D_CONST(RawSocketPrinter);
+    return d->connection->timeout;
+}
+
+void RawSocketPrinter::setTimeout(int msecs)
+{
+    Q_D(RawSocketPrinter);
+    d->connection->timeout = msecs;
+}
+
+qint64 RawSocketPrinter::maxBatchSize() const
+{
+    Q_D_CONST(RawSocketPrinter);
+    return d->connection->maxBatchSize;
+}
+
+void RawSocketPrinter::setMaxBatchSize(qint64 bytes)
+{
+    Q_D(RawSocketPrinter);
+    d->connection->maxBatchSize = bytes;
+}
+
+qint64 RawSocketPrinter::maxPendingSize() const
+{
+    Q_D_CONST(RawSocketPrinter);
+    return d->connection->maxPendingSize;
+}
+
+void RawSocketPrinter::setMaxPendingSize(qint64 bytes)
+{
+    Q_D(RawSocketPrinter);
+    d->connection->maxPendingSize = bytes;
+}
+
+qint64 RawSocketPrinter::pendingSize() const
+{
+    Q_D_CONST(RawSocketPrinter);
+    return d->connection->pendingSize;
+}
+
+bool RawSocketPrinter::isCongested() const
+{
+    Q_D_CONST(RawSocketPrinter);
+    return d->connection->congested;
+}
+
+FutureSP<bool> RawSocketPrinter::printRawData(const QByteArray &data) const
+{
+    Q_D_CONST(RawSocketPrinter);
+    return d->connection->enqueue(data);
+}
+
+FutureSP<bool> RawSocketPrinter::printerIsReady() const
+{
+    Q_D_CONST(RawSocketPrinter);
+    return d->connection->checkConnection();
+}
+
+RawSocketConnection::RawSocketConnection(const QString &host, quint16 port)
+    : host(host), port(port), restrictor(QStringLiteral("__Proof_RawSocket_%1:%2").arg(host).arg(port))
+{}
+
+RawSocketConnection::~RawSocketConnection()
+{
+    if (!socket)
+        return;
+    //Socket belongs to restrictor thread and should die there
+    QTcpSocket *socketToDelete = socket;
+    socket = nullptr;
+    tasks::run(tasks::RestrictionType::ThreadBound, restrictor, [socketToDelete]() {
+        socketToDelete->abort();
+        delete socketToDelete;
+        return true;
+    });
+}
+
+FutureSP<bool> RawSocketConnection::enqueue(const QByteArray &data)
+{
+    PromiseSP<bool> promise = PromiseSP<bool>::create();
+    bool needToScheduleFlush = false;
+    {
+        QMutexLocker lock(&pendingMutex);
+        if (pendingSize && pendingSize + data.size() > maxPendingSize) {
+            lock.unlock();
+            qCWarning(proofUtilsLprPrinterInfoLog) << "Raw socket printer" << host << port << "queue is full";
+            return Future<bool>::fail(
+                Failure(QStringLiteral("Printer %1:%2 is busy.\nToo many labels are waiting for printing").arg(host).arg(port),
+                        UTILS_MODULE_CODE, UtilsErrorCode::RawSocketBackpressure, Failure::UserFriendlyHint));
+        }
+        pending.push_back({data, promise});
+        pendingSize += data.size();
+        needToScheduleFlush = !flushScheduled;
+        flushScheduled = true;
+    }
+
+    if (needToScheduleFlush) {
+        QSharedPointer<RawSocketConnection> self = sharedFromThis();
+        tasks::run(tasks::RestrictionType::ThreadBound, restrictor, [self]() {
+            self->flush();
+            return true;
+        });
+    }
+    return promise->future();
+}
+
+FutureSP<bool> RawSocketConnection::checkConnection()
+{
+    QSharedPointer<RawSocketConnection> self = sharedFromThis();
+    return tasks::run(tasks::RestrictionType::ThreadBound, restrictor, [self]() -> bool {
+        Failure failure;
+        if (!self->ensureConnected(failure))
+            return WithFailure(failure);
+        return true;
+    });
+}
+
+void RawSocketConnection::flush()
+{
+    forever {
+        std::vector<PendingLabel> batch;
+        QByteArray data;
+        {
+            QMutexLocker lock(&pendingMutex);
+            if (pending.empty()) {
+                flushScheduled = false;
+                return;
+            }
+            const qint64 batchLimit = maxBatchSize;
+            data.reserve(static_cast<int>(qMin<qint64>(pendingSize, batchLimit)));
+            while (!pending.empty() && (batch.empty() || data.size() + pending.front().data.size() <= batchLimit)) {
+                data.append(pending.front().data);
+                pendingSize -= pending.front().data.size();
+                batch.push_back(std::move(pending.front()));
+                pending.pop_front();
+            }
+        }
+
+        Failure failure;
+        if (ensureConnected(failure) && write(data, failure)) {
+            qCDebug(proofUtilsLprPrinterDataLog) << batch.size() << "labels sent to" << host << port;
+            for (const auto &label : batch)
+                label.promise->success(true);
+            continue;
+        }
+
+        //Raw port has no acknowledgements and data left in socket buffers is lost when connection is dropped,
+        //so nothing from failed batch is known to reach printer. Whole batch is failed, retry can duplicate
+        //some labels but never loses them.
+        //Labels queued after failed ones most likely will fail too, so we don't make caller wait for it
+        {
+            QMutexLocker lock(&pendingMutex);
+            for (auto &label : pending)
+                batch.push_back(std::move(label));
+            pending.clear();
+            pendingSize = 0;
+        }
+        for (const auto &label : batch)
+            label.promise->failure(failure);
+    }
+}
+
+bool RawSocketConnection::ensureConnected(Failure &failure)
+{
+    if (socket) {
+        //There is no event loop here, so disconnects and status bytes sent by printer are noticed only this way
+        socket->waitForReadyRead(0);
+        socket->readAll();
+        if (socket->state() == QAbstractSocket::ConnectedState)
+            return true;
+        qCDebug(proofUtilsLprPrinterInfoLog) << "Raw socket printer" << host << port << "closed connection";
+        dropSocket();
+    }
+
+    socket = new QTcpSocket;
+    socket->connectToHost(host, port);
+    if (!socket->waitForConnected(timeout)) {
+        qCWarning(proofUtilsLprPrinterInfoLog)
+            << "Can't connect to raw socket printer" << host << port << socket->errorString();
+        failure = Failure(
+            QStringLiteral("Can't connect to printer %1:%2.\n%3").arg(host).arg(port).arg(socket->errorString()),
+            UTILS_MODULE_CODE, UtilsErrorCode::RawSocketConnectionError);
+        dropSocket();
+        return false;
+    }
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    return true;
+}
+
+bool RawSocketConnection::write(const QByteArray &data, Failure &failure)
+{
+    if (socket->write(data) != data.size()) {
+        failure = Failure(
+            QStringLiteral("Can't send data to printer %1:%2.\n%3").arg(host).arg(port).arg(socket->errorString()),
+            UTILS_MODULE_CODE, UtilsErrorCode::RawSocketConnectionError);
+        dropSocket();
+        return false;
+    }
+
+    while (socket->bytesToWrite()) {
+        if (!socket->waitForBytesWritten(timeout)) {
+            //Printer stopped reading from socket: out of paper, head is open or it is just too slow
+            congested = true;
+            qCWarning(proofUtilsLprPrinterInfoLog) << "Raw socket printer" << host << port << "doesn't accept data,"
+                                                   << socket->bytesToWrite() << "bytes left";
+            failure = Failure(QStringLiteral("Printer %1:%2 doesn't accept data").arg(host).arg(port),
+                              UTILS_MODULE_CODE, UtilsErrorCode::RawSocketBackpressure, Failure::UserFriendlyHint);
+            dropSocket();
+            return false;
+        }
+    }
+    congested = false;
+    return true;
+}
+
+void RawSocketConnection::dropSocket()
+{
+    if (!socket)
+        return;
+    socket->abort();
+    delete socket;
+    socket = nullptr;
+}
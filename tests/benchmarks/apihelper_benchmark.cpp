@@ -0,0 +1,92 @@
+// clazy:skip
+
+#include "proofnetwork/mis/apihelper.h"
+
+#include "benchmark_global.h"
+
+#include <QHash>
+#include <QVector>
+
+using namespace Proof::Mis;
+
+static constexpr int CONVERSIONS_COUNT = 1000000;
+
+//Converts every named value of enum back and forth with generated tables and with QHash,
+//where strings are lowered before lookup and enum is converted to string with QHash::key(), as it was done before
+template <typename Enum>
+static void benchmarkFamily(const QString &family, int valuesCount, QString (*toString)(Enum),
+                            Enum (*fromString)(const QStringRef &, bool *))
+{
+    QVector<Enum> values;
+    QVector<QString> strings;
+    QHash<QString, Enum> hash;
+    for (int i = 0; i < valuesCount; ++i) {
+        values << static_cast<Enum>(i);
+        strings << toString(values.last()).toUpper();
+        hash.insert(toString(values.last()), values.last());
+    }
+
+    int checksum = 0;
+    qint64 toStringNsecs = measureNsecs([&values, &checksum, toString]() {
+        for (int i = 0; i < CONVERSIONS_COUNT; ++i)
+            checksum += toString(values[i % values.count()]).size();
+    });
+    int hashChecksum = 0;
+    qint64 hashKeyNsecs = measureNsecs([&values, &hash, &hashChecksum]() {
+        for (int i = 0; i < CONVERSIONS_COUNT; ++i)
+            hashChecksum += hash.key(values[i % values.count()]).size();
+    });
+    EXPECT_EQ(hashChecksum, checksum);
+
+    checksum = 0;
+    qint64 fromStringNsecs = measureNsecs([&strings, &checksum, fromString]() {
+        for (int i = 0; i < CONVERSIONS_COUNT; ++i)
+            checksum += static_cast<int>(fromString(QStringRef(&strings[i % strings.count()]), nullptr));
+    });
+    hashChecksum = 0;
+    qint64 hashValueNsecs = measureNsecs([&strings, &hash, &hashChecksum]() {
+        for (int i = 0; i < CONVERSIONS_COUNT; ++i)
+            hashChecksum += static_cast<int>(hash.value(strings[i % strings.count()].toLower()));
+    });
+    EXPECT_EQ(hashChecksum, checksum);
+
+    reportMeasurement(family + QStringLiteral(" to string"), static_cast<double>(toStringNsecs) / CONVERSIONS_COUNT,
+                      "ns/conversion");
+    reportMeasurement(family + QStringLiteral(" to string with QHash::key()"),
+                      static_cast<double>(hashKeyNsecs) / CONVERSIONS_COUNT, "ns/conversion");
+    reportMeasurement(family + QStringLiteral(" from string"), static_cast<double>(fromStringNsecs) / CONVERSIONS_COUNT,
+                      "ns/conversion");
+    reportMeasurement(family + QStringLiteral(" from string with toLower() and QHash"),
+                      static_cast<double>(hashValueNsecs) / CONVERSIONS_COUNT, "ns/conversion");
+}
+
+TEST(ApiHelperBenchmark, entityStatus)
+{
+    benchmarkFamily<EntityStatus>(QStringLiteral("EntityStatus"), static_cast<int>(EntityStatus::InvalidEntity) + 1,
+                                  &entityStatusToString, &entityStatusFromString);
+}
+
+TEST(ApiHelperBenchmark, workflowStatus)
+{
+    benchmarkFamily<WorkflowStatus>(QStringLiteral("WorkflowStatus"), static_cast<int>(WorkflowStatus::UnknownStatus),
+                                    &workflowStatusToString, &workflowStatusFromString);
+}
+
+TEST(ApiHelperBenchmark, workflowAction)
+{
+    benchmarkFamily<WorkflowAction>(QStringLiteral("WorkflowAction"), static_cast<int>(WorkflowAction::UnknownAction),
+                                    &workflowActionToString, &workflowActionFromString);
+}
+
+TEST(ApiHelperBenchmark, transitionEvent)
+{
+    benchmarkFamily<TransitionEvent>(QStringLiteral("TransitionEvent"),
+                                     static_cast<int>(TransitionEvent::UnknownEvent), &transitionEventToString,
+                                     &transitionEventFromString);
+}
+
+TEST(ApiHelperBenchmark, paperSide)
+{
+    benchmarkFamily<PaperSide>(QStringLiteral("PaperSide"), static_cast<int>(PaperSide::BackSide) + 1,
+                               &paperSideToString, &paperSideFromString);
+}
@@ -0,0 +1,34 @@
+#ifndef PROOF_BENCHMARK_GLOBAL_H
+#define PROOF_BENCHMARK_GLOBAL_H
+
+#include "gtest/proof/test_global.h"
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include <cstdio>
+
+//Benchmarks only print their measurements and record them as test properties,
+//timings depend on machine too much to be checked.
+template <typename Func>
+qint64 measureNsecs(Func &&func)
+{
+    QElapsedTimer timer;
+    timer.start();
+    func();
+    return timer.nsecsElapsed();
+}
+
+inline double perSecond(qint64 count, qint64 nsecs)
+{
+    return nsecs > 0 ? count * 1e9 / nsecs : 0.0;
+}
+
+inline void reportMeasurement(const QString &name, double value, const char *unit)
+{
+    std::printf("[ BENCHMARK] %s: %.2f %s\n", qUtf8Printable(name), value, unit);
+    std::fflush(stdout);
+    ::testing::Test::RecordProperty(name.toStdString(), QString::number(value, 'f', 2).toStdString());
+}
+
+#endif // PROOF_BENCHMARK_GLOBAL_H
@@ -0,0 +1,95 @@
+// clazy:skip
+
+#include "proofutils/epllabelgenerator.h"
+
+#include "benchmark_global.h"
+
+using namespace Proof;
+
+static constexpr int COMMANDS_COUNT = 100000;
+
+//Commands formatted with QString::arg() chains and converted on append, the way generator did before direct emitting
+static QByteArray formattedTextCommand(const QString &text, int x, int y)
+{
+    return QStringLiteral("A%1,%2,%3,%4,%5,%6,%7,\"%8\"\n")
+        .arg(x)
+        .arg(y)
+        .arg(0)
+        .arg(4)
+        .arg(1)
+        .arg(1)
+        .arg(QStringLiteral("N"))
+        .arg(text)
+        .toLatin1();
+}
+
+static QByteArray formattedBarcodeCommand(const QString &data, int x, int y)
+{
+    return QStringLiteral("B%1,%2,%3,%4,%5,%6,%7,%8,\"%9\"\n")
+        .arg(x)
+        .arg(y)
+        .arg(0)
+        .arg(QStringLiteral("1"))
+        .arg(2)
+        .arg(4)
+        .arg(200)
+        .arg(QStringLiteral("B"))
+        .arg(data)
+        .toLatin1();
+}
+
+static QByteArray formattedLineCommand(int x, int y, int width, int height)
+{
+    return QStringLiteral("L%1%2,%3,%4,%5\n").arg(QStringLiteral("O")).arg(x).arg(y).arg(width).arg(height).toLatin1();
+}
+
+template <typename Direct, typename Formatted>
+static void compareCommands(const QString &command, Direct &&direct, Formatted &&formatted)
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    qint64 directNsecs = measureNsecs([&generator, &direct]() {
+        for (int i = 0; i < COMMANDS_COUNT; ++i)
+            direct(generator, i);
+    });
+
+    QByteArray label;
+    qint64 formattedNsecs = measureNsecs([&label, &formatted]() {
+        for (int i = 0; i < COMMANDS_COUNT; ++i)
+            label.append(formatted(i));
+    });
+
+    reportMeasurement(command, static_cast<double>(directNsecs) / COMMANDS_COUNT, "ns/command");
+    reportMeasurement(command + QStringLiteral(" with QString::arg()"),
+                      static_cast<double>(formattedNsecs) / COMMANDS_COUNT, "ns/command");
+    EXPECT_GT(generator.labelData().size(), COMMANDS_COUNT);
+    EXPECT_GT(label.size(), COMMANDS_COUNT);
+}
+
+TEST(EplLabelGeneratorBenchmark, addText)
+{
+    const QString text = QStringLiteral("MT-42 \"Batch\" 1350x2016");
+    compareCommands(
+        QStringLiteral("addText"),
+        [&text](EplLabelGenerator &generator, int i) { generator.addText(text, i % 800, i % 1200); },
+        [&text](int i) { return formattedTextCommand(text, i % 800, i % 1200); });
+}
+
+TEST(EplLabelGeneratorBenchmark, addBarcode)
+{
+    const QString data = QStringLiteral("1234567890AB");
+    compareCommands(
+        QStringLiteral("addBarcode"),
+        [&data](EplLabelGenerator &generator, int i) {
+            generator.addBarcode(data, EplLabelGenerator::BarcodeType::Code128Auto, i % 800, i % 1200);
+        },
+        [&data](int i) { return formattedBarcodeCommand(data, i % 800, i % 1200); });
+}
+
+TEST(EplLabelGeneratorBenchmark, addLine)
+{
+    compareCommands(
+        QStringLiteral("addLine"),
+        [](EplLabelGenerator &generator, int i) { generator.addLine(i % 800, i % 1200, 300, 4); },
+        [](int i) { return formattedLineCommand(i % 800, i % 1200, 300, 4); });
+}
@@ -0,0 +1,100 @@
+// clazy:skip
+
+#include "proofnetwork/mis/data/job.h"
+#include "proofnetwork/mis/jobsbinaryarchive.h"
+#include "proofnetwork/mis/jobsjsonreader.h"
+
+#include "benchmark_global.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+
+using namespace Proof::Mis;
+
+static constexpr int JOBS_COUNT = 100000;
+
+static QVector<JobSP> jobs()
+{
+    QVector<JobSP> result;
+    result.reserve(JOBS_COUNT);
+    for (int i = 0; i < JOBS_COUNT; ++i) {
+        JobSP job = Job::create(QStringLiteral("job-%1").arg(i), QStringLiteral("metrix"));
+        job->setName(QStringLiteral("MT-%1").arg(i % 1000));
+        job->setStatus(i % 2 ? EntityStatus::NotReadyEntity : EntityStatus::ValidEntity);
+        job->setQuantity(i * 100);
+        job->setWidth(2016.0);
+        job->setHeight(i % 3 ? 1350.0 : 1350.5);
+        job->setPageCount(i % 50);
+        job->setHasPreview(i % 2);
+        job->setWorkflowStatus(WorkflowAction::PrintingAction, WorkflowStatus::DoneStatus, PaperSide::FrontSide);
+        job->setWorkflowStatus(WorkflowAction::PrintingAction, WorkflowStatus::InProgressStatus, PaperSide::BackSide);
+        job->setWorkflowStatus(WorkflowAction::CuttingAction, WorkflowStatus::IsReadyForStatus);
+        job->setWorkflowStatus(WorkflowAction::BoxingAction, WorkflowStatus::NeedsStatus);
+        job->setWorkflowStatus(WorkflowAction::ShippingAction, WorkflowStatus::NeedsStatus);
+        result << job;
+    }
+    return result;
+}
+
+TEST(JobsBinaryArchiveBenchmark, loadComparedToJson)
+{
+    QVector<JobSP> original = jobs();
+    QJsonArray jsonArray;
+    for (const JobSP &job : original)
+        jsonArray << job->toJson();
+    QByteArray json = QJsonDocument(jsonArray).toJson(QJsonDocument::Compact);
+    jsonArray = QJsonArray();
+    QByteArray binary = JobsBinaryArchive::serialize(original);
+
+    reportMeasurement(QStringLiteral("JSON size"), json.size() / 1024.0, "KB");
+    reportMeasurement(QStringLiteral("binary archive size"), binary.size() / 1024.0, "KB");
+
+    QVector<JobSP> fromJson;
+    qint64 jsonNsecs = measureNsecs([&json, &fromJson]() {
+        const QJsonArray array = QJsonDocument::fromJson(json).array();
+        fromJson.reserve(array.count());
+        for (const auto &value : array)
+            fromJson << Job::fromJson(value.toObject());
+    });
+    ASSERT_EQ(JOBS_COUNT, fromJson.count());
+    fromJson.clear();
+
+    qint64 readerJobs = 0;
+    qint64 readerNsecs = measureNsecs([&json, &readerJobs]() {
+        JobsJsonReader reader;
+        reader.setCacheUsed(false);
+        reader.setBatchHandler([&readerJobs](const QVector<JobSP> &batch) { readerJobs += batch.count(); });
+        reader.addData(json);
+        reader.finish();
+    });
+    EXPECT_EQ(JOBS_COUNT, readerJobs);
+
+    JobsBinaryArchive archive;
+    qint64 lazyNsecs = measureNsecs([&archive, &binary]() { archive.load(binary); });
+    ASSERT_EQ(JOBS_COUNT, archive.count());
+    QVector<JobSP> fromBinary;
+    qint64 decodeNsecs = measureNsecs([&archive, &fromBinary]() { fromBinary = archive.jobs(); });
+    ASSERT_EQ(JOBS_COUNT, fromBinary.count());
+    EXPECT_EQ(original.last()->toJson(), fromBinary.last()->toJson());
+    fromBinary.clear();
+    archive.close();
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString fileName = dir.path() + "/jobs.bin";
+    ASSERT_TRUE(JobsBinaryArchive::save(original, fileName));
+    qint64 mappedNsecs = measureNsecs([&archive, &fileName, &fromBinary]() {
+        archive.load(fileName);
+        fromBinary = archive.jobs();
+    });
+    EXPECT_EQ(JOBS_COUNT, fromBinary.count());
+
+    reportMeasurement(QStringLiteral("QJsonDocument and Job::fromJson() load"), jsonNsecs / 1e6, "ms");
+    reportMeasurement(QStringLiteral("JobsJsonReader load"), readerNsecs / 1e6, "ms");
+    reportMeasurement(QStringLiteral("binary archive lazy load"), lazyNsecs / 1e6, "ms");
+    reportMeasurement(QStringLiteral("binary archive load with all jobs decoded"), (lazyNsecs + decodeNsecs) / 1e6,
+                      "ms");
+    reportMeasurement(QStringLiteral("memory-mapped binary archive load with all jobs decoded"), mappedNsecs / 1e6,
+                      "ms");
+}
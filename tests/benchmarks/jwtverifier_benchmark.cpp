@@ -0,0 +1,47 @@
+// clazy:skip
+
+#include "proofnetwork/ums/jwtverifier.h"
+
+#include "benchmark_global.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <limits>
+
+using namespace Proof::Ums;
+
+static constexpr int TOKENS_COUNT = 2000;
+
+TEST(JwtVerifierBenchmark, verificationsPerSecond)
+{
+    QByteArray token =
+        QJsonDocument::fromJson(dataFromFile(":/data/token.json")).object().value("access_token").toString().toUtf8();
+    ASSERT_FALSE(token.isEmpty());
+    JwtVerifier verifier(QCA::PublicKey::fromPEM(dataFromFile(":/data/pub_rsa.key")).toRSA());
+    //Token from test data expired long ago
+    verifier.setLeeway(std::numeric_limits<int>::max());
+    ASSERT_TRUE(verifier.verify(token).isValid());
+
+    int valid = 0;
+    qint64 singleNsecs = measureNsecs([&verifier, &token, &valid]() {
+        for (int i = 0; i < TOKENS_COUNT; ++i)
+            valid += verifier.verify(token).isValid();
+    });
+    EXPECT_EQ(TOKENS_COUNT, valid);
+
+    QVector<QByteArray> tokens(TOKENS_COUNT, token);
+    QVector<JwtVerifier::Verification> results;
+    qint64 batchNsecs = measureNsecs([&verifier, &tokens, &results]() { results = verifier.verify(tokens)->result(); });
+    ASSERT_EQ(TOKENS_COUNT, results.count());
+    EXPECT_TRUE(results.last().isValid());
+
+    int cores = qMax(1, QThread::idealThreadCount());
+    reportMeasurement(QStringLiteral("verify() on one thread"), perSecond(TOKENS_COUNT, singleNsecs),
+                      "verifications/s");
+    reportMeasurement(QStringLiteral("batch verify() on %1 core(s)").arg(cores), perSecond(TOKENS_COUNT, batchNsecs),
+                      "verifications/s");
+    reportMeasurement(QStringLiteral("batch verify() per core"), perSecond(TOKENS_COUNT, batchNsecs) / cores,
+                      "verifications/s");
+}
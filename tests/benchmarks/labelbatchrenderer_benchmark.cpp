@@ -0,0 +1,114 @@
+// clazy:skip
+
+#include "proofutils/labelbatchrenderer.h"
+
+#include "benchmark_global.h"
+
+#include <QThread>
+
+#include <thread>
+#include <vector>
+
+using namespace Proof;
+
+static constexpr int LABELS_COUNT = 20000;
+
+static LabelTemplate shippingLabelTemplate()
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    generator.addTextPlaceholder("name", 10, 20);
+    generator.addTextPlaceholder("address", 10, 80, 3);
+    generator.addBarcodePlaceholder("id", EplLabelGenerator::BarcodeType::Code128Auto, 10, 200);
+    generator.addLine(10, 450, 700, 4);
+    generator.addPrintCommand();
+    return generator.labelTemplate();
+}
+
+static QVector<LabelBatchRenderer::LabelValues> labelRows()
+{
+    QVector<LabelBatchRenderer::LabelValues> rows;
+    rows.reserve(LABELS_COUNT);
+    for (int i = 0; i < LABELS_COUNT; ++i) {
+        rows << LabelBatchRenderer::LabelValues{{"name", QStringLiteral("MT-%1").arg(i)},
+                                                {"address", QStringLiteral("%1 Main St, Apt %2").arg(i).arg(i % 97)},
+                                                {"id", QString::number(1000000 + i)}};
+    }
+    return rows;
+}
+
+//Rows are split between given number of threads, each thread renders its own contiguous part
+static qint64 renderOnThreads(const LabelTemplate &labelTemplate, const QVector<LabelBatchRenderer::LabelValues> &rows,
+                              int threadsCount)
+{
+    QVector<QByteArray> results(rows.count());
+    return measureNsecs([&labelTemplate, &rows, &results, threadsCount]() {
+        std::vector<std::thread> threads;
+        int partSize = (rows.count() + threadsCount - 1) / threadsCount;
+        for (int start = 0; start < rows.count(); start += partSize) {
+            int end = qMin(start + partSize, rows.count());
+            threads.emplace_back([&labelTemplate, &rows, &results, start, end]() {
+                for (int i = start; i < end; ++i)
+                    results[i] = labelTemplate.render(rows[i]);
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+    });
+}
+
+TEST(LabelBatchRendererBenchmark, coresScaling)
+{
+    LabelTemplate labelTemplate = shippingLabelTemplate();
+    QVector<LabelBatchRenderer::LabelValues> rows = labelRows();
+    int maxThreads = qMax(1, QThread::idealThreadCount());
+
+    QVector<int> threadsCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+        threadsCounts << threads;
+    threadsCounts << maxThreads;
+    for (int threads : threadsCounts) {
+        qint64 nsecs = renderOnThreads(labelTemplate, rows, threads);
+        reportMeasurement(QStringLiteral("render on %1 thread(s)").arg(threads), perSecond(LABELS_COUNT, nsecs),
+                          "labels/s");
+    }
+
+    QVector<QByteArray> rendered;
+    qint64 nsecs = measureNsecs(
+        [&labelTemplate, &rows, &rendered]() { rendered = LabelBatchRenderer::render(labelTemplate, rows)->result(); });
+    reportMeasurement(QStringLiteral("LabelBatchRenderer::render() on tasks pool"), perSecond(LABELS_COUNT, nsecs),
+                      "labels/s");
+    ASSERT_EQ(LABELS_COUNT, rendered.count());
+    EXPECT_EQ(labelTemplate.render(rows.last()), rendered.last());
+}
+
+TEST(LabelBatchRendererBenchmark, descriptions)
+{
+    QVector<LabelBatchRenderer::LabelDescription> descriptions;
+    descriptions.reserve(LABELS_COUNT);
+    for (int i = 0; i < LABELS_COUNT; ++i) {
+        descriptions << [i](EplLabelGenerator &generator) {
+            generator.addText(QStringLiteral("MT-%1").arg(i), 10, 20);
+            generator.addBarcode(QString::number(1000000 + i), EplLabelGenerator::BarcodeType::Code128Auto, 10, 200);
+            generator.addPrintCommand();
+        };
+    }
+
+    qint64 sequentialNsecs = measureNsecs([&descriptions]() {
+        for (const auto &description : descriptions) {
+            EplLabelGenerator generator;
+            generator.startLabel();
+            description(generator);
+            generator.labelData();
+        }
+    });
+    QVector<QByteArray> rendered;
+    qint64 batchNsecs = measureNsecs(
+        [&descriptions, &rendered]() { rendered = LabelBatchRenderer::render(descriptions)->result(); });
+
+    reportMeasurement(QStringLiteral("descriptions sequentially"), perSecond(LABELS_COUNT, sequentialNsecs),
+                      "labels/s");
+    reportMeasurement(QStringLiteral("descriptions with LabelBatchRenderer::render()"),
+                      perSecond(LABELS_COUNT, batchNsecs), "labels/s");
+    EXPECT_EQ(LABELS_COUNT, rendered.count());
+}
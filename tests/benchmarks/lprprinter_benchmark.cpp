@@ -0,0 +1,135 @@
+// clazy:skip
+
+#include "proofutils/lprprinter.h"
+
+#include "benchmark_global.h"
+
+#include "../common/fakesocketserver.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <atomic>
+
+using namespace Proof;
+using namespace Proof::Hardware;
+
+static constexpr int PRINTS_COUNT = 50;
+static const QByteArray LABEL = "N\nA10,20,0,4,1,1,N,\"MT-42\"\nP1\n";
+
+//Accepts LPD connections one by one until stopped, acks every job step and replies with same state to queries
+class LpdStandIn
+{
+public:
+    //Benchmark can spend a while between connections, so server waits for them until destroyed
+    LpdStandIn()
+        : server(
+              [this](QTcpSocket *socket) {
+                  serve(socket);
+                  return true;
+              },
+              60 * 1000)
+    {
+        port = server.port();
+    }
+
+    quint16 port = 0;
+    std::atomic<int> jobsCount{0};
+
+private:
+    static QByteArray readLine(QTcpSocket *socket)
+    {
+        while (!socket->canReadLine()) {
+            if (!socket->waitForReadyRead(5000))
+                return QByteArray();
+        }
+        QByteArray line = socket->readLine();
+        line.chop(1);
+        return line;
+    }
+
+    static void ack(QTcpSocket *socket)
+    {
+        socket->write(QByteArray(1, '\0'));
+        socket->waitForBytesWritten(5000);
+    }
+
+    void serve(QTcpSocket *socket)
+    {
+        QByteArray line = readLine(socket);
+        if (line.isEmpty())
+            return;
+        if (line[0] != '\x02') {
+            socket->write("printer is ready\n");
+            socket->waitForBytesWritten(5000);
+            return;
+        }
+        ack(socket);
+        for (int i = 0; i < 2; ++i) {
+            line = readLine(socket);
+            if (line.isEmpty())
+                return;
+            qint64 size = line.mid(1, line.indexOf(' ') - 1).toLongLong() + 1;
+            ack(socket);
+            while (size > 0) {
+                if (!socket->bytesAvailable() && !socket->waitForReadyRead(5000))
+                    return;
+                size -= socket->read(size).size();
+            }
+            ack(socket);
+        }
+        ++jobsCount;
+    }
+
+    FakeSocketServer server;
+};
+
+//Each print checks printer state first, so both paths do same amount of work
+static double averageLatency(const LprPrinter &printer)
+{
+    int succeeded = 0;
+    qint64 nsecs = measureNsecs([&printer, &succeeded]() {
+        for (int i = 0; i < PRINTS_COUNT; ++i) {
+            auto result = printer.printRawData(LABEL);
+            result->wait();
+            if (result->succeeded() && result->result())
+                ++succeeded;
+        }
+    });
+    EXPECT_EQ(PRINTS_COUNT, succeeded);
+    return nsecs / 1e6 / PRINTS_COUNT;
+}
+
+TEST(LprPrinterBenchmark, printLatency)
+{
+    //Instant lpr, lpq and lpoptions, so only processes start cost is measured for process-based path
+    QTemporaryDir binDir;
+    ASSERT_TRUE(binDir.isValid());
+    const QVector<QPair<QString, QByteArray>> tools = {{"lpr", "cat > /dev/null\n"},
+                                                       {"lpq", "echo \"$4 is ready\"\n"},
+                                                       {"lpoptions", "echo \"printer-state=3\"\n"}};
+    for (const auto &tool : tools) {
+        QFile file(binDir.path() + "/" + tool.first);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write("#!/bin/sh\n" + tool.second);
+        file.close();
+        file.setPermissions(QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+    }
+    QByteArray oldPath = qgetenv("PATH");
+    qputenv("PATH", binDir.path().toLocal8Bit() + ':' + oldPath);
+
+    LprPrinter processPrinter(QStringLiteral("127.0.0.1"), QStringLiteral("printer"));
+    processPrinter.setReadinessCacheTtl(0);
+    double processLatency = averageLatency(processPrinter);
+    qputenv("PATH", oldPath);
+
+    LpdStandIn lpd;
+    LprPrinter lpdPrinter(QStringLiteral("127.0.0.1"), QStringLiteral("printer"));
+    lpdPrinter.setReadinessCacheTtl(0);
+    lpdPrinter.setUseNativeLpd(true, lpd.port);
+    double lpdLatency = averageLatency(lpdPrinter);
+
+    reportMeasurement(QStringLiteral("lpq and lpr processes"), processLatency, "ms/label");
+    reportMeasurement(QStringLiteral("native LPD client"), lpdLatency, "ms/label");
+    EXPECT_EQ(PRINTS_COUNT, lpd.jobsCount);
+}
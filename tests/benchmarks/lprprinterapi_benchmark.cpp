@@ -0,0 +1,82 @@
+// clazy:skip
+
+#include "proofnetwork/lprprinter/lprprinterapi.h"
+
+#include "benchmark_global.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+using namespace Proof::NetworkServices;
+using testing::Test;
+
+static constexpr int LABELS_COUNT = 500;
+static constexpr int BATCH_SIZE = 100;
+
+class LprPrinterApiBenchmark : public Test
+{
+protected:
+    void SetUp() override
+    {
+        auto restClient = Proof::RestClientSP::create();
+        restClient->setAuthType(Proof::RestAuthType::NoAuth);
+        restClient->setHost("127.0.0.1");
+        restClient->setPort(9091); //Default port for FakeServer
+        restClient->setScheme("http");
+        restClient->setClientName("Proof-benchmark");
+        lprPrinterApi = new LprPrinterApi(restClient);
+
+        serverRunner = new FakeServerRunner();
+        serverRunner->runServer();
+
+        for (int i = 0; i < LABELS_COUNT; ++i)
+            labels << QByteArray("N\nA10,20,0,4,1,1,N,\"MT-") + QByteArray::number(i) + "\"\nP1\n";
+    }
+
+    void TearDown() override
+    {
+        delete serverRunner;
+        delete lprPrinterApi;
+    }
+
+    LprPrinterApi *lprPrinterApi;
+    FakeServerRunner *serverRunner;
+    QVector<QByteArray> labels;
+};
+
+TEST_F(LprPrinterApiBenchmark, printLabels)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+
+    serverRunner->setServerAnswer(R"({"is_ready": true, "reason": ""})");
+    int printed = 0;
+    qint64 oneByOneNsecs = measureNsecs([this, &printed]() {
+        for (const QByteArray &label : qAsConst(labels)) {
+            auto result = lprPrinterApi->printLabel(label);
+            result->wait();
+            if (result->succeeded() && result->result())
+                ++printed;
+        }
+    });
+    EXPECT_EQ(LABELS_COUNT, printed);
+
+    QJsonArray batchResults;
+    for (int i = 0; i < BATCH_SIZE; ++i)
+        batchResults << QJsonObject{{"printed", true}, {"reason", ""}};
+    serverRunner->setServerAnswer(QJsonDocument(batchResults).toJson(QJsonDocument::Compact));
+    lprPrinterApi->setLabelsBatchSize(BATCH_SIZE);
+    reportMeasurement(QStringLiteral("printLabel() one by one"), perSecond(LABELS_COUNT, oneByOneNsecs), "labels/s");
+
+    for (int batchesInFlight : {1, 4}) {
+        lprPrinterApi->setMaxBatchesInFlight(batchesInFlight);
+        QVector<LprPrinterLabelResult> results;
+        qint64 nsecs = measureNsecs([this, &results]() { results = lprPrinterApi->printLabels(labels)->result(); });
+        ASSERT_EQ(LABELS_COUNT, results.count());
+        EXPECT_TRUE(std::all_of(results.cbegin(), results.cend(), [](const auto &result) { return result.printed; }));
+        reportMeasurement(QStringLiteral("printLabels() with %1 batch(es) in flight").arg(batchesInFlight),
+                          perSecond(LABELS_COUNT, nsecs), "labels/s");
+    }
+}
@@ -0,0 +1,46 @@
+// clazy:skip
+
+#include "proofutils/printspool.h"
+
+#include "benchmark_global.h"
+
+#include <QTemporaryDir>
+
+using namespace Proof;
+
+static constexpr int LABELS_COUNT = 1000;
+
+static double enqueueThroughput(PrintSpool::SyncPolicy syncPolicy)
+{
+    QTemporaryDir dir;
+    EXPECT_TRUE(dir.isValid());
+    PrintSpool spool(dir.path(), syncPolicy);
+    const QString queueName = QStringLiteral("printer");
+    const QByteArray label = "N\nA10,20,0,4,1,1,N,\"MT-42\"\nB10,80,0,1,2,4,200,B,\"1000042\"\nP1\n";
+
+    int succeeded = 0;
+    qint64 nsecs = measureNsecs([&spool, &queueName, &label, &succeeded]() {
+        QVector<FutureSP<bool>> results;
+        results.reserve(LABELS_COUNT);
+        for (int i = 0; i < LABELS_COUNT; ++i)
+            results << spool.enqueue(queueName, label);
+        for (const auto &result : results) {
+            result->wait();
+            if (result->succeeded() && result->result())
+                ++succeeded;
+        }
+    });
+    EXPECT_EQ(LABELS_COUNT, succeeded);
+    EXPECT_EQ(LABELS_COUNT, spool.pendingCount(queueName));
+    return perSecond(LABELS_COUNT, nsecs);
+}
+
+TEST(PrintSpoolBenchmark, enqueue)
+{
+    reportMeasurement(QStringLiteral("enqueue with sync of every job"),
+                      enqueueThroughput(PrintSpool::SyncPolicy::EveryJob), "labels/s");
+    reportMeasurement(QStringLiteral("enqueue with grouped sync"), enqueueThroughput(PrintSpool::SyncPolicy::Grouped),
+                      "labels/s");
+    reportMeasurement(QStringLiteral("enqueue without sync"), enqueueThroughput(PrintSpool::SyncPolicy::None),
+                      "labels/s");
+}
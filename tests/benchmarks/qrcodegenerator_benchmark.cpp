@@ -0,0 +1,57 @@
+// clazy:skip
+
+#include "proofutils/qrcodegenerator.h"
+
+#include "benchmark_global.h"
+
+#include <QColor>
+
+using namespace Proof;
+
+static constexpr int ITERATIONS = 50;
+
+//Per-pixel packing of generated image, the way EPL data was built before modules were packed directly
+static QByteArray packedFromImage(const QString &string, int width)
+{
+    QByteArray result;
+    QImage bitmap = QrCodeGenerator::generateBitmap(string, width);
+    for (int i = 0; i < bitmap.height(); ++i) {
+        for (int j = 0; j < bitmap.width() / 8; ++j) {
+            qint8 byte = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (bitmap.pixel(j * 8 + bit, i) == QColor(Qt::white).rgb())
+                    byte |= 1 << (7 - bit);
+            }
+            result.append(byte);
+        }
+    }
+    return result;
+}
+
+TEST(QrCodeGeneratorBenchmark, eplBinaryData)
+{
+    const qlonglong memoryLimit = QrCodeGenerator::cacheMemoryLimit();
+    QrCodeGenerator::setCacheMemoryLimit(0);
+    const QString data = QStringLiteral("https://example.com/jobs/MT-1234567/labels/42");
+
+    for (int width = 100; width <= 800; width += 100) {
+        QByteArray direct;
+        qint64 directNsecs = measureNsecs([&direct, &data, width]() {
+            for (int i = 0; i < ITERATIONS; ++i)
+                direct = QrCodeGenerator::generateEplBinaryData(data, width);
+        });
+        QByteArray fromImage;
+        qint64 fromImageNsecs = measureNsecs([&fromImage, &data, width]() {
+            for (int i = 0; i < ITERATIONS; ++i)
+                fromImage = packedFromImage(data, width);
+        });
+
+        reportMeasurement(QStringLiteral("generateEplBinaryData(), %1 dots").arg(width),
+                          directNsecs / 1000.0 / ITERATIONS, "us/code");
+        reportMeasurement(QStringLiteral("QImage per-pixel packing, %1 dots").arg(width),
+                          fromImageNsecs / 1000.0 / ITERATIONS, "us/code");
+        EXPECT_EQ(fromImage, direct) << width;
+    }
+
+    QrCodeGenerator::setCacheMemoryLimit(memoryLimit);
+}
@@ -0,0 +1,68 @@
+// clazy:skip
+
+#include "proofutils/rawsocketprinter.h"
+
+#include "benchmark_global.h"
+
+#include "../common/fakesocketserver.h"
+
+using namespace Proof;
+using namespace Proof::Hardware;
+
+static constexpr int LABELS_COUNT = 20000;
+
+//Reads and drops everything from single connection until expected amount of data is received
+class TcpSink
+{
+public:
+    explicit TcpSink(qint64 expectedSize)
+        : server([this, expectedSize](QTcpSocket *socket) {
+              while (receivedSize < expectedSize && socket->waitForReadyRead(5000))
+                  receivedSize += socket->readAll().size();
+              return false;
+          })
+    {
+        port = server.port();
+    }
+
+    void waitForFinished() { server.waitForFinished(); }
+
+    quint16 port = 0;
+    qint64 receivedSize = 0;
+
+private:
+    FakeSocketServer server;
+};
+
+TEST(RawSocketPrinterBenchmark, throughput)
+{
+    QVector<QByteArray> labels;
+    qint64 totalSize = 0;
+    for (int i = 0; i < LABELS_COUNT; ++i) {
+        labels << QByteArray("N\nA10,20,0,4,1,1,N,\"MT-") + QByteArray::number(i) + "\"\nB10,80,0,1,2,4,200,B,\""
+                      + QByteArray::number(1000000 + i) + "\"\nP1\n";
+        totalSize += labels.last().size();
+    }
+
+    TcpSink sink(totalSize);
+    RawSocketPrinter printer(QStringLiteral("127.0.0.1"), sink.port);
+    printer.setMaxPendingSize(totalSize);
+    int succeeded = 0;
+    qint64 nsecs = measureNsecs([&printer, &labels, &sink, &succeeded]() {
+        QVector<FutureSP<bool>> results;
+        results.reserve(labels.count());
+        for (const QByteArray &label : labels)
+            results << printer.printRawData(label);
+        for (const auto &result : results) {
+            result->wait();
+            if (result->succeeded() && result->result())
+                ++succeeded;
+        }
+        sink.waitForFinished();
+    });
+
+    reportMeasurement(QStringLiteral("raw socket printing"), perSecond(LABELS_COUNT, nsecs), "labels/s");
+    reportMeasurement(QStringLiteral("raw socket printing data rate"), perSecond(totalSize, nsecs) / (1 << 20), "MB/s");
+    EXPECT_EQ(LABELS_COUNT, succeeded);
+    EXPECT_EQ(totalSize, sink.receivedSize);
+}
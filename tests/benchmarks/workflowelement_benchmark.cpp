@@ -0,0 +1,184 @@
+// clazy:skip
+
+#include "proofnetwork/mis/data/workflowelement.h"
+
+#include "benchmark_global.h"
+
+#include <QJsonDocument>
+#include <QRegExp>
+#include <QScopedPointer>
+
+using namespace Proof::Mis;
+
+static constexpr int ELEMENTS_COUNT = 1000000;
+
+//Element with private part on heap, the way WorkflowElement was stored before it became packed value
+class HeapWorkflowElement
+{
+public:
+    HeapWorkflowElement() : d(new Data) {}
+    HeapWorkflowElement(WorkflowAction action, WorkflowStatus status, PaperSide paperSide) : d(new Data)
+    {
+        d->action = action;
+        d->status = status;
+        d->paperSide = paperSide;
+    }
+    HeapWorkflowElement(const HeapWorkflowElement &other) : d(new Data(*other.d)) {}
+    HeapWorkflowElement &operator=(const HeapWorkflowElement &other)
+    {
+        *d = *other.d;
+        return *this;
+    }
+
+    WorkflowAction action() const { return d->action; }
+    WorkflowStatus status() const { return d->status; }
+    PaperSide paperSide() const { return d->paperSide; }
+
+    bool operator==(const HeapWorkflowElement &other) const
+    {
+        return d->action == other.d->action && d->status == other.d->status && d->paperSide == other.d->paperSide;
+    }
+    bool operator!=(const HeapWorkflowElement &other) const { return !(*this == other); }
+
+    struct Data
+    {
+        void *q_ptr = nullptr;
+        WorkflowAction action = WorkflowAction::UnknownAction;
+        WorkflowStatus status = WorkflowStatus::UnknownStatus;
+        PaperSide paperSide = PaperSide::NotSetSide;
+    };
+
+private:
+    QScopedPointer<Data> d;
+};
+
+static WorkflowAction actionAt(int i)
+{
+    return static_cast<WorkflowAction>(i % static_cast<int>(WorkflowAction::UnknownAction));
+}
+
+static WorkflowStatus statusAt(int i)
+{
+    return static_cast<WorkflowStatus>(i % static_cast<int>(WorkflowStatus::UnknownStatus));
+}
+
+static PaperSide sideAt(int i)
+{
+    return static_cast<PaperSide>(i % 3);
+}
+
+//Parses element with QRegExp, the way WorkflowElement(const QString &) did before tokenizer
+static WorkflowElement parsedWithRegExp(const QString &string)
+{
+    WorkflowElement element;
+    QRegExp re("([^:]*)\\:([^:]*)(?:\\:([^:]*))?");
+    if (re.indexIn(string) != -1) {
+        element.setStatus(workflowStatusFromString(re.cap(1)));
+        element.setAction(workflowActionFromString(re.cap(2)));
+        if (re.captureCount() > 2)
+            element.setPaperSide(paperSideFromString(re.cap(3)));
+    }
+    return element;
+}
+
+//Copies workflow the way Job does it, compares copy with original and looks up status of each action
+template <typename Element>
+static void iterateWorkflow(const QString &name)
+{
+    QVector<Element> workflow;
+    qint64 fillNsecs = measureNsecs([&workflow]() {
+        workflow.reserve(ELEMENTS_COUNT);
+        for (int i = 0; i < ELEMENTS_COUNT; ++i)
+            workflow.append(Element(actionAt(i), statusAt(i), sideAt(i)));
+    });
+
+    QVector<Element> copy;
+    qint64 copyNsecs = measureNsecs([&workflow, &copy]() {
+        copy = workflow;
+        copy.detach();
+    });
+
+    bool equal = false;
+    qint64 compareNsecs = measureNsecs([&workflow, &copy, &equal]() { equal = workflow == copy; });
+    EXPECT_TRUE(equal);
+
+    int found = 0;
+    qint64 lookupNsecs = measureNsecs([&workflow, &found]() {
+        for (const auto &element : qAsConst(workflow)) {
+            if (element.action() == WorkflowAction::CuttingAction && element.paperSide() == PaperSide::NotSetSide)
+                ++found;
+        }
+    });
+    EXPECT_GT(found, 0);
+
+    reportMeasurement(name + QStringLiteral(" fill"), static_cast<double>(fillNsecs) / ELEMENTS_COUNT, "ns/element");
+    reportMeasurement(name + QStringLiteral(" copy"), static_cast<double>(copyNsecs) / ELEMENTS_COUNT, "ns/element");
+    reportMeasurement(name + QStringLiteral(" compare"), static_cast<double>(compareNsecs) / ELEMENTS_COUNT,
+                      "ns/element");
+    reportMeasurement(name + QStringLiteral(" lookup"), static_cast<double>(lookupNsecs) / ELEMENTS_COUNT,
+                      "ns/element");
+}
+
+TEST(WorkflowElementBenchmark, memory)
+{
+    //Heap part is counted without allocator overhead, so real difference is even bigger
+    reportMeasurement(QStringLiteral("packed element"), sizeof(WorkflowElement), "bytes/element");
+    reportMeasurement(QStringLiteral("heap element"), sizeof(HeapWorkflowElement) + sizeof(HeapWorkflowElement::Data),
+                      "bytes/element");
+    EXPECT_LT(sizeof(WorkflowElement), sizeof(HeapWorkflowElement) + sizeof(HeapWorkflowElement::Data));
+}
+
+TEST(WorkflowElementBenchmark, iteration)
+{
+    iterateWorkflow<WorkflowElement>(QStringLiteral("packed element"));
+    iterateWorkflow<HeapWorkflowElement>(QStringLiteral("heap element"));
+}
+
+TEST(WorkflowElementBenchmark, parse)
+{
+    QJsonArray corpus;
+    for (int i = 0; i < ELEMENTS_COUNT; ++i)
+        corpus << WorkflowElement(actionAt(i), statusAt(i), sideAt(i)).toString();
+    QByteArray rawCorpus = QJsonDocument(corpus).toJson(QJsonDocument::Compact);
+    QVector<QString> strings;
+    strings.reserve(ELEMENTS_COUNT);
+    for (const auto &value : qAsConst(corpus))
+        strings << value.toString();
+
+    QVector<WorkflowElement> fromStrings;
+    fromStrings.reserve(ELEMENTS_COUNT);
+    qint64 stringsNsecs = measureNsecs([&strings, &fromStrings]() {
+        for (const QString &string : qAsConst(strings))
+            fromStrings << WorkflowElement::fromString(QStringRef(&string));
+    });
+
+    QVector<WorkflowElement> withRegExp;
+    withRegExp.reserve(ELEMENTS_COUNT);
+    qint64 regExpNsecs = measureNsecs([&strings, &withRegExp]() {
+        for (const QString &string : qAsConst(strings))
+            withRegExp << parsedWithRegExp(string);
+    });
+
+    QVector<WorkflowElement> fromJsonArray;
+    qint64 jsonArrayNsecs = measureNsecs(
+        [&corpus, &fromJsonArray]() { fromJsonArray = WorkflowElement::workflowFromJson(corpus); });
+
+    QVector<WorkflowElement> fromRawJson;
+    bool ok = false;
+    qint64 rawJsonNsecs = measureNsecs(
+        [&rawCorpus, &fromRawJson, &ok]() { fromRawJson = WorkflowElement::workflowFromJson(rawCorpus, &ok); });
+
+    reportMeasurement(QStringLiteral("fromString()"), static_cast<double>(stringsNsecs) / ELEMENTS_COUNT,
+                      "ns/element");
+    reportMeasurement(QStringLiteral("QRegExp parsing"), static_cast<double>(regExpNsecs) / ELEMENTS_COUNT,
+                      "ns/element");
+    reportMeasurement(QStringLiteral("workflowFromJson() from QJsonArray"),
+                      static_cast<double>(jsonArrayNsecs) / ELEMENTS_COUNT, "ns/element");
+    reportMeasurement(QStringLiteral("workflowFromJson() from raw JSON"),
+                      static_cast<double>(rawJsonNsecs) / ELEMENTS_COUNT, "ns/element");
+
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(withRegExp, fromStrings);
+    EXPECT_EQ(fromStrings, fromJsonArray);
+    EXPECT_EQ(fromStrings, fromRawJson);
+}
@@ -0,0 +1,103 @@
+// clazy:skip
+
+#ifndef PROOF_TESTS_FAKESOCKETSERVER_H
+#define PROOF_TESTS_FAKESOCKETSERVER_H
+
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <thread>
+
+//Local TCP server running in its own thread, for clients that talk raw protocols instead of HTTP (see FakeServer).
+//Accepted connections are passed one by one to handler in server thread, handler returns false if no more
+//connections should be served. Server stops if no client connects for acceptTimeout msecs or after stop().
+//Handler can write to members of its owner, they can be read from test thread after waitForFinished() or stop().
+class FakeSocketServer
+{
+public:
+    using Handler = std::function<bool(QTcpSocket *socket)>;
+
+    explicit FakeSocketServer(const Handler &handler, int acceptTimeout = 5000)
+    {
+        std::promise<quint16> portPromise;
+        std::future<quint16> portFuture = portPromise.get_future();
+        thread = std::thread([this, handler, acceptTimeout, &portPromise]() {
+            QTcpServer server;
+            server.listen(QHostAddress::LocalHost);
+            portPromise.set_value(server.serverPort());
+            QElapsedTimer idleTimer;
+            idleTimer.start();
+            while (!stopped && idleTimer.elapsed() < acceptTimeout) {
+                if (!server.waitForNewConnection(50))
+                    continue;
+                QScopedPointer<QTcpSocket> socket(server.nextPendingConnection());
+                bool proceed = handler(socket.data());
+                socket->disconnectFromHost();
+                if (socket->state() != QAbstractSocket::UnconnectedState)
+                    socket->waitForDisconnected(1000);
+                if (!proceed)
+                    return;
+                idleTimer.restart();
+            }
+        });
+        serverPort = portFuture.get();
+    }
+
+    ~FakeSocketServer() { stop(); }
+
+    quint16 port() const { return serverPort; }
+    //Handlers that serve connection until server is stopped should check it periodically
+    bool isStopped() const { return stopped; }
+
+    void stop()
+    {
+        stopped = true;
+        waitForFinished();
+    }
+
+    void waitForFinished()
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+
+    //Port nobody listens at, for connection failure tests
+    static quint16 closedPort()
+    {
+        QTcpServer server;
+        server.listen(QHostAddress::LocalHost);
+        return server.serverPort();
+    }
+
+    //Reads everything client sends until it disconnects, server is stopped or nothing comes for timeout msecs
+    static QByteArray readAll(QTcpSocket *socket, const FakeSocketServer *server = nullptr, int timeout = 5000)
+    {
+        QByteArray result;
+        QElapsedTimer idleTimer;
+        idleTimer.start();
+        while (idleTimer.elapsed() < timeout && (!server || !server->isStopped())) {
+            if (socket->waitForReadyRead(50)) {
+                result.append(socket->readAll());
+                idleTimer.restart();
+            } else if (socket->state() != QAbstractSocket::ConnectedState) {
+                break;
+            }
+        }
+        while (socket->waitForReadyRead(200))
+            result.append(socket->readAll());
+        result.append(socket->readAll());
+        return result;
+    }
+
+private:
+    std::atomic<bool> stopped{false};
+    quint16 serverPort = 0;
+    std::thread thread;
+};
+
+#endif // PROOF_TESTS_FAKESOCKETSERVER_H
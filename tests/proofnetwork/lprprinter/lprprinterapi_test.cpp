@@ -4,11 +4,72 @@
 
 #include "gtest/proof/test_global.h"
 
+#include "../../common/fakesocketserver.h"
+
 #include <QFile>
+#include <QTemporaryFile>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
 
 using namespace Proof::NetworkServices;
 using testing::Test;
 
+//Answers each request with the same reply, but only after release() is called.
+//Lets tests make sure that all calls are made while request is still in flight
+class HeldReplyServer
+{
+public:
+    explicit HeldReplyServer(const QByteArray &reply)
+        : server([this, reply](QTcpSocket *socket) {
+              serve(socket, reply);
+              return true;
+          })
+    {}
+
+    Proof::RestClientSP restClient() const
+    {
+        auto client = Proof::RestClientSP::create();
+        client->setAuthType(Proof::RestAuthType::NoAuth);
+        client->setHost("127.0.0.1");
+        client->setPort(server.port());
+        client->setScheme("http");
+        client->setClientName("Proof-test");
+        return client;
+    }
+
+    //Waits until server gets count requests, returns false if they don't come in 5 seconds
+    bool waitForRequest(int count)
+    {
+        for (int i = 0; i < 500 && requests < count; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return requests >= count;
+    }
+
+    void release() { releasePromise.set_value(); }
+    int requestsCount() const { return requests; }
+
+private:
+    void serve(QTcpSocket *socket, const QByteArray &reply)
+    {
+        QByteArray request;
+        while (!request.contains("\r\n\r\n") && socket->waitForReadyRead(5000))
+            request.append(socket->readAll());
+        ++requests;
+        releaseFuture.wait_for(std::chrono::seconds(5));
+        socket->write(QByteArray("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nConnection: close\r\n")
+                      + "Content-Length: " + QByteArray::number(reply.size()) + "\r\n\r\n" + reply);
+        socket->waitForBytesWritten(5000);
+    }
+
+    std::promise<void> releasePromise;
+    std::shared_future<void> releaseFuture = releasePromise.get_future().share();
+    std::atomic<int> requests{0};
+    FakeSocketServer server;
+};
+
 class LprPrinterApiTest : public Test
 {
 public:
@@ -76,6 +137,101 @@ TEST_F(LprPrinterApiTest, fetchBadStatus)
     EXPECT_EQ("Some error occurred", result.reason);
 }
 
+TEST_F(LprPrinterApiTest, fetchStatusSingleFlight)
+{
+    QByteArray json = dataFromFile(":/data/status.json").trimmed();
+    ASSERT_FALSE(json.isEmpty());
+    HeldReplyServer server(json);
+    LprPrinterApi api(server.restClient());
+
+    auto first = api.fetchStatus("Zebra");
+    ASSERT_TRUE(server.waitForRequest(1));
+    auto second = api.fetchStatus("Zebra");
+    auto third = api.fetchStatus("Zebra");
+    EXPECT_EQ(2, api.deduplicatedRequestsCount());
+    server.release();
+    for (const auto &result : {first, second, third}) {
+        result->wait();
+        ASSERT_TRUE(result->succeeded());
+        EXPECT_TRUE(result->result().isReady);
+    }
+    EXPECT_EQ(1, server.requestsCount());
+    EXPECT_EQ(0, api.cachedRepliesCount());
+
+    auto afterFinish = api.fetchStatus("Zebra");
+    afterFinish->wait();
+    ASSERT_TRUE(afterFinish->succeeded());
+    EXPECT_EQ(2, server.requestsCount());
+    EXPECT_EQ(2, api.deduplicatedRequestsCount());
+}
+
+TEST_F(LprPrinterApiTest, fetchStatusInvalidatedInFlight)
+{
+    QByteArray json = dataFromFile(":/data/status.json").trimmed();
+    ASSERT_FALSE(json.isEmpty());
+    HeldReplyServer server(json);
+    LprPrinterApi api(server.restClient());
+    api.setStatusCacheTtl(60000);
+
+    auto stale = api.fetchStatus("Zebra");
+    ASSERT_TRUE(server.waitForRequest(1));
+    api.invalidateStatusCache();
+    auto fresh = api.fetchStatus("Zebra");
+    EXPECT_EQ(0, api.deduplicatedRequestsCount());
+    server.release();
+    stale->wait();
+    ASSERT_TRUE(stale->succeeded());
+    fresh->wait();
+    ASSERT_TRUE(fresh->succeeded());
+    EXPECT_EQ(2, server.requestsCount());
+
+    EXPECT_TRUE(api.fetchStatus("Zebra")->result().isReady);
+    EXPECT_EQ(2, server.requestsCount());
+    EXPECT_EQ(1, api.cachedRepliesCount());
+}
+
+TEST_F(LprPrinterApiTest, fetchStatusSingleFlightCancel)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+
+    QByteArray json = dataFromFile(":/data/status.json").trimmed();
+    ASSERT_FALSE(json.isEmpty());
+    serverRunner->setServerAnswer(json);
+
+    auto first = lprPrinterApi->fetchStatus("Zebra");
+    auto second = lprPrinterApi->fetchStatus("Zebra");
+    first.cancel();
+    first->wait();
+    EXPECT_TRUE(first->failed());
+    second->wait();
+    ASSERT_TRUE(second->succeeded());
+    EXPECT_TRUE(second->result().isReady);
+    EXPECT_EQ(1, lprPrinterApi->deduplicatedRequestsCount());
+}
+
+TEST_F(LprPrinterApiTest, fetchStatusCache)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+
+    QByteArray json = dataFromFile(":/data/status.json").trimmed();
+    ASSERT_FALSE(json.isEmpty());
+    serverRunner->setServerAnswer(json);
+    lprPrinterApi->setStatusCacheTtl(60000);
+    EXPECT_EQ(60000, lprPrinterApi->statusCacheTtl());
+
+    EXPECT_TRUE(lprPrinterApi->fetchStatus()->result().isReady);
+
+    json = dataFromFile(":/data/failed_status.json").trimmed();
+    ASSERT_FALSE(json.isEmpty());
+    serverRunner->setServerAnswer(json);
+    EXPECT_TRUE(lprPrinterApi->fetchStatus()->result().isReady);
+    EXPECT_EQ(1, lprPrinterApi->cachedRepliesCount());
+
+    lprPrinterApi->invalidateStatusCache();
+    EXPECT_FALSE(lprPrinterApi->fetchStatus()->result().isReady);
+    EXPECT_EQ(1, lprPrinterApi->cachedRepliesCount());
+}
+
 TEST_F(LprPrinterApiTest, printLabel)
 {
     ASSERT_TRUE(serverRunner->serverIsRunning());
@@ -84,13 +240,13 @@ TEST_F(LprPrinterApiTest, printLabel)
     ASSERT_FALSE(json.isEmpty());
     serverRunner->setServerAnswer(json);
 
-    auto result = lprPrinterApi->printLabel("something");
+    QByteArray label("N\nGW10,10,1,2,\x00\xff\nP1\n", 20);
+    auto result = lprPrinterApi->printLabel(label);
     result->wait();
 
     EXPECT_EQ(FakeServer::Method::Post, serverRunner->lastQueryMethod());
-    EXPECT_EQ(QUrl("/lpr/print-raw"), serverRunner->lastQueryUrl());
-    auto bodyObject = QJsonDocument::fromJson(serverRunner->lastQueryBody()).object();
-    EXPECT_EQ(QByteArray("something").toBase64().constData(), bodyObject["data"].toString().toLatin1());
+    EXPECT_EQ(QUrl("/lpr/print-raw/binary"), serverRunner->lastQueryUrl());
+    EXPECT_EQ(label, serverRunner->lastQueryBody());
 
     ASSERT_TRUE(result->succeeded());
     EXPECT_TRUE(result->result());
@@ -107,12 +263,85 @@ TEST_F(LprPrinterApiTest, failedPrintLabel)
     auto result = lprPrinterApi->printLabel("something");
     result->wait();
     EXPECT_EQ(FakeServer::Method::Post, serverRunner->lastQueryMethod());
+    EXPECT_EQ(QUrl("/lpr/print-raw/binary"), serverRunner->lastQueryUrl());
+    EXPECT_EQ("something", serverRunner->lastQueryBody());
+
+    ASSERT_TRUE(result->failed());
+    EXPECT_EQ("Some error occurred", result->failureReason().message);
+}
+
+TEST_F(LprPrinterApiTest, printLabelJsonFallback)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+
+    serverRunner->setResultCode(404, "Not Found");
+    serverRunner->setServerAnswer("");
+    auto result = lprPrinterApi->printLabel("something");
+    result->wait();
+    ASSERT_TRUE(result->failed());
+    EXPECT_EQ(FakeServer::Method::Post, serverRunner->lastQueryMethod());
     EXPECT_EQ(QUrl("/lpr/print-raw"), serverRunner->lastQueryUrl());
     auto bodyObject = QJsonDocument::fromJson(serverRunner->lastQueryBody()).object();
     EXPECT_EQ(QByteArray("something").toBase64().constData(), bodyObject["data"].toString().toLatin1());
 
-    ASSERT_TRUE(result->failed());
-    EXPECT_EQ("Some error occurred", result->failureReason().message);
+    QByteArray json = dataFromFile(":/data/status.json").trimmed();
+    ASSERT_FALSE(json.isEmpty());
+    serverRunner->setResultCode(200, "OK");
+    serverRunner->setServerAnswer(json);
+    result = lprPrinterApi->printLabel("something else");
+    result->wait();
+    EXPECT_EQ(QUrl("/lpr/print-raw"), serverRunner->lastQueryUrl());
+    bodyObject = QJsonDocument::fromJson(serverRunner->lastQueryBody()).object();
+    EXPECT_EQ(QByteArray("something else").toBase64().constData(), bodyObject["data"].toString().toLatin1());
+    ASSERT_TRUE(result->succeeded());
+    EXPECT_TRUE(result->result());
+}
+
+TEST_F(LprPrinterApiTest, printLabels)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+
+    QByteArray json = dataFromFile(":/data/batch_results.json").trimmed();
+    ASSERT_FALSE(json.isEmpty());
+    serverRunner->setServerAnswer(json);
+
+    lprPrinterApi->setLabelsBatchSize(2);
+    lprPrinterApi->setMaxBatchesInFlight(1);
+    auto result = lprPrinterApi->printLabels({"first", "second", "third"}, "Zebra");
+    result->wait();
+
+    EXPECT_EQ(FakeServer::Method::Post, serverRunner->lastQueryMethod());
+    EXPECT_EQ(QUrl("/lpr/print-raw/batch?printer=Zebra"), serverRunner->lastQueryUrl());
+    EXPECT_EQ(QByteArray("\x00\x00\x00\x05third", 9), serverRunner->lastQueryBody());
+
+    ASSERT_TRUE(result->succeeded());
+    auto results = result->result();
+    ASSERT_EQ(3, results.count());
+    EXPECT_TRUE(results[0].printed);
+    EXPECT_FALSE(results[1].printed);
+    EXPECT_EQ("Printer is out of paper", results[1].reason);
+    EXPECT_TRUE(results[2].printed);
+}
+
+TEST_F(LprPrinterApiTest, printLabelsFallback)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+
+    serverRunner->setResultCode(404, "Not Found");
+    serverRunner->setServerAnswer("");
+    auto result = lprPrinterApi->printLabels({"first", "second"});
+    result->wait();
+
+    EXPECT_EQ(FakeServer::Method::Post, serverRunner->lastQueryMethod());
+    EXPECT_EQ(QUrl("/lpr/print-raw"), serverRunner->lastQueryUrl());
+    //Labels are sent in order, next one only after previous is finished
+    EXPECT_EQ("second", serverRunner->lastQueryBody());
+
+    ASSERT_TRUE(result->succeeded());
+    auto results = result->result();
+    ASSERT_EQ(2, results.count());
+    EXPECT_FALSE(results[0].printed);
+    EXPECT_FALSE(results[1].printed);
 }
 
 TEST_F(LprPrinterApiTest, printFile)
@@ -137,6 +366,33 @@ TEST_F(LprPrinterApiTest, printFile)
     EXPECT_TRUE(result->result());
 }
 
+TEST_F(LprPrinterApiTest, printBigFile)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+
+    QByteArray json = dataFromFile(":/data/status.json").trimmed();
+    ASSERT_FALSE(json.isEmpty());
+    serverRunner->setServerAnswer(json);
+
+    QTemporaryFile file;
+    ASSERT_TRUE(file.open());
+    QByteArray content;
+    for (int i = 0; i < 64 * 1024; ++i)
+        content.append(QByteArray::number(i % 10000).rightJustified(16, ' '));
+    file.write(content);
+    file.close();
+
+    auto result = lprPrinterApi->printFile(file.fileName(), "Zebra", 2);
+    result->wait();
+
+    EXPECT_EQ(FakeServer::Method::Post, serverRunner->lastQueryMethod());
+    EXPECT_EQ(QUrl("/lpr/print?copies=2&printer=Zebra"), serverRunner->lastQueryUrl());
+    EXPECT_EQ(content, serverRunner->lastQueryBody());
+
+    ASSERT_TRUE(result->succeeded());
+    EXPECT_TRUE(result->result());
+}
+
 TEST_F(LprPrinterApiTest, failedPrintFile)
 {
     ASSERT_TRUE(serverRunner->serverIsRunning());
@@ -0,0 +1,135 @@
+// clazy:skip
+
+#include "proofnetwork/lprprinter/lprprinterstatuswatcher.h"
+
+#include "gtest/proof/test_global.h"
+
+#include "../../common/fakesocketserver.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <chrono>
+#include <future>
+
+using namespace Proof;
+using namespace Proof::NetworkServices;
+
+//Serves one server-sent events stream with given events and keeps it open until destroyed
+class FakeEventsServer
+{
+public:
+    explicit FakeEventsServer(const QVector<QByteArray> &events)
+        : server([this, events](QTcpSocket *socket) {
+              serve(socket, events);
+              return false;
+          })
+    {
+        port = server.port();
+    }
+
+    //Request line is set in server thread, so it is passed to test thread through future
+    QByteArray requestLine()
+    {
+        if (requestLineFuture.wait_for(std::chrono::seconds(5)) != std::future_status::ready)
+            return QByteArray();
+        return requestLineFuture.get();
+    }
+
+    quint16 port = 0;
+
+private:
+    void serve(QTcpSocket *socket, const QVector<QByteArray> &events)
+    {
+        QByteArray request;
+        while (!request.contains("\r\n\r\n") && socket->waitForReadyRead(5000))
+            request.append(socket->readAll());
+        requestLinePromise.set_value(request.left(request.indexOf("\r\n")));
+        socket->write("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n\r\n");
+        for (const QByteArray &event : events) {
+            socket->write(event);
+            socket->waitForBytesWritten(5000);
+            QThread::msleep(20);
+        }
+        while (!server.isStopped())
+            QThread::msleep(10);
+    }
+
+    std::promise<QByteArray> requestLinePromise;
+    std::shared_future<QByteArray> requestLineFuture = requestLinePromise.get_future().share();
+    FakeSocketServer server;
+};
+
+static RestClientSP restClient(quint16 port)
+{
+    auto client = RestClientSP::create();
+    client->setAuthType(RestAuthType::NoAuth);
+    client->setHost("127.0.0.1");
+    client->setPort(port);
+    client->setScheme("http");
+    client->setClientName("Proof-test");
+    return client;
+}
+
+static void waitFor(const std::function<bool()> &condition)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!condition() && timer.elapsed() < 5000)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+}
+
+TEST(LprPrinterStatusWatcherTest, pushedTransitions)
+{
+    FakeEventsServer server({"data: {\"is_ready\": true, \"reason\": \"\"}\n\n",
+                             ": keep-alive\n\ndata: {\"is_ready\": true, \"reason\": \"\"}\n\n",
+                             "event: status\r\ndata: {\"is_ready\": false,\r\n"
+                             "data: \"reason\": \"Out of paper\"}\r\n\r\n",
+                             "data: {\"is_ready\": false, \"reason\": \"Out of paper\"}\n\n"});
+    LprPrinterStatusWatcher watcher(restClient(server.port), "Zebra");
+    QVector<LprPrinterStatus> statuses;
+    QObject::connect(&watcher, &LprPrinterStatusWatcher::statusChanged, &watcher,
+                     [&statuses](const LprPrinterStatus &status) { statuses << status; });
+    watcher.start();
+    waitFor([&statuses]() { return statuses.count() >= 2; });
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 100);
+    watcher.stop();
+
+    EXPECT_TRUE(server.requestLine().startsWith("GET /lpr/status/events?printer=Zebra "));
+    ASSERT_EQ(2, statuses.count());
+    EXPECT_TRUE(statuses[0].isReady);
+    EXPECT_FALSE(statuses[1].isReady);
+    EXPECT_EQ("Out of paper", statuses[1].reason);
+    EXPECT_EQ("Out of paper", watcher.status().reason);
+}
+
+TEST(LprPrinterStatusWatcherTest, pollingFallback)
+{
+    FakeServerRunner serverRunner;
+    serverRunner.runServer();
+    ASSERT_TRUE(serverRunner.serverIsRunning());
+    QByteArray json = dataFromFile(":/data/failed_status.json").trimmed();
+    ASSERT_FALSE(json.isEmpty());
+    serverRunner.setServerAnswer(json);
+
+    LprPrinterStatusWatcher watcher(restClient(9091));
+    watcher.setPollingInterval(50);
+    QVector<LprPrinterStatus> statuses;
+    QObject::connect(&watcher, &LprPrinterStatusWatcher::statusChanged, &watcher,
+                     [&statuses](const LprPrinterStatus &status) { statuses << status; });
+    watcher.start();
+    waitFor([&statuses]() { return !statuses.isEmpty(); });
+    ASSERT_EQ(1, statuses.count());
+    EXPECT_FALSE(statuses[0].isReady);
+    EXPECT_FALSE(watcher.isPushActive());
+
+    json = dataFromFile(":/data/status.json").trimmed();
+    serverRunner.setServerAnswer(json);
+    waitFor([&statuses]() { return statuses.count() >= 2; });
+    watcher.stop();
+    ASSERT_EQ(2, statuses.count());
+    EXPECT_TRUE(statuses[1].isReady);
+    EXPECT_EQ(FakeServer::Method::Get, serverRunner.lastQueryMethod());
+    EXPECT_EQ(QUrl("/lpr/status"), serverRunner.lastQueryUrl());
+}
@@ -0,0 +1,93 @@
+// clazy:skip
+
+#include "proofnetwork/mis/apihelper.h"
+
+#include "gtest/proof/test_global.h"
+
+#include <QMetaEnum>
+
+using namespace Proof::Mis;
+
+//Checks that every value with string representation survives round trip through all fromString() overloads
+template <typename Enum>
+static void checkRoundTrip(QString (*toString)(Enum), Enum (*fromString)(QString, bool *),
+                           Enum (*fromStringRef)(const QStringRef &, bool *),
+                           Enum (*fromLatin1)(QLatin1String, bool *), int namedCount)
+{
+    QMetaEnum metaEnum = QMetaEnum::fromType<Enum>();
+    int named = 0;
+    for (int i = 0; i < metaEnum.keyCount(); ++i) {
+        Enum value = static_cast<Enum>(metaEnum.value(i));
+        QString string = toString(value);
+        if (string.isNull())
+            continue;
+        ++named;
+        bool ok = false;
+        EXPECT_EQ(value, fromString(string, &ok)) << metaEnum.key(i);
+        EXPECT_TRUE(ok) << metaEnum.key(i);
+
+        QString padded = "<" + string.toUpper() + ">";
+        ok = false;
+        EXPECT_EQ(value, fromStringRef(padded.midRef(1, string.size()), &ok)) << metaEnum.key(i);
+        EXPECT_TRUE(ok) << metaEnum.key(i);
+
+        QByteArray latin1 = string.toLatin1();
+        ok = false;
+        EXPECT_EQ(value, fromLatin1(QLatin1String(latin1.constData(), latin1.size()), &ok)) << metaEnum.key(i);
+        EXPECT_TRUE(ok) << metaEnum.key(i);
+    }
+    EXPECT_EQ(namedCount, named);
+}
+
+TEST(ApiHelperTest, roundTrip)
+{
+    checkRoundTrip<EntityStatus>(entityStatusToString, entityStatusFromString, entityStatusFromString,
+                                 entityStatusFromString, 4);
+    checkRoundTrip<WorkflowStatus>(workflowStatusToString, workflowStatusFromString, workflowStatusFromString,
+                                   workflowStatusFromString, 6);
+    checkRoundTrip<WorkflowAction>(workflowActionToString, workflowActionFromString, workflowActionFromString,
+                                   workflowActionFromString, 45);
+    checkRoundTrip<TransitionEvent>(transitionEventToString, transitionEventFromString, transitionEventFromString,
+                                    transitionEventFromString, 8);
+    checkRoundTrip<PaperSide>(paperSideToString, paperSideFromString, paperSideFromString, paperSideFromString, 3);
+}
+
+TEST(ApiHelperTest, toString)
+{
+    EXPECT_EQ("not ready", entityStatusToString(EntityStatus::NotReadyEntity));
+    EXPECT_EQ("is ready for", workflowStatusToString(WorkflowStatus::IsReadyForStatus));
+    EXPECT_EQ("pdf vt building", workflowActionToString(WorkflowAction::PdfVtBuildingAction));
+    EXPECT_EQ("request", transitionEventToString(TransitionEvent::RequestEvent));
+    EXPECT_EQ("back", paperSideToString(PaperSide::BackSide));
+    EXPECT_TRUE(paperSideToString(PaperSide::NotSetSide).isEmpty());
+
+    EXPECT_TRUE(workflowStatusToString(WorkflowStatus::UnknownStatus).isNull());
+    EXPECT_TRUE(workflowActionToString(WorkflowAction::UnknownAction).isNull());
+    EXPECT_TRUE(transitionEventToString(TransitionEvent::UnknownEvent).isNull());
+    EXPECT_TRUE(workflowActionToString(static_cast<WorkflowAction>(1000)).isNull());
+}
+
+TEST(ApiHelperTest, unknownStrings)
+{
+    bool ok = true;
+    EXPECT_EQ(EntityStatus::InvalidEntity, entityStatusFromString("not  ready", &ok));
+    EXPECT_FALSE(ok);
+    ok = true;
+    EXPECT_EQ(WorkflowStatus::UnknownStatus, workflowStatusFromString("", &ok));
+    EXPECT_FALSE(ok);
+    ok = true;
+    EXPECT_EQ(WorkflowAction::UnknownAction, workflowActionFromString("printin", &ok));
+    EXPECT_FALSE(ok);
+    ok = true;
+    EXPECT_EQ(WorkflowAction::UnknownAction, workflowActionFromString(QLatin1String("printings"), &ok));
+    EXPECT_FALSE(ok);
+    ok = true;
+    EXPECT_EQ(TransitionEvent::UnknownEvent, transitionEventFromString(QString::fromUtf8("st\xc3\xa1rt"), &ok));
+    EXPECT_FALSE(ok);
+    ok = false;
+    EXPECT_EQ(PaperSide::NotSetSide, paperSideFromString("", &ok));
+    EXPECT_TRUE(ok);
+    ok = true;
+    EXPECT_EQ(PaperSide::NotSetSide, paperSideFromString("middle", &ok));
+    EXPECT_FALSE(ok);
+}
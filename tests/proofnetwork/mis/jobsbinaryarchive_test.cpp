@@ -0,0 +1,151 @@
+// clazy:skip
+
+#include "proofnetwork/mis/data/job.h"
+#include "proofnetwork/mis/jobsbinaryarchive.h"
+
+#include "gtest/proof/test_global.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+
+#include <limits>
+
+using namespace Proof::Mis;
+
+static QVector<JobSP> jobs(int count)
+{
+    QVector<JobSP> result;
+    for (int i = 0; i < count; ++i) {
+        JobSP job = Job::create(QStringLiteral("job-%1").arg(i), QStringLiteral("metrix"));
+        job->setName(QStringLiteral("MT-%1").arg(i % 10));
+        job->setStatus(i % 2 ? EntityStatus::NotReadyEntity : EntityStatus::ValidEntity);
+        job->setQuantity(i * 100);
+        job->setWidth(2016.0);
+        job->setHeight(i % 3 ? 1350.0 : 1350.5);
+        job->setPageCount(i);
+        job->setHasPreview(i % 2);
+        job->setWorkflowStatus(WorkflowAction::CuttingAction, WorkflowStatus::IsReadyForStatus);
+        job->setWorkflowStatus(WorkflowAction::PrintingAction, WorkflowStatus::NeedsStatus, PaperSide::BackSide);
+        result << job;
+    }
+    return result;
+}
+
+static void expectSameJobs(const JobSP &expected, const JobSP &actual)
+{
+    ASSERT_TRUE(actual);
+    EXPECT_EQ(expected->id(), actual->id());
+    EXPECT_EQ(expected->source(), actual->source());
+    EXPECT_EQ(expected->name(), actual->name());
+    EXPECT_EQ(expected->status(), actual->status());
+    EXPECT_EQ(expected->quantity(), actual->quantity());
+    EXPECT_DOUBLE_EQ(expected->width(), actual->width());
+    EXPECT_DOUBLE_EQ(expected->height(), actual->height());
+    EXPECT_EQ(expected->pageCount(), actual->pageCount());
+    EXPECT_EQ(expected->hasPreview(), actual->hasPreview());
+    EXPECT_EQ(expected->toJson(), actual->toJson());
+    EXPECT_TRUE(actual->isFetched());
+}
+
+TEST(JobsBinaryArchiveTest, roundTrip)
+{
+    QVector<JobSP> original = jobs(50);
+    original << Job::create(QString(), QString());
+    JobSP extreme = Job::create(QStringLiteral("Ünïcödé"));
+    extreme->setQuantity(std::numeric_limits<qlonglong>::min());
+    extreme->setWidth(-0.0);
+    extreme->setHeight(1e300);
+    extreme->setPageCount(-1);
+    original << extreme << JobSP();
+
+    JobsBinaryArchive archive;
+    ASSERT_TRUE(archive.load(JobsBinaryArchive::serialize(original)));
+    EXPECT_TRUE(archive.isLoaded());
+    EXPECT_EQ(JobsBinaryArchive::FORMAT_VERSION, archive.version());
+    ASSERT_EQ(52, archive.count());
+    for (int i = 0; i < archive.count(); ++i)
+        expectSameJobs(original[i], archive.job(i));
+    EXPECT_TRUE(std::signbit(archive.job(51)->width()));
+    EXPECT_FALSE(archive.job(52));
+    EXPECT_EQ(52, archive.jobs().count());
+}
+
+TEST(JobsBinaryArchiveTest, sizeComparedToJson)
+{
+    QVector<JobSP> original = jobs(1000);
+    QJsonArray json;
+    for (const JobSP &job : original)
+        json << job->toJson();
+    QByteArray jsonData = QJsonDocument(json).toJson(QJsonDocument::Compact);
+    QByteArray binaryData = JobsBinaryArchive::serialize(original);
+    EXPECT_LT(binaryData.size() * 4, jsonData.size());
+}
+
+TEST(JobsBinaryArchiveTest, file)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString fileName = dir.filePath(QStringLiteral("jobs.bin"));
+    QVector<JobSP> original = jobs(10);
+    ASSERT_TRUE(JobsBinaryArchive::save(original, fileName));
+
+    JobsBinaryArchive archive;
+    ASSERT_TRUE(archive.load(fileName));
+    ASSERT_EQ(10, archive.count());
+    expectSameJobs(original[7], archive.job(7));
+    archive.close();
+    EXPECT_FALSE(archive.isLoaded());
+    EXPECT_EQ(0, archive.count());
+
+    EXPECT_FALSE(archive.load(dir.filePath(QStringLiteral("missing.bin"))));
+    EXPECT_FALSE(archive.errorString().isEmpty());
+}
+
+TEST(JobsBinaryArchiveTest, corruptedData)
+{
+    QByteArray data = JobsBinaryArchive::serialize(jobs(3));
+    JobsBinaryArchive archive;
+    EXPECT_FALSE(archive.load(QByteArray()));
+    EXPECT_FALSE(archive.load(QByteArray("JSON[]")));
+    EXPECT_FALSE(archive.load(data.left(data.size() - 1)));
+    EXPECT_FALSE(archive.isLoaded());
+    EXPECT_FALSE(archive.errorString().isEmpty());
+
+    QByteArray futureVersion = data;
+    futureVersion[4] = static_cast<char>(JobsBinaryArchive::FORMAT_VERSION + 1);
+    EXPECT_FALSE(archive.load(futureVersion));
+
+    ASSERT_TRUE(archive.load(data));
+    EXPECT_TRUE(archive.errorString().isEmpty());
+    EXPECT_EQ(3, archive.count());
+}
+
+TEST(JobsBinaryArchiveTest, unknownEnumValues)
+{
+    JobSP original = Job::create(QStringLiteral("j"), QStringLiteral("s"));
+    original->setName(QStringLiteral("n"));
+    original->setStatus(EntityStatus::DeletedEntity);
+    original->setWorkflowStatus(WorkflowAction::CuttingAction, WorkflowStatus::DoneStatus, PaperSide::FrontSide);
+    QByteArray data = JobsBinaryArchive::serialize({original});
+
+    //Header, 3 one-byte strings, jobs count, record size and 3 string indices go before status
+    const int statusOffset = 5 + 7 + 1 + 1 + 3;
+    ASSERT_EQ(static_cast<char>(EntityStatus::DeletedEntity), data[statusOffset]);
+    data[statusOffset] = static_cast<char>(0xff);
+    data[data.size() - 3] = static_cast<char>(0xff);
+    data[data.size() - 2] = static_cast<char>(0xff);
+    data[data.size() - 1] = static_cast<char>(0xff);
+
+    JobsBinaryArchive archive;
+    ASSERT_TRUE(archive.load(data));
+    JobSP job = archive.job(0);
+    ASSERT_TRUE(job);
+    EXPECT_EQ(EntityStatus::InvalidEntity, job->status());
+    QJsonArray workflow = job->toJson().value(QStringLiteral("workflow")).toArray();
+    ASSERT_EQ(1, workflow.count());
+    EXPECT_EQ(WorkflowElement(WorkflowAction::UnknownAction, WorkflowStatus::UnknownStatus, PaperSide::NotSetSide)
+                  .toString(),
+              workflow.first().toString());
+}
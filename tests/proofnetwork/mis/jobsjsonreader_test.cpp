@@ -0,0 +1,129 @@
+// clazy:skip
+
+#include "proofnetwork/mis/data/job.h"
+#include "proofnetwork/mis/jobsjsonreader.h"
+
+#include "gtest/proof/test_global.h"
+
+#include <QBuffer>
+
+using namespace Proof::Mis;
+
+static QByteArray jobsDump(int count)
+{
+    QByteArray result = "[\n";
+    for (int i = 0; i < count; ++i) {
+        if (i)
+            result += ",\n";
+        result += "  {\"id\": \"dump-" + QByteArray::number(i)
+                  + "\", \"name\": \"Job {" + QByteArray::number(i)
+                  + "} \\\"]\\\"\", \"source\": \"metrix\", \"quantity\": 50, \"width\": 2016, \"height\": 1350, "
+                    "\"page_count\": 10, \"has_preview\": true, \"extra\": {\"nested\": [1, [2], {}]}, "
+                    "\"workflow\": [\"is ready for:cutting\", \"needs:boxing\"]}";
+    }
+    result += "\n]\n";
+    return result;
+}
+
+TEST(JobsJsonReaderTest, byteByByte)
+{
+    QByteArray dump = jobsDump(5);
+    QVector<JobSP> jobs;
+    JobsJsonReader reader;
+    reader.setCacheUsed(false);
+    reader.setBatchSize(2);
+    QVector<int> batchSizes;
+    reader.setBatchHandler([&jobs, &batchSizes](const QVector<JobSP> &batch) {
+        batchSizes << batch.count();
+        jobs << batch;
+    });
+    for (char c : dump)
+        ASSERT_TRUE(reader.addData(QByteArray(1, c))) << reader.errorString().toLatin1().constData();
+    EXPECT_TRUE(reader.atEnd());
+    EXPECT_TRUE(reader.finish());
+    EXPECT_FALSE(reader.hasError());
+
+    EXPECT_EQ(QVector<int>({2, 2, 1}), batchSizes);
+    EXPECT_EQ(5, reader.jobsRead());
+    EXPECT_EQ(dump.size(), reader.bytesRead());
+    ASSERT_EQ(5, jobs.count());
+    for (int i = 0; i < jobs.count(); ++i) {
+        const JobSP &job = jobs[i];
+        EXPECT_EQ(QStringLiteral("dump-%1").arg(i), job->id());
+        EXPECT_EQ(QStringLiteral("Job {%1} \"]\"").arg(i), job->name());
+        EXPECT_EQ("metrix", job->source());
+        EXPECT_EQ(50, job->quantity());
+        EXPECT_DOUBLE_EQ(1350.0, job->height());
+        EXPECT_EQ(10, job->pageCount());
+        EXPECT_TRUE(job->hasPreview());
+        EXPECT_TRUE(job->isFetched());
+        EXPECT_EQ(WorkflowStatus::IsReadyForStatus, job->workflowStatus(WorkflowAction::CuttingAction));
+        EXPECT_EQ(WorkflowStatus::NeedsStatus, job->workflowStatus(WorkflowAction::BoxingAction));
+    }
+}
+
+TEST(JobsJsonReaderTest, readDeviceWithProgress)
+{
+    QByteArray dump = jobsDump(100);
+    QBuffer device(&dump);
+    device.open(QIODevice::ReadOnly);
+    JobsJsonReader reader;
+    reader.setCacheUsed(false);
+    qint64 jobsCount = 0;
+    reader.setBatchHandler([&jobsCount](const QVector<JobSP> &batch) { jobsCount += batch.count(); });
+    QVector<qint64> progress;
+    reader.setProgressHandler([&progress](qint64 bytesRead, qint64) { progress << bytesRead; });
+    ASSERT_TRUE(reader.read(&device, 1000));
+
+    EXPECT_EQ(100, jobsCount);
+    EXPECT_EQ((dump.size() + 999) / 1000, progress.count());
+    ASSERT_FALSE(progress.isEmpty());
+    EXPECT_EQ(dump.size(), progress.last());
+}
+
+TEST(JobsJsonReaderTest, cache)
+{
+    JobSP cachedJob = Job::create("cached-job", "metrix");
+    jobsCache().add(cachedJob->cacheKey(), cachedJob);
+
+    JobsJsonReader reader;
+    QVector<JobSP> jobs;
+    reader.setBatchHandler([&jobs](const QVector<JobSP> &batch) { jobs << batch; });
+    ASSERT_TRUE(reader.addData(R"([{"id": "cached-job", "source": "metrix", "name": "Updated"},)"
+                               R"( {"id": "new-job", "source": "metrix"}, {"name": "Without id"}])"));
+    ASSERT_TRUE(reader.finish());
+
+    ASSERT_EQ(2, jobs.count());
+    EXPECT_EQ(cachedJob, jobs[0]);
+    EXPECT_EQ("Updated", cachedJob->name());
+    EXPECT_EQ(jobs[1], jobsCache().add(JobCacheKey("new-job", "metrix"), Job::create("new-job", "metrix")));
+}
+
+TEST(JobsJsonReaderTest, emptyArray)
+{
+    JobsJsonReader reader;
+    EXPECT_TRUE(reader.addData(" [ ] "));
+    EXPECT_TRUE(reader.finish());
+    EXPECT_EQ(0, reader.jobsRead());
+}
+
+TEST(JobsJsonReaderTest, malformedData)
+{
+    QVector<QByteArray> malformed = {"{\"id\": \"42\"}", "[{\"id\": \"42\"} {\"id\": \"43\"}]", "[1, 2]",
+                                     "[{\"id\": 42,}]", "[{\"id\": \"42\"}] ]", "[{\"id\": \"42\"},]"};
+    for (const QByteArray &data : malformed) {
+        JobsJsonReader reader;
+        reader.setCacheUsed(false);
+        EXPECT_FALSE(reader.addData(data) && reader.finish()) << data.constData();
+        EXPECT_TRUE(reader.hasError()) << data.constData();
+        EXPECT_FALSE(reader.addData("[]"));
+        reader.reset();
+        EXPECT_TRUE(reader.addData("[]"));
+        EXPECT_TRUE(reader.finish());
+    }
+
+    JobsJsonReader reader;
+    EXPECT_TRUE(reader.addData("[{\"id\": \"42\"}"));
+    EXPECT_FALSE(reader.finish());
+    EXPECT_TRUE(reader.hasError());
+}
@@ -0,0 +1,113 @@
+// clazy:skip
+
+#include "proofnetwork/mis/data/workflowelement.h"
+
+#include "gtest/proof/test_global.h"
+
+#include <QVector>
+
+#include <type_traits>
+
+using namespace Proof::Mis;
+
+static_assert(std::is_trivially_copyable<WorkflowElement>::value, "WorkflowElement should be trivially copyable");
+static_assert(sizeof(WorkflowElement) == 3, "WorkflowElement should be packed");
+
+TEST(WorkflowElementTest, defaultValues)
+{
+    WorkflowElement element;
+    EXPECT_EQ(WorkflowAction::UnknownAction, element.action());
+    EXPECT_EQ(WorkflowStatus::UnknownStatus, element.status());
+    EXPECT_EQ(PaperSide::NotSetSide, element.paperSide());
+
+    QVector<WorkflowElement> workflow;
+    workflow.resize(2);
+    EXPECT_EQ(WorkflowElement(), workflow[1]);
+}
+
+TEST(WorkflowElementTest, fromString)
+{
+    WorkflowElement element("needs:cutting");
+    EXPECT_EQ(WorkflowAction::CuttingAction, element.action());
+    EXPECT_EQ(WorkflowStatus::NeedsStatus, element.status());
+    EXPECT_EQ(PaperSide::NotSetSide, element.paperSide());
+    EXPECT_EQ("needs:cutting", element.toString());
+
+    element = WorkflowElement("in progress:printing:back");
+    EXPECT_EQ(WorkflowAction::PrintingAction, element.action());
+    EXPECT_EQ(WorkflowStatus::InProgressStatus, element.status());
+    EXPECT_EQ(PaperSide::BackSide, element.paperSide());
+    EXPECT_EQ("in progress:printing:back", element.toString());
+}
+
+TEST(WorkflowElementTest, valueSemantics)
+{
+    WorkflowElement first(WorkflowAction::BoxingAction, WorkflowStatus::DoneStatus);
+    WorkflowElement second(WorkflowAction::PrintingAction, WorkflowStatus::IsReadyForStatus, PaperSide::FrontSide);
+    WorkflowElement copy = first;
+    EXPECT_EQ(first, copy);
+    EXPECT_NE(first, second);
+
+    copy.setStatus(WorkflowStatus::HaltedStatus);
+    EXPECT_EQ(WorkflowStatus::DoneStatus, first.status());
+    EXPECT_EQ(WorkflowStatus::HaltedStatus, copy.status());
+
+    WorkflowElement moved = std::move(first);
+    EXPECT_EQ(WorkflowAction::BoxingAction, moved.action());
+
+    swap(moved, second);
+    EXPECT_EQ(WorkflowAction::PrintingAction, moved.action());
+    EXPECT_EQ(PaperSide::FrontSide, moved.paperSide());
+    EXPECT_EQ(WorkflowAction::BoxingAction, second.action());
+}
+
+TEST(WorkflowElementTest, parsingEdgeCases)
+{
+    EXPECT_EQ(WorkflowElement(), WorkflowElement("needs"));
+    EXPECT_EQ(WorkflowElement(), WorkflowElement(":"));
+    EXPECT_EQ(WorkflowElement(WorkflowAction::CuttingAction, WorkflowStatus::DoneStatus),
+              WorkflowElement("DONE:Cutting"));
+    EXPECT_EQ(WorkflowElement(WorkflowAction::CuttingAction, WorkflowStatus::UnknownStatus),
+              WorkflowElement("finished:cutting:"));
+    EXPECT_EQ(WorkflowElement(WorkflowAction::UnknownAction, WorkflowStatus::NeedsStatus, PaperSide::FrontSide),
+              WorkflowElement("needs:cuttings:front:ignored"));
+    EXPECT_EQ(WorkflowElement(WorkflowAction::PrintingAction, WorkflowStatus::HaltedStatus, PaperSide::NotSetSide),
+              WorkflowElement("halted:printing:middle"));
+
+    QString string = QStringLiteral("[is ready for:boxing:back]");
+    EXPECT_EQ(WorkflowElement(WorkflowAction::BoxingAction, WorkflowStatus::IsReadyForStatus, PaperSide::BackSide),
+              WorkflowElement::fromString(string.midRef(1, string.size() - 2)));
+    QByteArray utf8 = "suspended:uv coating";
+    EXPECT_EQ(WorkflowElement(WorkflowAction::UvCoatingAction, WorkflowStatus::SuspendedStatus),
+              WorkflowElement::fromUtf8(utf8.constData(), utf8.size()));
+    utf8 = "n\xc3\xa9"
+           "eds:cutting";
+    WorkflowElement nonAscii = WorkflowElement::fromUtf8(utf8.constData(), utf8.size());
+    EXPECT_EQ(WorkflowStatus::UnknownStatus, nonAscii.status());
+    EXPECT_EQ(WorkflowAction::CuttingAction, nonAscii.action());
+}
+
+TEST(WorkflowElementTest, bulkParsing)
+{
+    QJsonArray array = {"needs:cutting", "in progress:printing:front", 42, "done:boxing"};
+    QVector<WorkflowElement> expected = {WorkflowElement(WorkflowAction::CuttingAction, WorkflowStatus::NeedsStatus),
+                                         WorkflowElement(WorkflowAction::PrintingAction,
+                                                         WorkflowStatus::InProgressStatus, PaperSide::FrontSide),
+                                         WorkflowElement(),
+                                         WorkflowElement(WorkflowAction::BoxingAction, WorkflowStatus::DoneStatus)};
+    EXPECT_EQ(expected, WorkflowElement::workflowFromJson(array));
+
+    bool ok = false;
+    QByteArray json = " [\"needs:cutting\",\n\t\"in progress:printing:\\u0066ront\" , \"\", \"done:boxing\"] ";
+    EXPECT_EQ(expected, WorkflowElement::workflowFromJson(json, &ok));
+    EXPECT_TRUE(ok);
+
+    EXPECT_TRUE(WorkflowElement::workflowFromJson(QByteArray("[ ]"), &ok).isEmpty());
+    EXPECT_TRUE(ok);
+
+    for (const QByteArray &malformed : QVector<QByteArray>{"", "[", "[\"needs:cutting\"", "[\"needs:cutting\",]",
+                                                           "[\"needs:cutting\"] x", "[needs:cutting]", "{}"}) {
+        EXPECT_TRUE(WorkflowElement::workflowFromJson(malformed, &ok).isEmpty()) << malformed.constData();
+        EXPECT_FALSE(ok) << malformed.constData();
+    }
+}
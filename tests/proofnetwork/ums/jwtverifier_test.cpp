@@ -0,0 +1,139 @@
+// clazy:skip
+
+#include "proofnetwork/ums/jwtverifier.h"
+#include "proofnetwork/ums/tokensapi.h"
+
+#include "gtest/proof/test_global.h"
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <limits>
+
+using namespace Proof::Ums;
+
+static QByteArray signedToken()
+{
+    return QJsonDocument::fromJson(dataFromFile(":/data/token.json"))
+        .object()
+        .value("access_token")
+        .toString()
+        .toUtf8();
+}
+
+static QCA::RSAPublicKey rsaKey()
+{
+    return QCA::PublicKey::fromPEM(dataFromFile(":/data/pub_rsa.key")).toRSA();
+}
+
+static QByteArray unsignedToken(const QJsonObject &payload)
+{
+    auto encoding = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+    return QByteArray("{\"alg\":\"none\"}").toBase64(encoding) + '.'
+           + QJsonDocument(payload).toJson(QJsonDocument::Compact).toBase64(encoding) + '.';
+}
+
+static qint64 now()
+{
+    return QDateTime::currentMSecsSinceEpoch() / 1000;
+}
+
+TEST(JwtVerifierTest, signedToken)
+{
+    QByteArray token = signedToken();
+    ASSERT_FALSE(token.isEmpty());
+    JwtVerifier verifier(rsaKey());
+
+    //Token from test data expired long ago
+    JwtVerifier::Verification verification = verifier.verify(token);
+    EXPECT_EQ(JwtVerifier::Result::Expired, verification.result);
+    EXPECT_TRUE(verification.isSignatureVerified());
+    EXPECT_FALSE(verification.isValid());
+    EXPECT_EQ("testuser@test_company.com", verification.payload.value("email").toString());
+
+    verifier.setLeeway(std::numeric_limits<int>::max());
+    EXPECT_TRUE(verifier.verify(token).isValid());
+
+    QByteArray tampered = token;
+    int payloadStart = tampered.indexOf('.') + 1;
+    tampered[payloadStart] = tampered[payloadStart] == 'a' ? 'b' : 'a';
+    verification = verifier.verify(tampered);
+    EXPECT_EQ(JwtVerifier::Result::InvalidSignature, verification.result);
+    EXPECT_TRUE(verification.payload.isEmpty());
+
+    EXPECT_EQ(JwtVerifier::Result::InvalidSignature, JwtVerifier().verify(token).result);
+}
+
+TEST(JwtVerifierTest, timeClaims)
+{
+    JwtVerifier verifier;
+    QJsonObject payload{{"email", "testuser@test_company.com"}, {"nbf", now() - 10}, {"exp", now() + 100}};
+    EXPECT_EQ(JwtVerifier::Result::UnsupportedAlgorithm, verifier.verify(unsignedToken(payload)).result);
+
+    verifier.setUnsignedAllowed(true);
+    EXPECT_EQ(JwtVerifier::Result::Valid, verifier.verify(unsignedToken(payload)).result);
+    EXPECT_EQ(JwtVerifier::Result::Valid, verifier.verify(unsignedToken({{"email", "no time claims"}})).result);
+
+    payload["nbf"] = now() + 50;
+    EXPECT_EQ(JwtVerifier::Result::NotYetValid, verifier.verify(unsignedToken(payload)).result);
+    verifier.setLeeway(60);
+    EXPECT_EQ(JwtVerifier::Result::Valid, verifier.verify(unsignedToken(payload)).result);
+
+    payload["nbf"] = now() - 200;
+    payload["exp"] = now() - 30;
+    EXPECT_EQ(JwtVerifier::Result::Valid, verifier.verify(unsignedToken(payload)).result);
+    verifier.setLeeway(0);
+    EXPECT_EQ(JwtVerifier::Result::Expired, verifier.verify(unsignedToken(payload)).result);
+}
+
+TEST(JwtVerifierTest, malformedTokens)
+{
+    JwtVerifier verifier(rsaKey());
+    verifier.setUnsignedAllowed(true);
+    QByteArray token = unsignedToken({{"email", "testuser@test_company.com"}});
+    QVector<QByteArray> malformedTokens = {QByteArray(),
+                                           "abc",
+                                           "abc.def",
+                                           token + "abc.",
+                                           "." + token,
+                                           "!!!." + token.mid(token.indexOf('.') + 1),
+                                           token.left(token.indexOf('.') + 1) + "bm90IGpzb24."};
+    for (const QByteArray &malformed : malformedTokens) {
+        JwtVerifier::Verification verification = verifier.verify(malformed);
+        EXPECT_EQ(JwtVerifier::Result::Malformed, verification.result) << malformed.constData();
+        EXPECT_FALSE(verification.isSignatureVerified()) << malformed.constData();
+    }
+}
+
+TEST(JwtVerifierTest, batchVerification)
+{
+    JwtVerifier verifier(rsaKey());
+    QByteArray expired = signedToken();
+    QByteArray unsignedValid = unsignedToken({{"email", "testuser@test_company.com"}, {"exp", now() + 100}});
+    QVector<QByteArray> tokens;
+    for (int i = 0; i < 200; ++i)
+        tokens << (i % 3 == 0 ? expired : i % 3 == 1 ? unsignedValid : QByteArray::number(i));
+
+    QVector<JwtVerifier::Verification> results = verifier.verify(tokens)->result();
+    ASSERT_EQ(tokens.count(), results.count());
+    for (int i = 0; i < tokens.count(); ++i)
+        EXPECT_EQ(verifier.verify(tokens[i]).result, results[i].result) << i;
+    EXPECT_EQ(JwtVerifier::Result::Expired, results[0].result);
+    EXPECT_EQ(JwtVerifier::Result::UnsupportedAlgorithm, results[1].result);
+    EXPECT_EQ(JwtVerifier::Result::Malformed, results[2].result);
+
+    EXPECT_TRUE(verifier.verify(QVector<QByteArray>())->result().isEmpty());
+}
+
+TEST(JwtVerifierTest, tokensApiVerifier)
+{
+    Proof::RestClientSP restClient = Proof::RestClientSP::create();
+    TokensApi api("test", "test", restClient);
+    EXPECT_EQ(JwtVerifier::Result::InvalidSignature, api.jwtVerifier()->verify(signedToken()).result);
+
+    api.setRsaKey(rsaKey());
+    EXPECT_EQ(JwtVerifier::Result::Expired, api.jwtVerifier()->verify(signedToken()).result);
+    EXPECT_EQ(JwtVerifier::Result::UnsupportedAlgorithm,
+              api.jwtVerifier()->verify(unsignedToken({{"email", "testuser@test_company.com"}})).result);
+}
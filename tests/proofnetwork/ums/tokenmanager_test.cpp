@@ -0,0 +1,132 @@
+// clazy:skip
+
+#include "proofnetwork/ums/data/umstokeninfo.h"
+#include "proofnetwork/ums/tokenmanager.h"
+#include "proofnetwork/ums/tokensapi.h"
+
+#include "gtest/proof/test_global.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrlQuery>
+
+#include <vector>
+
+using namespace Proof::Ums;
+using testing::Test;
+
+class TokenManagerTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        serverRunner = new FakeServerRunner;
+        serverRunner->runServer();
+
+        Proof::RestClientSP restClient = Proof::RestClientSP::create();
+        restClient->setAuthType(Proof::RestAuthType::NoAuth);
+        restClient->setHost("127.0.0.1");
+        restClient->setPort(9091); //Default port for FakeServer
+        restClient->setScheme("http");
+        restClient->setClientName("Proof-test");
+        tokensApi = new TokensApi("test", "test", restClient);
+        managerUT = new TokenManager(tokensApi);
+    }
+
+    void TearDown() override
+    {
+        delete managerUT;
+        delete tokensApi;
+        delete serverRunner;
+    }
+
+    //Unsigned token, TokensApi accepts them from server
+    static QByteArray tokenReply(const QString &version, qint64 expiresIn)
+    {
+        QJsonObject payload{{"email", "testuser@test_company.com"},
+                            {"ver", version},
+                            {"exp", QDateTime::currentMSecsSinceEpoch() / 1000 + expiresIn}};
+        auto encoding = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+        QByteArray token = QByteArray("{\"alg\":\"none\"}").toBase64(encoding) + '.'
+                           + QJsonDocument(payload).toJson(QJsonDocument::Compact).toBase64(encoding) + '.';
+        return QJsonDocument(QJsonObject{{"access_token", QString(token)}}).toJson();
+    }
+
+protected:
+    FakeServerRunner *serverRunner;
+    TokensApi *tokensApi;
+    TokenManager *managerUT;
+};
+
+TEST_F(TokenManagerTest, cachedToken)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+    serverRunner->setServerAnswer(tokenReply("1", 3600));
+
+    UmsTokenInfoSP tokenInfo = managerUT->token()->result();
+    ASSERT_TRUE(tokenInfo);
+    EXPECT_EQ("1", tokenInfo->version());
+    EXPECT_EQ(tokenInfo, managerUT->tokenInfo());
+    EXPECT_EQ("client_credentials", QUrlQuery(serverRunner->lastQueryBody()).queryItemValue("grant_type"));
+
+    serverRunner->setServerAnswer(tokenReply("2", 3600));
+    auto cached = managerUT->token();
+    EXPECT_TRUE(cached->completed());
+    EXPECT_EQ(tokenInfo, cached->result());
+
+    UmsTokenInfoSP refreshed = managerUT->refresh()->result();
+    ASSERT_TRUE(refreshed);
+    EXPECT_EQ("2", refreshed->version());
+    EXPECT_EQ(refreshed, managerUT->tokenInfo());
+    auto query = QUrlQuery(serverRunner->lastQueryBody());
+    EXPECT_EQ("refresh_token", query.queryItemValue("grant_type"));
+    EXPECT_EQ(tokenInfo->token(), query.queryItemValue("refresh_token"));
+}
+
+TEST_F(TokenManagerTest, singleFlight)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+    serverRunner->setServerAnswer(tokenReply("1", 3600));
+
+    std::vector<Proof::CancelableFuture<UmsTokenInfoSP>> futures;
+    for (int i = 0; i < 5; ++i)
+        futures.push_back(managerUT->token());
+    UmsTokenInfoSP tokenInfo = futures.front()->result();
+    ASSERT_TRUE(tokenInfo);
+    for (const auto &future : futures)
+        EXPECT_EQ(tokenInfo, future->result());
+    EXPECT_EQ(4, managerUT->deduplicatedRequestsCount());
+}
+
+TEST_F(TokenManagerTest, proactiveRefresh)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+    serverRunner->setServerAnswer(tokenReply("1", 3));
+    UmsTokenInfoSP expiring = tokensApi->fetchToken()->result();
+    ASSERT_TRUE(expiring);
+
+    managerUT->setRefreshAhead(3000);
+    managerUT->setRefreshJitter(0);
+    QVector<UmsTokenInfoSP> changes;
+    QObject::connect(managerUT, &TokenManager::tokenChanged, managerUT,
+                     [&changes](const UmsTokenInfoSP &tokenInfo) { changes << tokenInfo; });
+    serverRunner->setServerAnswer(tokenReply("2", 3600));
+    managerUT->setTokenInfo(expiring);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (changes.count() < 2 && timer.elapsed() < 5000)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+
+    ASSERT_EQ(2, changes.count());
+    EXPECT_EQ(expiring, changes[0]);
+    ASSERT_TRUE(changes[1]);
+    EXPECT_EQ("2", changes[1]->version());
+    //Refreshed before old token expired
+    EXPECT_LT(QDateTime::currentDateTime(), expiring->expiresAt());
+    EXPECT_EQ(expiring->token(), QUrlQuery(serverRunner->lastQueryBody()).queryItemValue("refresh_token"));
+    EXPECT_EQ(changes[1], managerUT->token()->result());
+}
@@ -154,6 +154,52 @@ TEST_F(TokensApiTest, refreshToken)
     EXPECT_EQ(QString(tokenFromFile), tokenInfo->token());
 }
 
+TEST_F(TokensApiTest, verifiedTokensCache)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+    QJsonObject payload{{"email", "testuser@test_company.com"}, {"exp", 2000000000}, {"ver", "1"}};
+    QByteArray token = QByteArray("{\"alg\":\"none\"}").toBase64() + '.'
+                       + QJsonDocument(payload).toJson(QJsonDocument::Compact).toBase64() + '.';
+    serverRunner->setServerAnswer(QJsonDocument(QJsonObject{{"access_token", QString(token)}}).toJson());
+
+    Proof::Ums::UmsTokenInfoSP first = tokensApiUT->fetchToken()->result();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(0, tokensApiUT->verifiedTokensCacheHits());
+    Proof::Ums::UmsTokenInfoSP second = tokensApiUT->fetchToken()->result();
+    ASSERT_TRUE(second);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(first->token(), second->token());
+    EXPECT_EQ(first->expiresAt(), second->expiresAt());
+    EXPECT_EQ(first->version(), second->version());
+    EXPECT_EQ(1, tokensApiUT->verifiedTokensCacheHits());
+
+    tokensApiUT->setRsaKey(tokensApiUT->rsaKey());
+    Proof::Ums::UmsTokenInfoSP third = tokensApiUT->fetchToken()->result();
+    ASSERT_TRUE(third);
+    EXPECT_NE(first, third);
+    EXPECT_EQ(1, tokensApiUT->verifiedTokensCacheHits());
+
+    tokensApiUT->setVerifiedTokensCacheCapacity(0);
+    EXPECT_EQ(0, tokensApiUT->verifiedTokensCacheCapacity());
+    EXPECT_NE(third, tokensApiUT->fetchToken()->result());
+    EXPECT_EQ(1, tokensApiUT->verifiedTokensCacheHits());
+}
+
+TEST_F(TokensApiTest, expiredTokenIsNotCached)
+{
+    ASSERT_TRUE(serverRunner->serverIsRunning());
+    QByteArray tokenFromFile = dataFromFile(":/data/token.json");
+    ASSERT_FALSE(tokenFromFile.isEmpty());
+    serverRunner->setServerAnswer(tokenFromFile);
+
+    Proof::Ums::UmsTokenInfoSP first = tokensApiUT->fetchToken()->result();
+    Proof::Ums::UmsTokenInfoSP second = tokensApiUT->fetchToken()->result();
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(second);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(0, tokensApiUT->verifiedTokensCacheHits());
+}
+
 TEST_F(TokensApiTest, fetchPublicKey)
 {
     ASSERT_TRUE(serverRunner->serverIsRunning());
@@ -1,6 +1,7 @@
 // clazy:skip
 
 #include "proofutils/epllabelgenerator.h"
+#include "proofutils/labelbatchrenderer.h"
 
 #include "gtest/proof/test_global.h"
 
@@ -12,6 +13,7 @@ using BarcodeTestTuple = std::tuple<QString, QString, EplLabelGenerator::Barcode
 
 static const QVector<QSize> singleCharSizeAt203 = {{10, 14}, {12, 18}, {14, 22}, {16, 26}, {34, 50}};
 static const QVector<QSize> singleCharSizeAt300 = {{14, 22}, {18, 30}, {22, 38}, {26, 46}, {50, 82}};
+static const QByteArray DEFAULT_LABEL_HEADER = "I8,A,001\nOD\nq795\nQ1250,24\nS4\nD10\nJF\n\n";
 
 class EplLabelGenerator203SizesTest : public TestWithParam<SizeTestTuple>
 {};
@@ -477,3 +479,197 @@ TEST(EplLabelGeneratorTest, upsideDownBarcodeSize)
                                   << expectedRect.height() << " != " << rect.x() << "," << rect.y() << ";"
                                   << rect.width() << "x" << rect.height();
 }
+
+TEST(EplLabelGeneratorTest, startLabel)
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    EXPECT_EQ(DEFAULT_LABEL_HEADER, generator.labelData());
+
+    generator.startLabel(400, 600, 3, 8, 16);
+    EXPECT_EQ("I8,A,001\nOD\nq400\nQ600,16\nS3\nD8\nJF\n\n", generator.labelData());
+    EXPECT_EQ(QSize(400, 600), generator.labelSize());
+}
+
+TEST(EplLabelGeneratorTest, addText)
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    QRect rect = generator.addText("Hello \"quoted\" \\ text", 10, 20);
+    generator.addText("inverse", -5, 1250, 2, 3, 4, 90, true);
+    generator.addText(QString::fromUtf8("\xd0\x9f\""), 0, 0);
+    EXPECT_EQ(DEFAULT_LABEL_HEADER + "A10,20,0,4,1,1,N,\"Hello \\\"quoted\\\" \\\\ text\"\n"
+                                     "A-5,1250,1,2,3,4,R,\"inverse\"\n"
+                                     "A0,0,0,4,1,1,N,\"\xd0\x9f\\\"\"\n",
+              generator.labelData());
+    EXPECT_EQ(QRect(10, 20, 16 * 21, 26), rect);
+}
+
+TEST(EplLabelGeneratorTest, addBarcode)
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    generator.addBarcode("12345", EplLabelGenerator::BarcodeType::Code128Auto, 5, 6);
+    generator.addBarcode("678", EplLabelGenerator::BarcodeType::Msi3WithMod10CheckDigit, 7, 8, 100, false, 3, 6, 180);
+    generator.addBarcode("0", EplLabelGenerator::BarcodeType::UpcAAddon5, 0, 0);
+    EXPECT_EQ(DEFAULT_LABEL_HEADER + "B5,6,0,1,2,4,200,B,\"12345\"\n"
+                                     "B7,8,2,M,3,6,100,N,\"678\"\n"
+                                     "B0,0,0,UA5,2,4,200,B,\"0\"\n",
+              generator.labelData());
+}
+
+TEST(EplLabelGeneratorTest, addLines)
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    generator.addLine(1, 2, 3, 4);
+    generator.addLine(10, 20, 30, 40, EplLabelGenerator::LineType::White);
+    generator.addLine(100, 200, 300, 400, EplLabelGenerator::LineType::Xor);
+    QRect rect = generator.addDiagonalLine(50, 60, 10, 20, 5);
+    EXPECT_EQ(DEFAULT_LABEL_HEADER + "LO1,2,3,4\nLW10,20,30,40\nLE100,200,300,400\nLS50,60,5,10,20\n",
+              generator.labelData());
+    EXPECT_EQ(QRect(10, 20, 40, 45), rect);
+}
+
+TEST(EplLabelGeneratorTest, printCommands)
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    generator.addPrintCommand(12);
+    generator.addClearBufferCommand();
+    EXPECT_EQ(DEFAULT_LABEL_HEADER + "P12\nN\n", generator.labelData());
+}
+
+TEST(EplLabelGeneratorTest, labelTemplate)
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    generator.addTextPlaceholder("name", 10, 20);
+    generator.addLine(1, 2, 3, 4);
+    generator.addBarcodePlaceholder("code", EplLabelGenerator::BarcodeType::Code128Auto, 5, 6);
+    generator.addTextPlaceholder("name", 30, 40, 2);
+    generator.addPrintCommand();
+    LabelTemplate labelTemplate = generator.labelTemplate();
+
+    ASSERT_FALSE(labelTemplate.isEmpty());
+    EXPECT_EQ(QStringList({"name", "code"}), labelTemplate.placeholders());
+
+    QByteArray rendered = labelTemplate.render({{"name", "Job \"42\""}, {"code", "12345"}});
+    EXPECT_EQ(DEFAULT_LABEL_HEADER + "A10,20,0,4,1,1,N,\"Job \\\"42\\\"\"\n"
+                                     "LO1,2,3,4\n"
+                                     "B5,6,0,1,2,4,200,B,\"12345\"\n"
+                                     "A30,40,0,2,1,1,N,\"Job \\\"42\\\"\"\n"
+                                     "P1\n",
+              rendered);
+
+    generator.startLabel();
+    generator.addText("Job \"42\"", 10, 20);
+    generator.addLine(1, 2, 3, 4);
+    generator.addBarcode("12345", EplLabelGenerator::BarcodeType::Code128Auto, 5, 6);
+    generator.addText("Job \"42\"", 30, 40, 2);
+    generator.addPrintCommand();
+    EXPECT_EQ(generator.labelData(), rendered);
+
+    EXPECT_EQ(DEFAULT_LABEL_HEADER + "A10,20,0,4,1,1,N,\"\"\nLO1,2,3,4\nB5,6,0,1,2,4,200,B,\"\"\nA30,40,0,2,1,1,N,\"\"\nP1\n",
+              labelTemplate.render({}));
+}
+
+TEST(EplLabelGeneratorTest, batchRender)
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    generator.addTextPlaceholder("id", 10, 20);
+    generator.addPrintCommand();
+    LabelTemplate labelTemplate = generator.labelTemplate();
+
+    QVector<LabelBatchRenderer::LabelValues> rows;
+    QVector<LabelBatchRenderer::LabelDescription> descriptions;
+    for (int i = 0; i < 1000; ++i) {
+        rows << LabelBatchRenderer::LabelValues{{"id", QString::number(i)}};
+        descriptions << [i](EplLabelGenerator &generator) {
+            generator.addText(QString::number(i), 10, 20);
+            generator.addPrintCommand();
+        };
+    }
+
+    auto fromTemplate = LabelBatchRenderer::render(labelTemplate, rows)->result();
+    auto fromDescriptions = LabelBatchRenderer::render(descriptions)->result();
+    ASSERT_EQ(1000, fromTemplate.count());
+    ASSERT_EQ(1000, fromDescriptions.count());
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(DEFAULT_LABEL_HEADER + "A10,20,0,4,1,1,N,\"" + QByteArray::number(i) + "\"\nP1\n", fromTemplate[i]);
+        EXPECT_EQ(fromTemplate[i], fromDescriptions[i]);
+    }
+
+    QByteArray joinedLabels = LabelBatchRenderer::joined(fromTemplate);
+    EXPECT_TRUE(joinedLabels.startsWith(fromTemplate.first()));
+    EXPECT_TRUE(joinedLabels.endsWith(fromTemplate.last()));
+    EXPECT_TRUE(LabelBatchRenderer::render(labelTemplate, {})->result().isEmpty());
+}
+
+TEST(EplLabelGeneratorTest, storedForm)
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    generator.addTextPlaceholder("name", 10, 20);
+    generator.addLine(1, 2, 3, 4);
+    generator.addBarcodePlaceholder("code", EplLabelGenerator::BarcodeType::Code128Auto, 5, 6);
+    generator.addTextPlaceholder("name", 30, 40, 2);
+    generator.addPrintCommand(2);
+    LabelTemplate labelTemplate = generator.labelTemplate();
+
+    ASSERT_TRUE(labelTemplate.canBeStoredAsForm());
+    EXPECT_EQ("\nFK\"JOB\"\nFS\"JOB\"\n"
+              "V00,99,N,\"name\"\nV01,99,N,\"code\"\n"
+              "A10,20,0,4,1,1,N,V00\nLO1,2,3,4\nB5,6,0,1,2,4,200,B,V01\nA30,40,0,2,1,1,N,V00\n"
+              "FE\n",
+              labelTemplate.formUploadData("JOB"));
+    EXPECT_EQ(DEFAULT_LABEL_HEADER + "FR\"JOB\"\n?\nJob 42\n12345\nP2\n",
+              labelTemplate.formRecallData("JOB", {{"name", "Job\n42"}, {"code", "12345"}}));
+
+    generator.startLabel();
+    generator.addQrCodePlaceholder("url", 10, 10);
+    EXPECT_FALSE(generator.labelTemplate().canBeStoredAsForm());
+    EXPECT_TRUE(generator.labelTemplate().formUploadData("QR").isEmpty());
+    EXPECT_TRUE(generator.labelTemplate().formRecallData("QR", {{"url", "http://example.com"}}).isEmpty());
+
+    EXPECT_FALSE(labelTemplate.formUploadData("JOB12345").isEmpty());
+    for (const QString &invalidName : {QString(), QStringLiteral("JOB123456"), QStringLiteral("J\"OB"),
+                                       QStringLiteral("J OB"), QStringLiteral("JÖB")}) {
+        EXPECT_TRUE(labelTemplate.formUploadData(invalidName).isEmpty()) << invalidName.toStdString();
+        EXPECT_TRUE(labelTemplate.formRecallData(invalidName, {}).isEmpty()) << invalidName.toStdString();
+    }
+}
+
+TEST(EplLabelGeneratorTest, textPlaceholderFontSize)
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    generator.addTextPlaceholder("text", 10, 20, 7);
+    generator.addTextPlaceholder("digits", 10, 40, 7, 1, 1, 0, false, true);
+    EXPECT_EQ(DEFAULT_LABEL_HEADER + "A10,20,0,5,1,1,N,\"abc\"\nA10,40,0,7,1,1,N,\"42\"\n",
+              generator.labelTemplate().render({{"text", "abc"}, {"digits", "42"}}));
+}
+
+TEST(EplLabelGeneratorTest, movedFromTemplate)
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    generator.addTextPlaceholder("id", 10, 20);
+    LabelTemplate original = generator.labelTemplate();
+    QByteArray expected = original.render({{"id", "42"}});
+
+    LabelTemplate moved(std::move(original));
+    EXPECT_EQ(expected, moved.render({{"id", "42"}}));
+    EXPECT_TRUE(original.isEmpty());
+    EXPECT_TRUE(original.placeholders().isEmpty());
+    LabelTemplate copy = original;
+    EXPECT_TRUE(copy.isEmpty());
+
+    LabelTemplate assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(expected, assigned.render({{"id", "42"}}));
+    EXPECT_TRUE(moved.isEmpty());
+    moved = assigned;
+    EXPECT_EQ(expected, moved.render({{"id", "42"}}));
+}
@@ -0,0 +1,96 @@
+// clazy:skip
+
+#include "proofutils/labelprinter.h"
+
+#include "gtest/proof/test_global.h"
+
+#include "../common/fakesocketserver.h"
+
+#include <QTemporaryDir>
+
+using namespace Proof;
+
+static LabelTemplate formTemplate()
+{
+    EplLabelGenerator generator;
+    generator.startLabel();
+    generator.addTextPlaceholder("name", 10, 20);
+    generator.addPrintCommand();
+    return generator.labelTemplate();
+}
+
+TEST(LabelPrinterTest, spooledFormIsNotResidentUntilPrinted)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    LabelPrinterParams params(QStringLiteral("offline"), QStringLiteral("127.0.0.1"), QString());
+    params.rawSocket = true;
+    params.rawSocketPort = FakeSocketServer::closedPort();
+    params.spoolDirectory = dir.path();
+    LabelPrinter printer(params);
+
+    LabelTemplate labelTemplate = formTemplate();
+    auto result = printer.printStoredForm(QStringLiteral("JOB"), labelTemplate, {{"name", "42"}});
+    result->wait();
+    EXPECT_TRUE(result->failed());
+    EXPECT_FALSE(printer.isFormResident(QStringLiteral("JOB"), labelTemplate));
+    EXPECT_EQ(0, printer.spooledLabelsCount());
+}
+
+TEST(LabelPrinterTest, residentFormIsOnlyRecalled)
+{
+    QByteArray received;
+    FakeSocketServer server([&received](QTcpSocket *socket) {
+        received = FakeSocketServer::readAll(socket, nullptr, 1000);
+        return false;
+    });
+    LabelPrinterParams params(QStringLiteral("raw"), QStringLiteral("127.0.0.1"), QString());
+    params.rawSocket = true;
+    params.rawSocketPort = server.port();
+    LabelPrinter printer(params);
+    printer.forgetResidentForms();
+
+    LabelTemplate labelTemplate = formTemplate();
+    for (int i = 0; i < 3; ++i) {
+        auto result = printer.printStoredForm(QStringLiteral("JOB"), labelTemplate, {{"name", QString::number(i)}});
+        result->wait();
+        ASSERT_TRUE(result->succeeded());
+        EXPECT_TRUE(result->result());
+        EXPECT_TRUE(printer.isFormResident(QStringLiteral("JOB"), labelTemplate));
+    }
+    printer.forgetResidentForm(QStringLiteral("JOB"));
+    EXPECT_FALSE(printer.isFormResident(QStringLiteral("JOB"), labelTemplate));
+    auto result = printer.printStoredForm(QStringLiteral("JOB"), labelTemplate, {{"name", "3"}});
+    result->wait();
+    ASSERT_TRUE(result->succeeded());
+    server.waitForFinished();
+
+    EXPECT_EQ(2, received.count("FS\"JOB\""));
+    EXPECT_EQ(4, received.count("FR\"JOB\""));
+}
+
+TEST(LabelPrinterTest, zeroTtlAlwaysUploadsForm)
+{
+    QByteArray received;
+    FakeSocketServer server([&received](QTcpSocket *socket) {
+        received = FakeSocketServer::readAll(socket, nullptr, 1000);
+        return false;
+    });
+    LabelPrinterParams params(QStringLiteral("raw"), QStringLiteral("127.0.0.1"), QString());
+    params.rawSocket = true;
+    params.rawSocketPort = server.port();
+    params.residentFormTtl = 0;
+    LabelPrinter printer(params);
+    printer.forgetResidentForms();
+
+    LabelTemplate labelTemplate = formTemplate();
+    for (int i = 0; i < 2; ++i) {
+        auto result = printer.printStoredForm(QStringLiteral("JOB"), labelTemplate, {{"name", QString::number(i)}});
+        result->wait();
+        ASSERT_TRUE(result->succeeded());
+        EXPECT_FALSE(printer.isFormResident(QStringLiteral("JOB"), labelTemplate));
+    }
+    server.waitForFinished();
+
+    EXPECT_EQ(2, received.count("FS\"JOB\""));
+}
@@ -0,0 +1,130 @@
+// clazy:skip
+
+#include "proofutils/labelprinterpool.h"
+
+#include "gtest/proof/test_global.h"
+
+#include "../common/fakesocketserver.h"
+
+#include <QDir>
+#include <QTemporaryDir>
+
+#include <limits>
+
+using namespace Proof;
+
+//Accepts one connection and reads everything from it until stopped
+class LabelSink
+{
+public:
+    LabelSink()
+        : server([this](QTcpSocket *socket) {
+              received = FakeSocketServer::readAll(socket, &server, std::numeric_limits<int>::max());
+              return false;
+          })
+    {
+        port = server.port();
+    }
+
+    void stop() { server.stop(); }
+
+    int labelsCount() const { return received.count("P1\n"); }
+
+    quint16 port = 0;
+    QByteArray received;
+
+private:
+    FakeSocketServer server;
+};
+
+static LabelPrinterParams rawSocketParams(const QString &title, quint16 port)
+{
+    LabelPrinterParams params(title, QStringLiteral("127.0.0.1"), QString());
+    params.rawSocket = true;
+    params.rawSocketPort = port;
+    return params;
+}
+
+static QVector<FutureSP<bool>> printLabels(const LabelPrinterPool &pool, int count)
+{
+    QVector<FutureSP<bool>> results;
+    for (int i = 0; i < count; ++i)
+        results << pool.printLabel(QByteArray("N\nA10,20,0,4,1,1,N,\"") + QByteArray::number(i) + "\"\nP1\n");
+    for (const auto &result : results)
+        result->wait();
+    return results;
+}
+
+TEST(LabelPrinterPoolTest, balancing)
+{
+    LabelSink first;
+    LabelSink second;
+    LabelPrinterPool pool({rawSocketParams("first", first.port), rawSocketParams("second", second.port)});
+    ASSERT_EQ(2, pool.printersCount());
+    EXPECT_EQ("second", pool.printerTitle(1));
+
+    for (const auto &result : printLabels(pool, 40))
+        EXPECT_TRUE(result->succeeded());
+    first.stop();
+    second.stop();
+
+    EXPECT_EQ(40, first.labelsCount() + second.labelsCount());
+    EXPECT_LT(0, first.labelsCount());
+    EXPECT_LT(0, second.labelsCount());
+    for (int i = 0; i < pool.printersCount(); ++i) {
+        EXPECT_EQ(0, pool.queueDepth(i));
+        EXPECT_LT(0, pool.averageLatency(i));
+        EXPECT_TRUE(pool.isPrinterAvailable(i));
+    }
+}
+
+TEST(LabelPrinterPoolTest, failover)
+{
+    LabelSink sink;
+    LabelPrinterPool pool(
+        {rawSocketParams("broken", FakeSocketServer::closedPort()), rawSocketParams("working", sink.port)});
+    pool.setFailoverCooldown(60000);
+
+    for (const auto &result : printLabels(pool, 10))
+        EXPECT_TRUE(result->succeeded());
+    sink.stop();
+
+    EXPECT_EQ(10, sink.labelsCount());
+    EXPECT_FALSE(pool.isPrinterAvailable(0));
+    EXPECT_TRUE(pool.isPrinterAvailable(1));
+    EXPECT_EQ(0, pool.queueDepth(0));
+    EXPECT_EQ(0, pool.averageLatency(0));
+}
+
+TEST(LabelPrinterPoolTest, spoolIsIgnored)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    LabelSink sink;
+    LabelPrinterParams broken = rawSocketParams("broken", FakeSocketServer::closedPort());
+    broken.spoolDirectory = dir.path();
+    LabelPrinterPool pool({broken, rawSocketParams("working", sink.port)});
+    pool.setFailoverCooldown(60000);
+
+    for (const auto &result : printLabels(pool, 10))
+        EXPECT_TRUE(result->succeeded());
+    sink.stop();
+
+    EXPECT_EQ(10, sink.labelsCount());
+    EXPECT_FALSE(pool.isPrinterAvailable(0));
+    EXPECT_TRUE(QDir(dir.path()).entryList({"*.spool"}, QDir::Files).isEmpty());
+}
+
+TEST(LabelPrinterPoolTest, allPrintersDown)
+{
+    LabelPrinterPool pool({rawSocketParams("first", FakeSocketServer::closedPort()),
+                           rawSocketParams("second", FakeSocketServer::closedPort())});
+    auto results = printLabels(pool, 1);
+    ASSERT_TRUE(results.first()->failed());
+    EXPECT_EQ(UtilsErrorCode::RawSocketConnectionError, results.first()->failureReason().errorCode);
+    EXPECT_FALSE(pool.isPrinterAvailable(0));
+    EXPECT_FALSE(pool.isPrinterAvailable(1));
+
+    pool.setFailoverCooldown(0);
+    EXPECT_TRUE(pool.isPrinterAvailable(0));
+}
@@ -0,0 +1,186 @@
+// clazy:skip
+
+#include "proofutils/lpdclient.h"
+#include "proofutils/lprprinter.h"
+
+#include "gtest/proof/test_global.h"
+
+#include "../common/fakesocketserver.h"
+
+#include <QTemporaryFile>
+
+using namespace Proof;
+using namespace Proof::Hardware;
+
+//Minimal RFC 1179 server that serves exactly one connection in its own thread
+class FakeLpdServer
+{
+public:
+    explicit FakeLpdServer(const QByteArray &queueState = QByteArray())
+        : queueState(queueState), server([this](QTcpSocket *socket) {
+              serve(socket);
+              return false;
+          })
+    {
+        port = server.port();
+    }
+
+    void waitForFinished() { server.waitForFinished(); }
+
+    quint16 port = 0;
+    char command = 0;
+    QByteArray queue;
+    QByteArray controlFile;
+    QByteArray dataFile;
+
+private:
+    static QByteArray readLine(QTcpSocket *socket)
+    {
+        while (!socket->canReadLine()) {
+            if (!socket->waitForReadyRead(5000))
+                return QByteArray();
+        }
+        QByteArray line = socket->readLine();
+        line.chop(1);
+        return line;
+    }
+
+    static QByteArray readExactly(QTcpSocket *socket, qint64 size)
+    {
+        QByteArray result;
+        while (result.size() < size) {
+            if (!socket->bytesAvailable() && !socket->waitForReadyRead(5000))
+                break;
+            result.append(socket->read(size - result.size()));
+        }
+        return result;
+    }
+
+    static void ack(QTcpSocket *socket)
+    {
+        socket->write(QByteArray(1, '\0'));
+        socket->waitForBytesWritten(5000);
+    }
+
+    void serve(QTcpSocket *socket)
+    {
+        QByteArray line = readLine(socket);
+        if (line.isEmpty())
+            return;
+        command = line[0];
+        queue = line.mid(1);
+        if (command != '\x02') {
+            socket->write(queueState);
+            socket->waitForBytesWritten(5000);
+            return;
+        }
+        ack(socket);
+        for (int i = 0; i < 2; ++i) {
+            line = readLine(socket);
+            if (line.isEmpty())
+                return;
+            qint64 size = line.mid(1, line.indexOf(' ') - 1).toLongLong();
+            ack(socket);
+            QByteArray content = readExactly(socket, size + 1);
+            (line[0] == '\x02' ? controlFile : dataFile) = content.left(size);
+            ack(socket);
+        }
+    }
+
+    QByteArray queueState;
+    //Declared last, so it is stopped before fields it writes to are destroyed
+    FakeSocketServer server;
+};
+
+TEST(LpdClientTest, printRawData)
+{
+    FakeLpdServer server;
+    LpdClient client(QStringLiteral("127.0.0.1"), QStringLiteral("labels"), server.port);
+    QByteArray label = "N\nA10,20,0,4,1,1,N,\"Hello\"\nP1\n";
+    auto result = client.printRawData(label, 2, QStringLiteral("job"));
+    result->wait();
+    server.waitForFinished();
+
+    ASSERT_TRUE(result->succeeded());
+    EXPECT_TRUE(result->result());
+    EXPECT_EQ('\x02', server.command);
+    EXPECT_EQ("labels", server.queue);
+    EXPECT_EQ(label, server.dataFile);
+
+    QList<QByteArray> controlLines = server.controlFile.split('\n');
+    ASSERT_FALSE(controlLines.isEmpty());
+    EXPECT_TRUE(controlLines.first().startsWith('H'));
+    EXPECT_TRUE(controlLines.contains("Jjob"));
+    int printLines = 0;
+    for (const QByteArray &line : controlLines) {
+        if (line.startsWith('l')) {
+            ++printLines;
+            EXPECT_TRUE(line.startsWith("ldfA"));
+        }
+    }
+    EXPECT_EQ(2, printLines);
+}
+
+TEST(LpdClientTest, printFile)
+{
+    QTemporaryFile file;
+    ASSERT_TRUE(file.open());
+    QByteArray content(200 * 1024, 'x');
+    file.write(content);
+    file.close();
+
+    FakeLpdServer server;
+    LpdClient client(QStringLiteral("127.0.0.1"), QStringLiteral("labels"), server.port);
+    auto result = client.printFile(file.fileName());
+    result->wait();
+    server.waitForFinished();
+
+    ASSERT_TRUE(result->succeeded());
+    EXPECT_EQ(content, server.dataFile);
+}
+
+TEST(LpdClientTest, fetchQueueState)
+{
+    FakeLpdServer server("labels is ready\nno entries\n");
+    LpdClient client(QStringLiteral("127.0.0.1"), QStringLiteral("labels"), server.port);
+    auto result = client.fetchQueueState();
+    result->wait();
+    server.waitForFinished();
+
+    ASSERT_TRUE(result->succeeded());
+    EXPECT_EQ('\x03', server.command);
+    EXPECT_EQ("labels", server.queue);
+    EXPECT_EQ("labels is ready\nno entries\n", result->result());
+}
+
+TEST(LpdClientTest, connectionRefused)
+{
+    LpdClient client(QStringLiteral("127.0.0.1"), QStringLiteral("labels"), FakeSocketServer::closedPort());
+    client.setTimeout(1000);
+    auto result = client.printRawData("N\nP1\n");
+    result->wait();
+
+    ASSERT_TRUE(result->failed());
+    EXPECT_EQ(UTILS_MODULE_CODE, result->failureReason().moduleCode);
+    EXPECT_EQ(UtilsErrorCode::LpdConnectionError, result->failureReason().errorCode);
+}
+
+TEST(LpdClientTest, lprPrinterReadiness)
+{
+    const QVector<QPair<QByteArray, bool>> replies = {
+        {"labels is ready\nno entries\n", true},
+        {"Printer: labels@printserver 'Zebra'\n Queue: no printable jobs in queue\n", true},
+        {"", true},
+        {"labels is not ready\nRank Owner Job File(s) Total Size\n", false}};
+    for (const auto &reply : replies) {
+        FakeLpdServer server(reply.first);
+        LprPrinter printer(QStringLiteral("127.0.0.1"), QStringLiteral("labels"), true);
+        printer.setUseNativeLpd(true, server.port);
+        auto result = printer.printerIsReady();
+        result->wait();
+        server.waitForFinished();
+        EXPECT_EQ(reply.second, result->succeeded()) << reply.first.constData();
+        if (!reply.second)
+            EXPECT_EQ(UtilsErrorCode::PrinterNotReady, result->failureReason().errorCode);
+    }
+}
@@ -0,0 +1,211 @@
+// clazy:skip
+
+#include "proofutils/lprprinter.h"
+
+#include "gtest/proof/test_global.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSharedPointer>
+#include <QTemporaryDir>
+#include <QThread>
+
+using namespace Proof;
+using namespace Proof::Hardware;
+using testing::Test;
+
+static const int FAKE_LPR_DURATION = 500;
+
+//Replaces lpr, lpq and lpoptions in PATH with scripts. lpr consumes data a bit slowly and records
+//the maximum amount of lpr processes running at once, lpq reports that any printer is ready and counts its calls
+class LprPrinterTest : public Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(binDir.isValid());
+        writeTool("lpr", QStringLiteral("cat > /dev/null\n"
+                                        "D=%1\n"
+                                        "lock() { while ! mkdir $D/lock 2> /dev/null; do sleep 0.01; done; }\n"
+                                        "lock\n"
+                                        "n=$(($(cat $D/running 2> /dev/null || echo 0) + 1))\n"
+                                        "echo $n > $D/running\n"
+                                        "m=$(cat $D/max_running 2> /dev/null || echo 0)\n"
+                                        "[ $n -gt $m ] && echo $n > $D/max_running\n"
+                                        "rmdir $D/lock\n"
+                                        "sleep %2\n"
+                                        "lock\n"
+                                        "echo $(($(cat $D/running) - 1)) > $D/running\n"
+                                        "rmdir $D/lock\n")
+                                 .arg(binDir.path())
+                                 .arg(FAKE_LPR_DURATION / 1000.0));
+        writeTool("lpq", QStringLiteral("echo x >> %1\necho \"$4 is ready\"\n").arg(lpqCallsFileName()));
+        writeTool("lpoptions", QStringLiteral("echo \"printer-state=3 printer-state-reasons=none\"\n"));
+        oldPath = qgetenv("PATH");
+        qputenv("PATH", binDir.path().toLocal8Bit() + ':' + oldPath);
+    }
+
+    void writeTool(const QString &name, const QString &script)
+    {
+        QFile tool(binDir.path() + "/" + name);
+        ASSERT_TRUE(tool.open(QIODevice::WriteOnly));
+        tool.write("#!/bin/sh\n" + script.toLatin1());
+        tool.close();
+        tool.setPermissions(QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+    }
+
+    QString lpqCallsFileName() const { return binDir.path() + "/lpq_calls"; }
+
+    int lpqCalls() const
+    {
+        QFile calls(lpqCallsFileName());
+        if (!calls.open(QIODevice::ReadOnly))
+            return 0;
+        return calls.readAll().count('\n');
+    }
+
+    int maxRunningLprs() const
+    {
+        QFile maxRunning(binDir.path() + "/max_running");
+        if (!maxRunning.open(QIODevice::ReadOnly))
+            return 0;
+        return maxRunning.readAll().trimmed().toInt();
+    }
+
+    void TearDown() override
+    {
+        qputenv("PATH", oldPath);
+        LprPrinter::setMaxConcurrentProcesses(0);
+    }
+
+    void printToAllPrinters(int printersCount)
+    {
+        QVector<QSharedPointer<LprPrinter>> printers;
+        for (int i = 0; i < printersCount; ++i)
+            printers << QSharedPointer<LprPrinter>::create(QStringLiteral("127.0.0.1"),
+                                                           QStringLiteral("printer%1").arg(i));
+
+        QVector<FutureSP<bool>> results;
+        for (const auto &printer : printers)
+            results << printer->printRawData("N\nP1\n", true);
+        for (const auto &result : results) {
+            result->wait();
+            EXPECT_TRUE(result->succeeded());
+        }
+    }
+
+    QTemporaryDir binDir;
+    QByteArray oldPath;
+};
+
+TEST_F(LprPrinterTest, printersProgressInParallel)
+{
+    int printersCount = qBound(2, QThread::idealThreadCount(), 4);
+    printToAllPrinters(printersCount);
+    EXPECT_GE(maxRunningLprs(), 2);
+}
+
+TEST_F(LprPrinterTest, concurrencyCap)
+{
+    LprPrinter::setMaxConcurrentProcesses(1);
+    EXPECT_EQ(1, LprPrinter::maxConcurrentProcesses());
+    printToAllPrinters(3);
+    EXPECT_EQ(1, maxRunningLprs());
+}
+
+TEST_F(LprPrinterTest, queuedTasksOfDestroyedPrinter)
+{
+    LprPrinter::setMaxConcurrentProcesses(1);
+    LprPrinter working(QStringLiteral("127.0.0.1"), QStringLiteral("printer0"));
+    QScopedPointer<LprPrinter> removed(new LprPrinter(QStringLiteral("127.0.0.1"), QStringLiteral("printer1")));
+
+    auto workingResult = working.printRawData("N\nP1\n", true);
+    auto removedResult = removed->printRawData("N\nP1\n", true);
+    removed.reset();
+    removedResult->wait();
+    EXPECT_TRUE(removedResult->failed());
+
+    workingResult->wait();
+    EXPECT_TRUE(workingResult->succeeded());
+    auto nextResult = working.printRawData("N\nP1\n", true);
+    nextResult->wait();
+    EXPECT_TRUE(nextResult->succeeded());
+}
+
+TEST_F(LprPrinterTest, readinessCache)
+{
+    LprPrinter printer(QStringLiteral("127.0.0.1"), QStringLiteral("printer0"));
+    printer.setReadinessCacheTtl(60000);
+
+    auto result = printer.printerIsReady();
+    result->wait();
+    ASSERT_TRUE(result->succeeded());
+    EXPECT_EQ(1, lpqCalls());
+
+    result = printer.printRawData("N\nP1\n");
+    result->wait();
+    ASSERT_TRUE(result->succeeded());
+    result = printer.printerIsReady();
+    result->wait();
+    ASSERT_TRUE(result->succeeded());
+    EXPECT_EQ(1, lpqCalls());
+
+    writeTool("lpr", QStringLiteral("cat > /dev/null\nexit 1\n"));
+    result = printer.printRawData("N\nP1\n", true);
+    result->wait();
+    ASSERT_TRUE(result->failed());
+    result = printer.printerIsReady();
+    result->wait();
+    ASSERT_TRUE(result->succeeded());
+    EXPECT_EQ(2, lpqCalls());
+
+    printer.setReadinessCacheTtl(0);
+    result = printer.printerIsReady();
+    result->wait();
+    EXPECT_EQ(3, lpqCalls());
+}
+
+TEST_F(LprPrinterTest, invalidationDuringReadinessCheck)
+{
+    writeTool("lpq", QStringLiteral("echo x >> %1\nsleep 0.3\necho \"$4 is ready\"\n").arg(lpqCallsFileName()));
+    LprPrinter printer(QStringLiteral("127.0.0.1"), QStringLiteral("printer0"));
+    printer.setReadinessCacheTtl(60000);
+
+    auto result = printer.printerIsReady();
+    QThread::msleep(100);
+    printer.invalidateReadinessCache();
+    result->wait();
+    ASSERT_TRUE(result->succeeded());
+
+    //Check started before invalidation doesn't fill the cache
+    result = printer.printerIsReady();
+    result->wait();
+    ASSERT_TRUE(result->succeeded());
+    EXPECT_EQ(2, lpqCalls());
+    result = printer.printerIsReady();
+    result->wait();
+    EXPECT_EQ(2, lpqCalls());
+}
+
+TEST_F(LprPrinterTest, pollingNeedsReadinessCache)
+{
+    LprPrinter printer(QStringLiteral("127.0.0.1"), QStringLiteral("printer0"));
+    printer.setReadinessPollingInterval(50);
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 500)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+    EXPECT_EQ(0, lpqCalls());
+
+    printer.setReadinessCacheTtl(60000);
+    timer.restart();
+    while (!lpqCalls() && timer.elapsed() < 5000)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+    EXPECT_LT(0, lpqCalls());
+    printer.setReadinessPollingInterval(0);
+    //Printer tasks run one by one, so this one finishes after the poll
+    auto result = printer.printerIsReady();
+    result->wait();
+    EXPECT_TRUE(result->succeeded());
+}
@@ -0,0 +1,269 @@
+// clazy:skip
+
+#include "proofutils/printspool.h"
+
+#include "gtest/proof/test_global.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <atomic>
+#include <thread>
+
+using namespace Proof;
+
+//Collects everything it gets, fails first failuresCount attempts
+class FakeSender
+{
+public:
+    explicit FakeSender(int failuresCount = 0) : failuresLeft(failuresCount) {}
+
+    PrintSpool::Sender sender()
+    {
+        return [this](const QByteArray &data, bool ignorePrinterState) -> FutureSP<bool> {
+            if (failuresLeft-- > 0)
+                return Future<bool>::fail(Failure(QStringLiteral("Printer is offline"), UTILS_MODULE_CODE,
+                                                  UtilsErrorCode::PrinterOffline));
+            QMutexLocker lock(&mutex);
+            received << data;
+            receivedIgnoringState << ignorePrinterState;
+            threads << QThread::currentThread();
+            return Future<>::successful(true);
+        };
+    }
+
+    QVector<QByteArray> labels()
+    {
+        QMutexLocker lock(&mutex);
+        return received;
+    }
+
+    QVector<bool> ignoringStateFlags()
+    {
+        QMutexLocker lock(&mutex);
+        return receivedIgnoringState;
+    }
+
+    QVector<QThread *> callingThreads()
+    {
+        QMutexLocker lock(&mutex);
+        return threads;
+    }
+
+private:
+    QMutex mutex;
+    QVector<QByteArray> received;
+    QVector<bool> receivedIgnoringState;
+    QVector<QThread *> threads;
+    std::atomic<int> failuresLeft;
+};
+
+static bool waitForDelivery(PrintSpool &spool, const QString &queueName)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (spool.pendingCount(queueName) && timer.elapsed() < 5000)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    return !spool.pendingCount(queueName);
+}
+
+static QByteArray label(int i)
+{
+    return QByteArray("N\nA10,20,0,4,1,1,N,\"") + QByteArray::number(i) + "\"\nP1\n";
+}
+
+TEST(PrintSpoolTest, replayAfterRestart)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    {
+        PrintSpool spool(dir.path(), PrintSpool::SyncPolicy::EveryJob);
+        for (int i = 0; i < 100; ++i)
+            ASSERT_TRUE(spool.enqueue("printer", label(i))->result());
+        EXPECT_EQ(100, spool.pendingCount("printer"));
+    }
+
+    PrintSpool spool(dir.path());
+    EXPECT_EQ(100, spool.pendingCount("printer"));
+    FakeSender sender;
+    spool.attach("printer", sender.sender());
+    ASSERT_TRUE(waitForDelivery(spool, "printer"));
+    auto labels = sender.labels();
+    ASSERT_EQ(100, labels.count());
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(label(i), labels[i]);
+}
+
+TEST(PrintSpoolTest, retryAndCursor)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    {
+        FakeSender sender(2);
+        PrintSpool spool(dir.path(), PrintSpool::SyncPolicy::Grouped);
+        spool.setRetryInterval(10);
+        qint64 senderId = spool.attach("printer", sender.sender());
+        for (int i = 0; i < 10; ++i)
+            ASSERT_TRUE(spool.enqueue("printer", label(i))->result());
+        ASSERT_TRUE(waitForDelivery(spool, "printer"));
+        auto labels = sender.labels();
+        ASSERT_EQ(10, labels.count());
+        EXPECT_EQ(label(0), labels.first());
+        spool.detach("printer", senderId);
+    }
+
+    PrintSpool spool(dir.path());
+    EXPECT_EQ(0, spool.pendingCount("printer"));
+}
+
+TEST(PrintSpoolTest, separateQueues)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    PrintSpool spool(dir.path(), PrintSpool::SyncPolicy::None);
+    FakeSender first;
+    FakeSender second;
+    ASSERT_TRUE(spool.enqueue("first/printer", label(1))->result());
+    ASSERT_TRUE(spool.enqueue("second/printer", label(2))->result());
+    spool.attach("first/printer", first.sender());
+    ASSERT_TRUE(waitForDelivery(spool, "first/printer"));
+    EXPECT_EQ(QVector<QByteArray>{label(1)}, first.labels());
+    EXPECT_EQ(1, spool.pendingCount("second/printer"));
+
+    spool.attach("second/printer", second.sender());
+    ASSERT_TRUE(waitForDelivery(spool, "second/printer"));
+    EXPECT_EQ(QVector<QByteArray>{label(2)}, second.labels());
+}
+
+TEST(PrintSpoolTest, detachKeepsOtherSenders)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    PrintSpool spool(dir.path(), PrintSpool::SyncPolicy::None);
+    FakeSender first;
+    FakeSender second;
+    qint64 firstId = spool.attach("printer", first.sender());
+    qint64 secondId = spool.attach("printer", second.sender());
+    EXPECT_NE(firstId, secondId);
+    ASSERT_TRUE(spool.enqueue("printer", label(1))->result());
+    ASSERT_TRUE(waitForDelivery(spool, "printer"));
+    EXPECT_EQ(QVector<QByteArray>{label(1)}, first.labels());
+
+    spool.detach("printer", firstId);
+    ASSERT_TRUE(spool.enqueue("printer", label(2))->result());
+    ASSERT_TRUE(waitForDelivery(spool, "printer"));
+    EXPECT_EQ(QVector<QByteArray>{label(1)}, first.labels());
+    EXPECT_EQ(QVector<QByteArray>{label(2)}, second.labels());
+    spool.detach("printer", secondId);
+}
+
+TEST(PrintSpoolTest, brokenTail)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    {
+        PrintSpool spool(dir.path(), PrintSpool::SyncPolicy::EveryJob);
+        ASSERT_TRUE(spool.enqueue("printer", label(1))->result());
+        ASSERT_TRUE(spool.enqueue("printer", label(2))->result());
+    }
+
+    QStringList spoolFiles = QDir(dir.path()).entryList({"*.spool"}, QDir::Files);
+    ASSERT_EQ(1, spoolFiles.count());
+    QFile spoolFile(QDir(dir.path()).filePath(spoolFiles.first()));
+    ASSERT_TRUE(spoolFile.open(QIODevice::Append));
+    spoolFile.write("PSP1 interrupted write");
+    spoolFile.close();
+
+    PrintSpool spool(dir.path());
+    EXPECT_EQ(2, spool.pendingCount("printer"));
+    FakeSender sender;
+    spool.attach("printer", sender.sender());
+    ASSERT_TRUE(waitForDelivery(spool, "printer"));
+    EXPECT_EQ(QVector<QByteArray>({label(1), label(2)}), sender.labels());
+}
+
+TEST(PrintSpoolTest, queueLimit)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    PrintSpool spool(dir.path(), PrintSpool::SyncPolicy::None);
+    spool.setMaxQueueSize(100);
+    ASSERT_TRUE(spool.enqueue("printer", QByteArray(50, 'x'))->result());
+    auto result = spool.enqueue("printer", QByteArray(50, 'x'));
+    result->wait();
+    ASSERT_TRUE(result->failed());
+    EXPECT_EQ(UtilsErrorCode::SpoolIsFull, result->failureReason().errorCode);
+}
+
+TEST(PrintSpoolTest, ignorePrinterStateIsStored)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    {
+        PrintSpool spool(dir.path(), PrintSpool::SyncPolicy::Grouped);
+        ASSERT_TRUE(spool.enqueue("printer", label(1))->result());
+        ASSERT_TRUE(spool.enqueue("printer", label(2), true)->result());
+        ASSERT_TRUE(spool.enqueue("printer", label(3))->result());
+    }
+
+    PrintSpool spool(dir.path());
+    FakeSender sender;
+    spool.attach("printer", sender.sender());
+    ASSERT_TRUE(waitForDelivery(spool, "printer"));
+    EXPECT_EQ(QVector<QByteArray>({label(1), label(2), label(3)}), sender.labels());
+    EXPECT_EQ(QVector<bool>({false, true, false}), sender.ignoringStateFlags());
+}
+
+TEST(PrintSpoolTest, senderContextThread)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    PrintSpool spool(dir.path(), PrintSpool::SyncPolicy::None);
+    FakeSender sender;
+    QObject context;
+    qint64 senderId = spool.attach("printer", sender.sender(), &context);
+    for (int i = 0; i < 10; ++i)
+        ASSERT_TRUE(spool.enqueue("printer", label(i))->result());
+    ASSERT_TRUE(waitForDelivery(spool, "printer"));
+    spool.detach("printer", senderId);
+
+    ASSERT_EQ(10, sender.callingThreads().count());
+    for (QThread *thread : sender.callingThreads())
+        EXPECT_EQ(QThread::currentThread(), thread);
+}
+
+TEST(PrintSpoolTest, detachWaitsForSenderResult)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    PrintSpool spool(dir.path(), PrintSpool::SyncPolicy::None);
+    std::atomic<bool> called{false};
+    std::atomic<bool> resolved{false};
+    std::thread resolver;
+    qint64 senderId = spool.attach("printer", [&called, &resolved, &resolver](const QByteArray &, bool) {
+        PromiseSP<bool> promise = PromiseSP<bool>::create();
+        resolver = std::thread([promise, &resolved]() {
+            QThread::msleep(300);
+            resolved = true;
+            promise->success(true);
+        });
+        called = true;
+        return promise->future();
+    });
+    ASSERT_TRUE(spool.enqueue("printer", label(1))->result());
+    QElapsedTimer timer;
+    timer.start();
+    while (!called && timer.elapsed() < 5000)
+        QThread::msleep(1);
+    ASSERT_TRUE(called);
+
+    spool.detach("printer", senderId);
+    EXPECT_TRUE(resolved);
+    resolver.join();
+    EXPECT_EQ(0, spool.pendingCount("printer"));
+}
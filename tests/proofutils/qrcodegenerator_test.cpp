@@ -0,0 +1,100 @@
+// clazy:skip
+
+#include "proofutils/qrcodegenerator.h"
+
+#include "gtest/proof/test_global.h"
+
+#include <QColor>
+
+using namespace Proof;
+using testing::Test;
+
+static QByteArray eplDataFromBitmap(const QImage &bitmap)
+{
+    QByteArray result;
+    for (int i = 0; i < bitmap.height(); ++i) {
+        for (int j = 0; j < bitmap.width() / 8; ++j) {
+            qint8 byte = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (bitmap.pixel(j * 8 + bit, i) == QColor(Qt::white).rgb())
+                    byte |= 1 << (7 - bit);
+            }
+            result.append(byte);
+        }
+    }
+    return result;
+}
+
+TEST(QrCodeGeneratorTest, eplBinaryDataMatchesBitmap)
+{
+    const QStringList payloads = {"42", "https://example.com/jobs/MT-42?copy=1", QString(200, 'x')};
+    for (const auto &payload : payloads) {
+        for (int width = 100; width <= 800; width += 25) {
+            QByteArray expected = eplDataFromBitmap(QrCodeGenerator::generateBitmap(payload, width));
+            QByteArray actual = QrCodeGenerator::generateEplBinaryData(payload, width);
+            ASSERT_EQ(expected.size(), actual.size()) << payload.toLatin1().constData() << width;
+            EXPECT_EQ(expected, actual) << payload.toLatin1().constData() << width;
+        }
+    }
+}
+
+TEST(QrCodeGeneratorTest, eplBinaryDataSize)
+{
+    QByteArray data = QrCodeGenerator::generateEplBinaryData("42", 200);
+    EXPECT_EQ(25 * 200, data.size());
+    //Too narrow for any module, so bitmap stays white
+    data = QrCodeGenerator::generateEplBinaryData("42", 10);
+    EXPECT_EQ(QByteArray(12, static_cast<char>(0xFF)), data);
+}
+
+TEST(QrCodeGeneratorTest, cache)
+{
+    QrCodeGenerator::clearCache();
+    auto before = QrCodeGenerator::cacheStatistics();
+    EXPECT_EQ(0, before.entriesCount);
+    EXPECT_EQ(0, before.usedMemory);
+
+    QByteArray first = QrCodeGenerator::generateEplBinaryData("cached", 200);
+    QByteArray second = QrCodeGenerator::generateEplBinaryData("cached", 200);
+    QrCodeGenerator::generateEplBinaryData("cached", 200, QrCodeGenerator::Mode::Character,
+                                           QrCodeGenerator::ErrorCorrection::HighLevel);
+    auto after = QrCodeGenerator::cacheStatistics();
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(before.misses + 2, after.misses);
+    EXPECT_EQ(before.hits + 1, after.hits);
+    EXPECT_EQ(2, after.entriesCount);
+    EXPECT_LT(2 * first.size(), after.usedMemory);
+
+    qlonglong oldLimit = QrCodeGenerator::cacheMemoryLimit();
+    QrCodeGenerator::setCacheMemoryLimit(0);
+    auto disabled = QrCodeGenerator::cacheStatistics();
+    EXPECT_EQ(0, disabled.entriesCount);
+    EXPECT_EQ(after.evictions + 2, disabled.evictions);
+    EXPECT_EQ(first, QrCodeGenerator::generateEplBinaryData("cached", 200));
+    EXPECT_EQ(0, QrCodeGenerator::cacheStatistics().entriesCount);
+    EXPECT_EQ(disabled.misses, QrCodeGenerator::cacheStatistics().misses);
+    QrCodeGenerator::setCacheMemoryLimit(oldLimit);
+}
+
+TEST(QrCodeGeneratorTest, cacheLimitIsShared)
+{
+    qlonglong oldLimit = QrCodeGenerator::cacheMemoryLimit();
+    QByteArray first = QrCodeGenerator::generateEplBinaryData("first", 400);
+    QrCodeGenerator::clearCache();
+    //Room for single entry only, it is still cached even though it is bigger than any fair per-shard part
+    QrCodeGenerator::setCacheMemoryLimit(first.size() + 1024);
+    auto before = QrCodeGenerator::cacheStatistics();
+    EXPECT_EQ(0, before.entriesCount);
+
+    QrCodeGenerator::generateEplBinaryData("first", 400);
+    EXPECT_EQ(1, QrCodeGenerator::cacheStatistics().entriesCount);
+    QrCodeGenerator::generateEplBinaryData("first", 400);
+    EXPECT_EQ(before.hits + 1, QrCodeGenerator::cacheStatistics().hits);
+
+    QrCodeGenerator::generateEplBinaryData("second", 400);
+    auto after = QrCodeGenerator::cacheStatistics();
+    EXPECT_EQ(1, after.entriesCount);
+    EXPECT_EQ(before.evictions + 1, after.evictions);
+    EXPECT_GE(after.memoryLimit, after.usedMemory);
+    QrCodeGenerator::setCacheMemoryLimit(oldLimit);
+}
@@ -0,0 +1,164 @@
+// clazy:skip
+
+#include "proofutils/rawsocketprinter.h"
+
+#include "gtest/proof/test_global.h"
+
+#include "../common/fakesocketserver.h"
+
+#include <QThread>
+
+#include <atomic>
+
+using namespace Proof;
+using namespace Proof::Hardware;
+
+//Accepts connections and reads everything until expected amount of data is received
+class TcpSink
+{
+public:
+    explicit TcpSink(qint64 expectedSize)
+        : expectedSize(expectedSize), server([this](QTcpSocket *socket) { return serve(socket); })
+    {
+        port = server.port();
+    }
+
+    void waitForFinished() { server.waitForFinished(); }
+
+    quint16 port = 0;
+    QByteArray received;
+    int connectionsCount = 0;
+
+private:
+    //Next connection is served only if client disconnected before sending everything
+    bool serve(QTcpSocket *socket)
+    {
+        ++connectionsCount;
+        while (received.size() < expectedSize) {
+            bool hasData = socket->waitForReadyRead(5000);
+            received.append(socket->readAll());
+            if (!hasData)
+                return socket->state() != QAbstractSocket::ConnectedState;
+        }
+        return false;
+    }
+
+    qint64 expectedSize = 0;
+    FakeSocketServer server;
+};
+
+TEST(RawSocketPrinterTest, printRawData)
+{
+    QVector<QByteArray> labels;
+    qint64 totalSize = 0;
+    for (int i = 0; i < 500; ++i) {
+        labels << QByteArray("N\nA10,20,0,4,1,1,N,\"") + QByteArray::number(i) + "\"\nP1\n";
+        totalSize += labels.last().size();
+    }
+
+    TcpSink sink(totalSize);
+    RawSocketPrinter printer(QStringLiteral("127.0.0.1"), sink.port);
+    QVector<FutureSP<bool>> results;
+    for (const QByteArray &label : labels)
+        results << printer.printRawData(label);
+    for (const auto &result : results) {
+        result->wait();
+        ASSERT_TRUE(result->succeeded());
+        EXPECT_TRUE(result->result());
+    }
+    sink.waitForFinished();
+
+    QByteArray expected;
+    for (const QByteArray &label : labels)
+        expected.append(label);
+    EXPECT_EQ(expected, sink.received);
+    EXPECT_EQ(1, sink.connectionsCount);
+    EXPECT_EQ(0, printer.pendingSize());
+    EXPECT_FALSE(printer.isCongested());
+}
+
+TEST(RawSocketPrinterTest, sharedConnection)
+{
+    TcpSink sink(8);
+    RawSocketPrinter first(QStringLiteral("127.0.0.1"), sink.port);
+    RawSocketPrinter second(QStringLiteral("127.0.0.1"), sink.port);
+    second.setMaxBatchSize(1024);
+    EXPECT_EQ(1024, first.maxBatchSize());
+
+    auto firstResult = first.printRawData("N\nP1\n");
+    auto secondResult = second.printRawData("P1\n");
+    firstResult->wait();
+    secondResult->wait();
+    sink.waitForFinished();
+
+    EXPECT_TRUE(firstResult->succeeded());
+    EXPECT_TRUE(secondResult->succeeded());
+    EXPECT_EQ("N\nP1\nP1\n", sink.received);
+    EXPECT_EQ(1, sink.connectionsCount);
+}
+
+TEST(RawSocketPrinterTest, sinkStopsReadingWithinBatch)
+{
+    //First label is bigger than socket buffers, so it keeps connection busy until the rest is queued as one batch
+    const QByteArray firstLabel = QByteArray("N\n") + QByteArray(32 * 1024 * 1024, ' ') + "P1\n";
+    QVector<QByteArray> labels;
+    qint64 totalSize = 0;
+    for (int i = 0; i < 1000; ++i) {
+        labels << QByteArray("N\nA10,20,0,4,1,1,N,\"") + QByteArray::number(i) + "\"\nP1\n";
+        totalSize += labels.last().size();
+    }
+
+    //Reads first label and beginning of batch, then stalls like printer without paper
+    const qint64 stallAt = firstLabel.size() + totalSize / 2;
+    std::atomic<bool> labelsQueued{false};
+    qint64 receivedSize = 0;
+    FakeSocketServer server([&labelsQueued, &receivedSize, &server, stallAt](QTcpSocket *socket) {
+        while (!labelsQueued)
+            QThread::msleep(1);
+        while (receivedSize < stallAt && socket->waitForReadyRead(5000))
+            receivedSize += socket->read(stallAt - receivedSize).size();
+        while (!server.isStopped())
+            QThread::msleep(10);
+        return false;
+    });
+    RawSocketPrinter printer(QStringLiteral("127.0.0.1"), server.port());
+    printer.setTimeout(2000);
+    printer.setMaxPendingSize(firstLabel.size() + totalSize);
+
+    auto firstResult = printer.printRawData(firstLabel);
+    QVector<FutureSP<bool>> results;
+    for (const QByteArray &label : labels)
+        results << printer.printRawData(label);
+    labelsQueued = true;
+
+    firstResult->wait();
+    EXPECT_TRUE(firstResult->succeeded());
+    //Labels that sink has read are not confirmed either, connection is dropped with unsent data
+    for (const auto &result : results) {
+        result->wait();
+        ASSERT_TRUE(result->failed());
+        EXPECT_EQ(UtilsErrorCode::RawSocketBackpressure, result->failureReason().errorCode);
+    }
+    server.stop();
+
+    EXPECT_EQ(stallAt, receivedSize);
+    EXPECT_TRUE(printer.isCongested());
+    EXPECT_EQ(0, printer.pendingSize());
+}
+
+TEST(RawSocketPrinterTest, connectionRefused)
+{
+    RawSocketPrinter printer(QStringLiteral("127.0.0.1"), FakeSocketServer::closedPort());
+    printer.setTimeout(1000);
+
+    auto ready = printer.printerIsReady();
+    ready->wait();
+    ASSERT_TRUE(ready->failed());
+    EXPECT_EQ(UtilsErrorCode::RawSocketConnectionError, ready->failureReason().errorCode);
+
+    auto result = printer.printRawData("N\nP1\n");
+    result->wait();
+    ASSERT_TRUE(result->failed());
+    EXPECT_EQ(UTILS_MODULE_CODE, result->failureReason().moduleCode);
+    EXPECT_EQ(UtilsErrorCode::RawSocketConnectionError, result->failureReason().errorCode);
+}
@@ -20,20 +20,30 @@ HEADERS += \
     include/proofutils/epllabelgenerator.h \
     include/proofutils/qrcodegenerator.h \
     include/proofutils/labelprinter.h \
+    include/proofutils/labelprinterpool.h \
+    include/proofutils/labelbatchrenderer.h \
+    include/proofutils/rawsocketprinter.h \
+    include/proofutils/printspool.h \
     include/proofutils/basic_package.h
 
 SOURCES += \
     src/proofutils/proofutils_init.cpp \
     src/proofutils/epllabelgenerator.cpp \
     src/proofutils/qrcodegenerator.cpp \
-    src/proofutils/labelprinter.cpp
+    src/proofutils/labelprinter.cpp \
+    src/proofutils/labelprinterpool.cpp \
+    src/proofutils/labelbatchrenderer.cpp \
+    src/proofutils/rawsocketprinter.cpp \
+    src/proofutils/printspool.cpp
 
 !android {
 HEADERS += \
-    include/proofutils/lprprinter.h
+    include/proofutils/lprprinter.h \
+    include/proofutils/lpdclient.h
 
 SOURCES += \
-    src/proofutils/lprprinter.cpp
+    src/proofutils/lprprinter.cpp \
+    src/proofutils/lpdclient.cpp
 }
 
 include($$PROOF_PRI_PATH/proof_translation.pri)
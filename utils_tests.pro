@@ -5,9 +5,20 @@ include($$PROOF_PRI_PATH/proof_tests.pri)
 QT += gui
 CONFIG += proofutils
 
+HEADERS += \
+    tests/common/fakesocketserver.h
+
 SOURCES += \
     tests/proofutils/main.cpp \
-    tests/proofutils/epllabelgenerator_test.cpp
+    tests/proofutils/epllabelgenerator_test.cpp \
+    tests/proofutils/qrcodegenerator_test.cpp \
+    tests/proofutils/labelprinter_test.cpp \
+    tests/proofutils/labelprinterpool_test.cpp \
+    tests/proofutils/printspool_test.cpp \
+    tests/proofutils/rawsocketprinter_test.cpp
+
+!android: SOURCES += tests/proofutils/lpdclient_test.cpp
+!android:!win32: SOURCES += tests/proofutils/lprprinter_test.cpp
 
 RESOURCES += \
     tests/proofutils/tests_resources.qrc